@@ -210,6 +210,32 @@ static void PrintVersion(const MtxApplicationInfo_t *ai)
    printf("%s\n",mtxVersion());
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined MTX_DEFAULT_THREADS
+
+// Evaluates the "-j" option and returns the thread pool size. "-j auto" uses one worker thread
+// per available CPU, leaving one CPU for the main thread.
+
+static int getThreadCount(MtxApplication_t *a)
+{
+   const char *txt = appGetTextOption(a,"-j --threads",NULL);
+   if (txt == NULL) {
+      return MTX_DEFAULT_THREADS;
+   }
+   if (!strcmp(txt,"auto")) {
+      return sysCpuCount() - 1;
+   }
+   char *end;
+   const long n = strtol(txt, &end, 10);
+   if (*txt == 0 || *end != 0 || n < 0 || n > 1024) {
+      mtxAbort(NULL,"Invalid value after '%s' (expected 0..1024 or \"auto\")",a->optName);
+   }
+   return (int) n;
+}
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Initialize the application.
 /// This function initializes a MeatAxe application. It should be called
@@ -290,8 +316,9 @@ MtxApplication_t *appAlloc(MtxApplicationInfo_t const *ai, int argc, char * cons
    if ((time_limit = appGetIntOption(a,"-T --lime-limit",0,0,1000000)) > 0) {
       sysSetTimeLimit(time_limit);
    }
+   pexPinThreads(appGetOption(a,"--pin"));
 #if defined MTX_DEFAULT_THREADS
-   const int nThreads = appGetIntOption(a,"-j --threads", MTX_DEFAULT_THREADS, 0, 1024);
+   const int nThreads = getThreadCount(a);
    if (nThreads > 0)
       pexInit(nThreads);
 #endif
@@ -311,6 +338,7 @@ void appFree(MtxApplication_t *a)
          a->AppInfo != NULL ?  a->AppInfo->name : "meataxe",t / 10,t % 10);
    if (a->context > 0) mtxEnd(a->context);
    sysFree(a);
+   ffFlushRowCache();
    mmLeakCheck();
 }
 
@@ -1,8 +1,9 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// C MeatAxe - Polynomial factorization (Berlekamp algorithm)
+// C MeatAxe - Polynomial factorization (Berlekamp and Cantor-Zassenhaus algorithms)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "meataxe.h"
+#include <string.h>
 
 /// @addtogroup algo
 /// @{
@@ -25,7 +26,7 @@ static factor_t *factorSquarefree(const Poly_t *pol)
 
     ffSetField(pol->field);
     uint32_t exp = 0;       // Degree of F over its prime field.
-    for (uint32_t ltmp = 1; ltmp != ffChar; ++exp, ltmp *= ffChar);
+    for (uint32_t ltmp = 1; ltmp != ffOrder; ++exp, ltmp *= ffChar);
 
     Poly_t* t0 = polDup(pol);
     uint32_t e = 1;
@@ -247,10 +248,401 @@ static Poly_t **berlekamp(const Poly_t *pol, const Matrix_t  *kernel)
     return list;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cantor-Zassenhaus algorithm
+
+/// Selects the factorization algorithm for squarefree factors.
+///
+/// Factorization() decomposes a squarefree factor of degree n over GF(q) with the
+/// Cantor-Zassenhaus algorithm (distinct-degree factorization followed by equal-degree splitting)
+/// if n·polCantorZassenhausCutoff ≤ q^(3/2), and with the Berlekamp algorithm otherwise.
+/// The Berlekamp algorithm tries all field elements in each splitting step, and its running time
+/// grows linearly with q. The Cantor-Zassenhaus algorithm uses powers of polynomials modulo the
+/// factor, and its running time grows with log q, but faster than the Berlekamp algorithm with n.
+/// With the default value, the Cantor-Zassenhaus algorithm is used for degrees up to 128 over
+/// GF(256) and 1024 over GF(1024). Over GF(11) and GF(13), it is used only for factors of degree 1,
+/// and it is never used for fields with less than 11 elements.
+///
+/// The value may be changed at any time; 0 disables the Cantor-Zassenhaus algorithm.
+
+uint32_t polCantorZassenhausCutoff = 32;
+
+static int useCantorZassenhaus(const Poly_t* pol)
+{
+   if (polCantorZassenhausCutoff == 0) {
+      return 0;
+   }
+   const uint64_t q = pol->field;
+   const uint64_t nc = (uint64_t) pol->degree * polCantorZassenhausCutoff;
+   return nc <= ((uint64_t) 1 << 24) && nc * nc <= q * q * q;
+}
+
+// Modulus for repeated reductions. For large degrees, remainders are calculated by Barrett
+// reduction with the precomputed quotient μ=⌊x²ⁿ/f⌋, n=deg(f). This replaces the series
+// inversion, which polMod() would do for each reduction, by two multiplications.
+
+struct Modulus {
+   const Poly_t* f;
+   Poly_t* mu;          // NULL if polMod() is used
+};
+
+static void modInit(struct Modulus* m, const Poly_t* f)
+{
+   m->f = f;
+   m->mu = NULL;
+   if (polNewtonCutoff > 0 && f->degree >= (int32_t) polNewtonCutoff) {
+      Poly_t* x2n = polAlloc(f->field, 2 * f->degree);
+      m->mu = polDivMod(x2n, f);
+      polFree(x2n);
+   }
+}
+
+static void modFree(struct Modulus* m)
+{
+   if (m->mu != NULL) {
+      polFree(m->mu);
+   }
+}
+
+// Returns ⌊a/xᵏ⌋.
+
+static Poly_t* shiftDown(const Poly_t* a, int32_t k)
+{
+   Poly_t* result = polAlloc(a->field, a->degree - k);
+   if (result->degree >= 0) {
+      memcpy(result->data, a->data + k, (result->degree + 1) * sizeof(FEL));
+   }
+   return result;
+}
+
+// Replaces «a» with a mod f.
+
+static void modReduce(Poly_t* a, const struct Modulus* m)
+{
+   const int32_t n = m->f->degree;
+   if (a->degree < n) {
+      return;
+   }
+   if (m->mu == NULL || a->degree >= 2 * n) {
+      polMod(a, m->f);
+      return;
+   }
+
+   // Quotient ⌊⌊a/xⁿ⌋·μ/xⁿ⌋ (exact for deg(a) < 2n), remainder a - quotient·f
+   Poly_t* t = shiftDown(a, n);
+   polMul(t, m->mu);
+   Poly_t* quot = shiftDown(t, n);
+   polFree(t);
+   polMul(quot, m->f);
+   for (int32_t i = 0; i < n; ++i) {
+      a->data[i] = ffSub(a->data[i], quot->data[i]);
+   }
+   polFree(quot);
+   a->degree = n - 1;
+   polNormalize(a);
+}
+
+// Replaces «a» with a·b mod f.
+
+static void mulMod(Poly_t* a, const Poly_t* b, const struct Modulus* m)
+{
+   polMul(a, b);
+   modReduce(a, m);
+}
+
+// Returns aᵉ mod f. «a» must be reduced modulo f.
+
+static Poly_t* powMod(const Poly_t* a, uint32_t e, const struct Modulus* m)
+{
+   if (e == 0) {
+      return polAlloc(a->field, 0);
+   }
+   int bit = 31;
+   while (((e >> bit) & 1) == 0) {
+      --bit;
+   }
+   Poly_t* result = polDup(a);
+   while (--bit >= 0) {
+      mulMod(result, result, m);
+      if ((e >> bit) & 1) {
+         mulMod(result, a, m);
+      }
+   }
+   return result;
+}
+
+// Subtracts a constant or a multiple of x from a polynomial.
+
+static void subMonomial(Poly_t* a, int degree)
+{
+   Poly_t* m = polAlloc(a->field, degree);
+   m->data[degree] = ffNeg(FF_ONE);
+   polAdd(a, m);
+   polFree(m);
+}
+
+// Distinct-degree factorization.
+// «pol» must be monic and squarefree. The function returns a list of pairs (p, d), where p is
+// the product of all irreducible factors of degree d. The list is terminated by an entry with
+// p=NULL, d=0.
+//
+// An irreducible factor of degree e divides x^(q^d)-x if and only if e divides d. To save
+// g.c.d. calculations, the polynomials x^(q^d)-x are processed in blocks of DDF_BLOCK_SIZE
+// consecutive degrees. Their product (modulo pol) is tested first, and the individual degrees
+// are tested only if the block contains a factor.
+
+#define DDF_BLOCK_SIZE 16
+
+static factor_t* factorDistinctDegree(const Poly_t* pol)
+{
+   ffSetField(pol->field);
+   factor_t* list = NALLOC(factor_t, pol->degree + 1);
+   size_t n = 0;
+
+   Poly_t* f = polDup(pol);
+   Poly_t* h = polAlloc(pol->field, 1);         // x^(q^d) mod f
+   Poly_t* hx[DDF_BLOCK_SIZE];                   // x^(q^d)-x mod f for the current block
+   for (long d = 1; 2 * d <= f->degree; ) {
+      struct Modulus m;
+      modInit(&m, f);
+      Poly_t* prod = polAlloc(f->field, 0);
+      int nb = 0;
+      for (; nb < DDF_BLOCK_SIZE && 2 * (d + nb) <= f->degree; ++nb) {
+         Poly_t* tmp = powMod(h, ffOrder, &m);
+         polFree(h);
+         h = tmp;
+         hx[nb] = polDup(h);
+         subMonomial(hx[nb], 1);
+         mulMod(prod, hx[nb], &m);
+      }
+      modFree(&m);
+
+      Poly_t* g = polGcd(f, prod);
+      polFree(prod);
+      for (int i = 0; i < nb; ++i) {
+         if (g->degree > 0) {
+            Poly_t* gd = polGcd(g, hx[i]);
+            if (gd->degree > 0) {
+               list[n].p = gd;
+               list[n].n = d + i;
+               ++n;
+               Poly_t* quot = polDivMod(g, gd);
+               polFree(g);
+               g = quot;
+               quot = polDivMod(f, gd);
+               polFree(f);
+               f = quot;
+            } else {
+               polFree(gd);
+            }
+         }
+         polFree(hx[i]);
+      }
+      MTX_ASSERT(g->degree == 0);
+      polFree(g);
+      polMod(h, f);
+      d += nb;
+   }
+   polFree(h);
+
+   // The remaining factor, if any, is irreducible
+   if (f->degree > 0) {
+      list[n].p = f;
+      list[n].n = f->degree;
+      ++n;
+   } else {
+      polFree(f);
+   }
+
+   list[n].p = NULL;
+   list[n].n = 0;
+   return list;
+}
+
+// Simple deterministic pseudo random number generator (xorshift). We do not use mtxRandom()
+// because it is not thread safe and the results shall not depend on the thread scheduling.
+
+static uint32_t nextRandom(uint32_t* state)
+{
+   uint32_t x = *state;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   return *state = x;
+}
+
+// Returns a polynomial g with gcd(f,g) ≠ 1, f for about half of all choices of «a».
+// f is a product of irreducible polynomials of degree «d», «a» is reduced modulo f.
+
+static Poly_t* makeSplitter(const Poly_t* a, const struct Modulus* m, long d)
+{
+   Poly_t* result;
+   if (ffChar == 2) {
+      // Trace: a + a² + a⁴ + ... + a^(2^(kd-1)), where q=2ᵏ
+      long kd = d;
+      for (uint32_t q = ffOrder; q > 2; q /= 2) {
+         kd += d;
+      }
+      result = polDup(a);
+      Poly_t* x = polDup(a);
+      for (long i = 1; i < kd; ++i) {
+         mulMod(x, x, m);
+         polAdd(result, x);
+      }
+      polFree(x);
+   } else {
+      // (a^(1+q+...+q^(d-1)))^((q-1)/2) - 1
+      Poly_t* norm = polDup(a);
+      Poly_t* x = polDup(a);
+      for (long i = 1; i < d; ++i) {
+         Poly_t* tmp = powMod(x, ffOrder, m);
+         polFree(x);
+         x = tmp;
+         mulMod(norm, x, m);
+      }
+      polFree(x);
+      result = powMod(norm, (ffOrder - 1) / 2, m);
+      polFree(norm);
+      subMonomial(result, 0);
+   }
+   return result;
+}
+
+// Equal-degree factorization.
+// Splits «f», which must be monic and a product of distinct irreducible polynomials of degree
+// «d», into its irreducible factors. The factors are appended to «list». «f» is consumed.
+
+static void splitEqualDegree(Poly_t** list, size_t* n, Poly_t* f, long d, uint32_t* seed)
+{
+   while (f->degree > d) {
+      Poly_t* a = polAlloc(f->field, f->degree - 1);
+      for (int32_t i = 0; i < f->degree; ++i) {
+         a->data[i] = ffFromInt(nextRandom(seed) % ffOrder);
+      }
+      polNormalize(a);
+      if (a->degree <= 0) {
+         polFree(a);
+         continue;
+      }
+      struct Modulus m;
+      modInit(&m, f);
+      Poly_t* s = makeSplitter(a, &m, d);
+      modFree(&m);
+      polFree(a);
+      Poly_t* g = polGcd(f, s);
+      polFree(s);
+      if (g->degree > 0 && g->degree < f->degree) {
+         Poly_t* quot = polDivMod(f, g);
+         polFree(f);
+         f = quot;
+         splitEqualDegree(list, n, g, d, seed);
+      } else {
+         polFree(g);
+      }
+   }
+   list[(*n)++] = f;
+}
+
+// Cantor-Zassenhaus factorization of one squarefree factor, see factorCantorZassenhaus().
+struct CzJob {
+   const Poly_t* pol;   // Squarefree polynomial
+   factor_t* ddf;       // Distinct-degree factorization (p=product, n=degree)
+   Poly_t** irr;        // Irreducible factors (NULL terminated)
+};
+
+// Equal-degree splitting of one entry of a distinct-degree factorization.
+struct EdfJob {
+   Poly_t* pol;         // Product of irreducible factors of degree d (consumed)
+   long d;
+   Poly_t** irr;        // Points into CzJob::irr
+   size_t nIrr;
+};
+
+static void ddfTask(void* userData, size_t begin, size_t end)
+{
+   struct CzJob* jobs = (struct CzJob*) userData;
+   for (size_t i = begin; i < end; ++i) {
+      ffSetField(jobs[i].pol->field);
+      Poly_t* monic = polDup(jobs[i].pol);
+      const FEL lc = monic->data[monic->degree];
+      if (lc != FF_ONE) {
+         const FEL lcInv = ffInv(lc);
+         for (int32_t k = 0; k <= monic->degree; ++k) {
+            monic->data[k] = ffMul(monic->data[k], lcInv);
+         }
+      }
+      jobs[i].ddf = factorDistinctDegree(monic);
+      polFree(monic);
+   }
+}
+
+static void edfTask(void* userData, size_t begin, size_t end)
+{
+   struct EdfJob* jobs = (struct EdfJob*) userData;
+   for (size_t i = begin; i < end; ++i) {
+      ffSetField(jobs[i].pol->field);
+      uint32_t seed = 0x9e3779b9U ^ (uint32_t)(jobs[i].pol->degree * 2654435761U);
+      splitEqualDegree(jobs[i].irr, &jobs[i].nIrr, jobs[i].pol, jobs[i].d, &seed);
+   }
+}
+
+// Decomposes squarefree polynomials into irreducible factors using the Cantor-Zassenhaus
+// algorithm. The distinct-degree factorizations of all polynomials, and then the equal-degree
+// splittings of all parts, are calculated in parallel, see pexParallelFor().
+// As with berlekamp(), irreducible input polynomials are returned unchanged; all other factors
+// are monic.
+
+static void factorCantorZassenhaus(struct CzJob* jobs, size_t nJobs)
+{
+   pexParallelFor(0, nJobs, 1, ddfTask, jobs);
+
+   size_t nEdf = 0;
+   for (size_t i = 0; i < nJobs; ++i) {
+      jobs[i].irr = NALLOC(Poly_t*, jobs[i].pol->degree + 1);
+      for (factor_t* l = jobs[i].ddf; l->p != NULL; ++l) {
+         ++nEdf;
+      }
+   }
+   struct EdfJob* edf = NALLOC(struct EdfJob, nEdf + 1);
+   nEdf = 0;
+   for (size_t i = 0; i < nJobs; ++i) {
+      Poly_t** irr = jobs[i].irr;
+      for (factor_t* l = jobs[i].ddf; l->p != NULL; ++l) {
+         edf[nEdf].pol = l->p;
+         edf[nEdf].d = l->n;
+         edf[nEdf].irr = irr;
+         edf[nEdf].nIrr = 0;
+         irr += l->p->degree / l->n;
+         ++nEdf;
+      }
+   }
+   pexParallelFor(0, nEdf, 1, edfTask, edf);
+
+   // Collect the results
+   struct EdfJob* e = edf;
+   for (size_t i = 0; i < nJobs; ++i) {
+      size_t nIrr = 0;
+      for (factor_t* l = jobs[i].ddf; l->p != NULL; ++l, ++e) {
+         MTX_ASSERT(e->irr == jobs[i].irr + nIrr);
+         nIrr += e->nIrr;
+      }
+      jobs[i].irr[nIrr] = NULL;
+      if (nIrr == 1) {
+         polFree(jobs[i].irr[0]);
+         jobs[i].irr[0] = polDup(jobs[i].pol);
+      }
+      sysFree(jobs[i].ddf);
+   }
+   sysFree(edf);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
    
 /// Factorize a polynomial.
-/// This function decomposes a polynomial into irreducible factors using the Berlekamp algorithm.
+/// This function decomposes a polynomial into irreducible factors. After a squarefree
+/// factorization, each squarefree factor is decomposed using either the Berlekamp algorithm or,
+/// for large fields, the Cantor-Zassenhaus algorithm (see @ref polCantorZassenhausCutoff).
+/// Independent factors are split in parallel if the thread pool is running.
 
 FPoly_t* Factorization(const Poly_t* pol)
 {
@@ -260,11 +652,34 @@ FPoly_t* Factorization(const Poly_t* pol)
    // Step 1: Squarefree factorization
    factor_t* list = factorSquarefree(pol);
 
-   // Step 2: Decompose the squarefree factors using Berlekamp's algorithm
+   // Step 2: Decompose the squarefree factors
+   size_t nCz = 0;
+   for (factor_t* l = list; l->p != NULL; ++l) {
+      if (useCantorZassenhaus(l->p)) {
+         ++nCz;
+      }
+   }
+   struct CzJob* czJobs = NALLOC(struct CzJob, nCz + 1);
+   nCz = 0;
    for (factor_t* l = list; l->p != NULL; ++l) {
-      Matrix_t* kernel = makekernel(l->p);
-      Poly_t** irr = berlekamp(l->p, kernel);
-      matFree(kernel);
+      if (useCantorZassenhaus(l->p)) {
+         czJobs[nCz++].pol = l->p;
+      }
+   }
+   if (nCz > 0) {
+      factorCantorZassenhaus(czJobs, nCz);
+   }
+
+   struct CzJob* cz = czJobs;
+   for (factor_t* l = list; l->p != NULL; ++l) {
+      Poly_t** irr;
+      if (cz < czJobs + nCz && cz->pol == l->p) {
+         irr = (cz++)->irr;
+      } else {
+         Matrix_t* kernel = makekernel(l->p);
+         irr = berlekamp(l->p, kernel);
+         matFree(kernel);
+      }
       for (Poly_t** i = irr; *i != NULL; ++i) {
          fpMulP(factors, *i, l->n);
          polFree(*i);
@@ -273,6 +688,7 @@ FPoly_t* Factorization(const Poly_t* pol)
       polFree(l->p);
    }
 
+   sysFree(czJobs);
    sysFree(list);
    mtxEnd(context);
    return factors;
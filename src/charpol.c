@@ -67,9 +67,16 @@ Charpol_t* charpolStart(const Matrix_t* matrix, enum CharpolMode mode, long seed
 void charpolFree(struct CharpolState* state)
 {
    charpolValidate(MTX_HERE, state);
-   ffFree(state->mat);
-   ffFree(state->A);
-   ffFree(state->B);
+   if (state->fl == ffOrder) {
+      // keep for reuse by the next computation, see ffFreeRows()
+      ffFreeRows(state->mat, state->vsDim, state->vsDim);
+      ffFreeRows(state->A, state->vsDim + 1, state->vsDim);
+      ffFreeRows(state->B, state->vsDim + 1, state->vsDim);
+   } else {
+      ffFree(state->mat);
+      ffFree(state->A);
+      ffFree(state->B);
+   }
    sysFree(state->piv);
    sysFree(state->ispiv);
    if (state->partialMinPol != NULL) {
@@ -81,6 +88,18 @@ void charpolFree(struct CharpolState* state)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Returns the column of state->B which holds the coefficient of xᵏ. The coefficients are stored
+// in reverse order, starting with x⁰ in the last column. A polynomial of degree d then occupies
+// only the columns from vsDim-1-d to the end of the row, and the rows can be combined with
+// ffAddMulRowPartial().
+
+static inline uint32_t coeffColumn(const struct CharpolState* state, long k)
+{
+   return (uint32_t) (state->vsDim - 1 - k);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Make polynomial for the latest cyclic subspace
 
 static Poly_t *mkpoly(struct CharpolState* state)
@@ -88,7 +107,7 @@ static Poly_t *mkpoly(struct CharpolState* state)
    Poly_t *pol = polAlloc(state->fl,state->n);
    PTR x = ffGetPtr(state->B,state->n, state->vsDim);
    for (int k = 0; k < state->n; ++k) {
-      pol->data[k] = ffExtract(x,k);
+      pol->data[k] = ffExtract(x,coeffColumn(state, k));
    }
    pol->data[state->n] = FF_ONE;
    return pol;
@@ -97,37 +116,48 @@ static Poly_t *mkpoly(struct CharpolState* state)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Spin up one cyclic subspace
+///
+/// Each new vector is the image of the previous (cleaned) basis vector, cleaned with all basis
+/// vectors found so far. State->B holds the coefficients of the basis vectors of the current
+/// cyclic subspace as polynomials in the matrix applied to the seed vector (see coeffColumn()).
+/// The coefficient row of the n-th vector has degree at most n, so only the last n+1 columns
+/// need to be shifted and cleaned.
 
 static void spinup_cyclic(struct CharpolState* state)
 {
+   const uint32_t noc = state->vsDim;
    uint32_t pv;
    FEL f;
 
-   PTR a = ffGetPtr(state->A, state->dim, state->vsDim);
+   PTR a = ffGetPtr(state->A, state->dim, noc);
    PTR b = state->B;
-   ffMulRow(b,FF_ZERO, state->vsDim);
+   ffMulRow(b,FF_ZERO, noc);
    state->n = 0;
-   while ((pv = ffFindPivot(a,&f, state->vsDim)) != MTX_NVAL) {
+   while ((pv = ffFindPivot(a,&f, noc)) != MTX_NVAL) {
       PTR x, y;
 
       /* Add new vector to basis
          ----------------------- */
       state->piv[state->dim + state->n] = pv;
       state->ispiv[pv] = 1;
-      ffInsert(b,state->n,FF_ONE);
+      ffInsert(b,coeffColumn(state, state->n),FF_ONE);
       ++state->n;
 
-      /* Calculate the next vector
-         ------------------------- */
+      /* Calculate the next vector. Its coefficients are those of the previous vector, multiplied
+         by x. The leading coefficient is dropped if the cyclic subspace is the whole space; it
+         is always one (see mkpoly()).
+         ------------------------------------------------------------------------------------- */
       x = a;
-      ffStepPtr(&a, state->vsDim);
-      ffMapRow(a, x,state->mat,state->vsDim,state->vsDim);
+      ffStepPtr(&a, noc);
+      ffMapRow(a, x,state->mat,noc,noc);
       y = b;
-      ffStepPtr(&b, state->vsDim);
-      ffMulRow(b,FF_ZERO, state->vsDim);
-      for (uint32_t k = 0; k < state->vsDim - 1; ++k) {
-         ffInsert(b,k + 1,ffExtract(y,k));
+      ffStepPtr(&b, noc);
+      ffMulRow(b,FF_ZERO, noc);
+      const uint32_t degree = (state->n < (long) noc) ? (uint32_t) state->n : noc - 1;
+      for (uint32_t k = 0; k < degree; ++k) {
+         ffInsert(b,coeffColumn(state, k + 1),ffExtract(y,coeffColumn(state, k)));
       }
+      const uint32_t firstCoeff = coeffColumn(state, degree);
 
       /* Clean with existing basis vectors
          --------------------------------- */
@@ -135,12 +165,12 @@ static void spinup_cyclic(struct CharpolState* state)
       y = state->B;
       for (uint32_t k = 0; k < state->dim + state->n; ++k) {
          f = ffDiv(ffExtract(a,state->piv[k]),ffExtract(x,state->piv[k]));
-         ffAddMulRow(a,x,ffNeg(f), state->vsDim);
+         ffAddMulRow(a,x,ffNeg(f), noc);
          if (k >= state->dim) {
-            ffAddMulRow(b,y,ffNeg(f), state->vsDim);
-            ffStepPtr(&y, state->vsDim);
+            ffAddMulRowPartial(b,y,ffNeg(f),firstCoeff,noc);
+            ffStepPtr(&y, noc);
          }
-         ffStepPtr(&x, state->vsDim);
+         ffStepPtr(&x, noc);
       }
    }
    state->dim += state->n;
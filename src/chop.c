@@ -41,6 +41,7 @@ typedef struct nodestruct {
    WgData_t *wg;                // Used by the word generator
    uint32_t wnum;
    Matrix_t *word;
+   MatPowers_t *wordPowers;     // Powers of «word», see WordPowers()
    Charpol_t* cpState;
 } node_t;
 
@@ -150,6 +151,8 @@ static void cleanUpNode(node_t* n, int complete)
    }
    MATFREE(n->nsp);
    MATFREE(n->word);
+   matPowersFree(n->wordPowers);
+   n->wordPowers = NULL;
    if (n->f1 != NULL) { polFree(n->f1); n->f1 = NULL; }
    if (n->f2 != NULL) { polFree(n->f2); n->f2 = NULL; }
    if (n->cpState != NULL) { charpolFree(n->cpState); n->cpState = NULL; }
@@ -161,9 +164,23 @@ static void cleanUpNode(node_t* n, int complete)
 
 static void MakeWord(node_t *n, uint32_t w)
 {
-   MATFREE(n->word);
-   n->word = wgMakeWord(n->wg,w);
+   n->word = wgMakeWordInto(n->word, n->wg, w);     // reuses the previous word
    n->wnum = w;
+   matPowersFree(n->wordPowers);
+   n->wordPowers = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the power table of the current word. The table is created on first use and shared by
+// all polynomials which are evaluated at the same word.
+
+static MatPowers_t *WordPowers(node_t *n)
+{
+   if (n->wordPowers == NULL) {
+      n->wordPowers = matPowersAlloc(n->word);
+   }
+   return n->wordPowers;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -172,7 +189,7 @@ static void MakeWord(node_t *n, uint32_t w)
 
 static void InsertWord(node_t *n, Poly_t *p)
 {
-   Matrix_t *m = matInsert(n->word,p);
+   Matrix_t *m = matInsertPowers(NULL, WordPowers(n), p);
    MATFREE(n->nsp);
    n->nsp = matNullSpace__(m);
 }
@@ -632,7 +649,7 @@ static int SplitWithSavedVectors(node_t* n)
 
 Matrix_t *polymap(Matrix_t *v, Matrix_t *m, Poly_t *p)
 {
-   Matrix_t *result, *tmp;
+   Matrix_t *result, *tmp, *tmp2 = NULL;
    int i;
 
    result = matAlloc(v->field,v->nor,v->noc);
@@ -646,9 +663,14 @@ Matrix_t *polymap(Matrix_t *v, Matrix_t *m, Poly_t *p)
          ffStepPtr(&x,v->noc);
          ffStepPtr(&y,v->noc);
       }
-      matMul(tmp,m);
+      Matrix_t* swap = matMulInto(tmp2, tmp, m);
+      tmp2 = tmp;
+      tmp = swap;
    }
    matFree(tmp);
+   if (tmp2 != NULL) {
+      matFree(tmp2);
+   }
    return result;
 }
 
@@ -859,7 +881,7 @@ static int try_poly(node_t* n, Poly_t* pol, long multiplicityInF1)
       }
       else {
          matFree(n->nsp);
-         n->nsp = matNullSpace__(matInsert(n->word, pol));
+         n->nsp = matNullSpace__(matInsertPowers(NULL, WordPowers(n), pol));
          MTX_LOG2("%s 2nd spin-up, null-space = %lu", n->logPrefix, (unsigned long)n->nsp->nor);
 
          Matrix_t* sub2 = NULL;
@@ -949,7 +971,7 @@ static int try_ex_factor(node_t* n, Poly_t* cp, FPoly_t* cpf, int factor)
    polMul(q, gcd[2]);
 
    // Insert the word into i(x) and clean up polynomials.
-   iA = matInsert(n->word, q);
+   iA = matInsertPowers(NULL, WordPowers(n), q);
    polFree(gcd[0]);
    polFree(gcd[1]);
    polFree(gcd[2]);
@@ -0,0 +1,320 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// C MeatAxe - Arithmetic tables and field contexts
+// This code is shared by the standard kernel (kernel-0.c) and the bit-sliced kernel (kernel-2.c),
+// which use the same table files. The row layout is defined by the kernel, see ffCreateRowLayout().
+//
+// This program is free software; see the file COPYING for details.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "meataxe.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Gobal data
+
+// The following variables describe the current field. They are per-thread copies of the current
+// field context, see ffBindContext().
+
+MTX_THREAD_LOCAL int mtx_subfields[17];         // public list of proper subfields, terminated with 0
+
+// Arithmetic tables, see ReadTableFile().
+MTX_THREAD_LOCAL const FEL (*mtx_tmult)[256] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_tadd)[256] = NULL;
+MTX_THREAD_LOCAL const FEL *mtx_taddinv = NULL, *mtx_tmultinv = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_tffirst)[2] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_textract)[256] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_tnull)[256] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_tinsert)[256] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_embed)[MTX_MAXSUBFIELDORD] = NULL;
+MTX_THREAD_LOCAL const FEL (*mtx_restrict)[256] = NULL;
+
+/// @private
+/// Field context, see ffContext(). Contexts are created once per field and never change, so they
+/// can be shared by all threads.
+struct FfContext {
+   struct FfContext* next;
+   uint32_t order;
+   int characteristic;
+   FEL generator;
+   int mpb;
+   int subfields[17];
+   const FEL (*tmult)[256];
+   const FEL (*tadd)[256];
+   const FEL *taddinv, *tmultinv;
+   const FEL (*tffirst)[2];
+   const FEL (*textract)[256];
+   const FEL (*tnull)[256];
+   const FEL (*tinsert)[256];
+   const FEL (*tembed)[MTX_MAXSUBFIELDORD];
+   const FEL (*trestrict)[256];
+   const void* rowLayout;       // kernel specific, see ffCreateRowLayout()
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maps the table file for GF(«fl») into memory, creating it if necessary.
+
+static const uint8_t* MapTableFile(int fl, size_t* size)
+{
+   char fn[250];
+
+   // Try to map the table file
+   sprintf(fn,"p%3.3d.zzz",fl);
+   const uint8_t* data = (const uint8_t*) sysMapFile(fn, "rb::lib:noerror", size);
+   if (data != NULL) {
+      return data;
+   }
+
+   // Create the table file.
+   if (ffMakeTables(fl) != 0) {
+      mtxAbort(MTX_HERE,"Unable to build arithmetic tables");
+   }
+   return (const uint8_t*) sysMapFile(fn, "rb::lib", size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t le32(const uint8_t* p)
+{
+   return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+      | ((uint32_t) p[3] << 24);
+}
+
+// Sets up the table pointers of a new field context. The tables are used in place, without
+// copying.
+
+static void ReadTableFile(struct FfContext* ctx, const uint8_t* data, size_t size, int field)
+{
+   const size_t expectedSize = 5 * 4 + 2 * 256 * 256 + 256 * 2 + 3 * 8 * 256 + 2 * 256
+      + MTX_MAXSUBFIELDS * (4 + MTX_MAXSUBFIELDORD + 256);
+   if (size < expectedSize) {
+      mtxAbort(MTX_HERE,"Table file is corrupted");
+   }
+
+   // Check header
+   uint32_t hdr[5];
+   for (int i = 0; i < 5; ++i) {
+      hdr[i] = le32(data + 4 * i);
+   }
+   if ((hdr[2] != field) || (hdr[1] > field) ||
+       (hdr[0] <= 1) || (hdr[2] % hdr[0] != 0) || (hdr[3] < 1) || (hdr[3] > 8)) {
+      mtxAbort(MTX_HERE,"Table file is corrupted");
+   }
+   ctx->characteristic = hdr[0];
+   ctx->generator = (FEL) hdr[1];
+   ctx->mpb = hdr[3];
+   if (hdr[4] != (long) MTX_ZZZVERSION) {
+      mtxAbort(MTX_HERE,"Bad table file version: expected %d, found %d",
+                 (int)MTX_ZZZVERSION,(int)hdr[4]);
+   }
+
+   // Set table pointers
+   const uint8_t* p = data + 5 * 4;
+   ctx->tmult = (const FEL (*)[256]) p;
+   p += 256 * 256;
+   ctx->tadd = (const FEL (*)[256]) p;
+   p += 256 * 256;
+   ctx->tffirst = (const FEL (*)[2]) p;
+   p += 256 * 2;
+   ctx->textract = (const FEL (*)[256]) p;
+   p += 8 * 256;
+   ctx->taddinv = p;
+   p += 256;
+   ctx->tmultinv = p;
+   p += 256;
+   ctx->tnull = (const FEL (*)[256]) p;
+   p += 8 * 256;
+   ctx->tinsert = (const FEL (*)[256]) p;
+   p += 8 * 256;
+   uint32_t subfields[MTX_MAXSUBFIELDS];
+   for (int i = 0; i < MTX_MAXSUBFIELDS; ++i, p += 4) {
+      subfields[i] = le32(p);
+   }
+   ctx->tembed = (const FEL (*)[MTX_MAXSUBFIELDORD]) p;
+   p += MTX_MAXSUBFIELDS * MTX_MAXSUBFIELDORD;
+   ctx->trestrict = (const FEL (*)[256]) p;
+
+   // Copy subfields to public table
+   memset(ctx->subfields, 0, sizeof(ctx->subfields));
+   for (int i = 0; i < 4 && subfields[i] >= 2; ++i) {
+      ctx->subfields[i] = (int) subfields[i];
+   }
+
+   ctx->order = field;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Field contexts
+
+static struct FfContext* contexts = NULL;      // all loaded fields
+#if defined(MTX_DEFAULT_THREADS)
+static pthread_mutex_t contextsMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+static MTX_THREAD_LOCAL const struct FfContext* currentContext = NULL;
+
+/// Returns the field context for GF(@em field).
+///
+/// A field context contains the arithmetic tables and the row layout for one field. It is created
+/// on first use, which loads (and, if necessary, creates) the table file, and remains valid until
+/// the program terminates. Further calls with the same field order return the same context.
+///
+/// The bit-sliced kernel supports only GF(2), GF(3), GF(4), GF(8), and GF(16). Any other field
+/// order aborts the program.
+///
+/// This function is thread-safe and does not change the current field, see ffBindContext().
+
+const FfContext_t* ffContext(int field)
+{
+#if MTX_ZZZ == 2
+   if (field != 2 && field != 3 && field != 4 && field != 8 && field != 16) {
+      mtxAbort(MTX_HERE,"GF(%d) is not supported by the bit-sliced kernel", field);
+   }
+#else
+   if (field < 2) {
+      mtxAbort(MTX_HERE, "Invalid field order %d", field);
+   }
+#endif
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_lock(&contextsMutex);
+#endif
+   struct FfContext* ctx = contexts;
+   while (ctx != NULL && ctx->order != (uint32_t) field) {
+      ctx = ctx->next;
+   }
+   if (ctx == NULL) {
+      const int context = mtxBegin(MTX_HERE, "Loading arithmetic tables for GF(%d)", field);
+      ctx = ALLOC(struct FfContext);
+      memset(ctx, 0, sizeof(*ctx));
+      size_t size;
+      const uint8_t* tables = MapTableFile(field, &size);
+      ReadTableFile(ctx, tables, size, field);
+      ctx->rowLayout = ffCreateRowLayout(ctx->order, ctx->characteristic, ctx->mpb, ctx->tmult);
+      ctx->next = contexts;
+      contexts = ctx;
+      mtxEnd(context);
+   }
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_unlock(&contextsMutex);
+#endif
+   return ctx;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Returns the current field context of the calling thread, or NULL if no field was selected.
+
+const FfContext_t* ffCurrentContext()
+{
+   return currentContext;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Makes a field context the current field of the calling thread.
+///
+/// After this call, all kernel functions called by this thread work over the field of the given
+/// context. Other threads are not affected. Binding a context is cheap, no tables are loaded.
+/// A typical use is passing the caller's field (see ffCurrentContext()) to a parallel task.
+
+void ffBindContext(const FfContext_t* ctx)
+{
+   MTX_ASSERT(ctx != NULL);
+   if (ctx == currentContext) {
+      return;
+   }
+   ffOrder = ctx->order;
+   ffChar = ctx->characteristic;
+   ffGen = ctx->generator;
+   memcpy(mtx_subfields, ctx->subfields, sizeof(mtx_subfields));
+   mtx_tmult = ctx->tmult;
+   mtx_tadd = ctx->tadd;
+   mtx_taddinv = ctx->taddinv;
+   mtx_tmultinv = ctx->tmultinv;
+   mtx_tffirst = ctx->tffirst;
+   mtx_textract = ctx->textract;
+   mtx_tnull = ctx->tnull;
+   mtx_tinsert = ctx->tinsert;
+   mtx_embed = ctx->tembed;
+   mtx_restrict = ctx->trestrict;
+   ffBindRowLayout(ctx->rowLayout);
+   currentContext = ctx;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Sets the field order.
+///
+/// This function sets the current field to GF(@em field) and initializes the field arithmetic.
+/// Most kernel functions require that a field has been selected before they are used. Higher level
+/// functions like matXxx() call @c ffSetField internally.
+///
+/// The current field is a per-thread setting, so threads can work over different fields at the
+/// same time. The arithmetic tables are loaded only once per process (see ffContext()), and
+/// switching between fields that were used before is cheap.
+
+void ffSetField(int field)
+{
+   if ((field == ffOrder) || (field < 2)) {
+      return;
+   }
+   ffBindContext(ffContext(field));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Embed an element of a subfield.
+/// @param a Element of the subfield.
+/// @param subfield Subfield order. Must be a divisor of the current field order.
+/// @return @em a, embedded into the current field.
+
+FEL ffEmbed(FEL a, int subfield)
+{
+   int i;
+
+   if (subfield == ffOrder) {
+      return a;
+   }
+   for (i = 0; i < 4; ++i) {
+      if (mtx_subfields[i] == subfield) {
+         if (a >= subfield) {
+	    mtxAbort(MTX_HERE,"Invalid field element %d in GF(%d)",(int) a, subfield);
+	 }
+         return mtx_embed[i][a];
+      }
+   }
+   mtxAbort(MTX_HERE,"Cannot embed GF(%d) into GF(%d)",(int)subfield,(int)ffOrder);
+   return 0;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Restrict a field element to a subfield. The returned value can be used after switching to
+/// the subfield.
+///
+/// The function fails (aborting the program) if
+/// * \a subfield is not an integer root of the current field order, or
+/// * the element \a a is not a member of the subfield of order \a subfield.
+
+FEL ffRestrict(FEL a, int subfield)
+{
+   int i;
+
+   if (subfield == ffOrder) {
+      return a;
+   }
+   for (i = 0; i < 4; ++i) {
+      if (mtx_subfields[i] == subfield) {
+         FEL result = mtx_restrict[i][a];
+         if (result > subfield)
+            mtxAbort(MTX_HERE, "Field element is not in GF(%d) < GF(%d)", subfield, ffOrder);
+         return result;
+      }
+   }
+   mtxAbort(MTX_HERE,"Cannot restrict from GF(%d) to GF(%d)",ffOrder, subfield);
+   return 0;
+}
+
+// vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -11,6 +11,14 @@
 /// @addtogroup ff
 /// @{
 
+// Rows must be converted between the in-memory representation and the file format if the kernel
+// stores them in a different format, see ffPackRow().
+#if MTX_ZZZ == 1
+#define ROWS_NEED_PACKING mtx_linearRows
+#elif MTX_ZZZ == 2
+#define ROWS_NEED_PACKING 1
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Writes matrix rows to a binary file.
@@ -30,6 +38,20 @@ void ffWriteRows(MtxFile_t* file, PTR buf, uint32_t nor, uint32_t noc)
    int ok = 1;
    const size_t rowSizeUsed = ffRowSizeUsed(noc);
    const size_t rowSize = ffRowSize(noc);
+#if MTX_ZZZ == 1 || MTX_ZZZ == 2
+   if (ROWS_NEED_PACKING) {
+      // Convert from the in-memory representation to the file format.
+      uint8_t* const tmp = NALLOC(uint8_t, rowSizeUsed);
+      PTR x = buf;
+      for (uint32_t i = nor; ok && i > 0; --i) {
+         ffPackRow(tmp, x, noc);
+         ok = fwrite(tmp, rowSizeUsed, 1, file->file) == 1;
+         ffStepPtr(&x, noc);
+      }
+      sysFree(tmp);
+   }
+   else
+#endif
    if (rowSizeUsed == rowSize) {
       ok = fwrite(buf, rowSizeUsed, nor, file->file) == nor;
    }
@@ -65,6 +87,22 @@ void ffReadRows(MtxFile_t *f, PTR buf, uint32_t nor, uint32_t noc)
    const size_t rowSize = ffRowSize(noc);
 
    // Read rows.
+#if MTX_ZZZ == 1 || MTX_ZZZ == 2
+   if (ROWS_NEED_PACKING) {
+      // Convert from the file format to the in-memory representation.
+      uint8_t* const tmp = NALLOC(uint8_t, rowSizeUsed);
+      PTR x = buf;
+      for (uint32_t i = nor; i > 0; --i) {
+         if (fread(tmp, rowSizeUsed, 1, f->file) != 1) {
+            mtxAbort(MTX_HERE,"%s: read error: %s", f->name, strerror(errno));
+         }
+         ffUnpackRow(x, tmp, noc);
+         ffStepPtr(&x, noc);
+      }
+      sysFree(tmp);
+      return;
+   }
+#endif
    uint8_t *b = (uint8_t *) buf;
    for (uint32_t i = nor; i > 0; --i) {
       if (fread(b, rowSizeUsed, 1, f->file) != 1) {
@@ -72,8 +72,8 @@ const char* gapFelToString(FEL a)
 {
    if (ffOrder != felToGapQ)
        rebuildTable();
-   #if MTX_ZZZ == 0 || MTX_ZZZ == 1
-   // ZZZ = 0: Numeric range of FEL is {0, 1, ... , q-1}
+   #if MTX_ZZZ == 0 || MTX_ZZZ == 1 || MTX_ZZZ == 2
+   // ZZZ = 0, 2: Numeric range of FEL is {0, 1, ... , q-1}
    // ZZZ = 1: Numeric range of FEL is {0, 1, ... , q-2, 0xFFFF}
    return ((uint32_t) a >= felToGapQ) ? felToGapTable[felToGapQ - 1] : felToGapTable[a];
    #else
@@ -21,9 +21,19 @@
 
 
 typedef unsigned char BYTE;
-static int MPB = 0;             /* No. of marks per byte */
 
-int mtx_subfields[17];         // public list of proper subfields, terminated with 0
+// The following variables describe the current field. They are per-thread copies of the current
+// field context, see ffBindContext().
+
+static MTX_THREAD_LOCAL int MPB = 0;             /* No. of marks per byte */
+
+/// @private
+/// Row layout of a field, see ffCreateRowLayout().
+struct RowLayout {
+   int mpb;
+   const uint8_t (*nibbleTab)[32];
+   uint32_t primeP, primeInv, primeMaxTerms;
+};
 
 static int isFel(FEL x) { return (unsigned int) x < (unsigned int) ffOrder; }
 
@@ -32,13 +42,14 @@ static int isFel(FEL x) { return (unsigned int) x < (unsigned int) ffOrder; }
 ///
 /// The finite field part of the kernel provides finite field arithmetic and
 /// basic operations with vectors and matrices over finite fields.
-/// The kernel cannot operate simultaneously with different finite fields,
-/// because there is a global row size and a global field order which must
-/// be maintained by the higher layers.
+/// The kernel works over one field at a time, which is selected with ffSetField(). If
+/// multithreading is enabled, the current field is selected per thread, and different threads
+/// may use different fields at the same time (see ffContext()).
 ///
-/// There are two finite field modules available: one for small fields (up
-/// to 256) and one for larger fields (up to 2<sup>16</sup>). The finite field
-/// module is selected at compile time.
+/// There are three finite field modules available: one for small fields (up
+/// to 256), one for larger fields (up to 2<sup>16</sup>), and a bit-sliced module
+/// for GF(2), GF(3), GF(4), GF(8), and GF(16). The finite field module is selected
+/// at compile time.
 ///
 /// @par 'Small' Kernel (q≤256)
 /// In the "small" kernel, field elements of GF(q) are represented by the numbers 0,1,...,q-1.
@@ -58,6 +69,17 @@ static int isFel(FEL x) { return (unsigned int) x < (unsigned int) ffOrder; }
 /// occupies two bytes. Non-zero elements are stored as their logarithms with
 /// respect to a fixed generator. In particular, the unit element is represented by
 /// the integer 0. The zero element is represented by the special value 0xFFFF.
+/// For prime fields and for fields of characteristic 2, however, rows are stored in memory using
+/// the integer representation (see ffToInt()), so row operations can use integer arithmetic or,
+/// for q=2ⁿ, XOR and bit matrix multiplication. Field elements are converted by ffInsert() and
+/// ffExtract(), and data files always contain logarithms. Programs must therefore not access
+/// rows directly.
+///
+/// @par 'Bit-sliced' Kernel (q≤16)
+/// The bit-sliced kernel uses the same numbering of field elements as the small kernel, but
+/// stores rows as bit planes: each group of 64 columns occupies one 64-bit word per bit of the
+/// element number (two words for GF(3), where only the values 0, 1, and 2 occur). Row operations
+/// then work on 64 columns at once. Data files have the same format as for the small kernel.
 ///
 /// As a consequence of the different representations of field elements
 /// in the small and big version, there are some rules which should be
@@ -192,97 +214,399 @@ static int isFel(FEL x) { return (unsigned int) x < (unsigned int) ffOrder; }
 /// is evaluated exactly once.
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vectorized row operations for characteristic 2 and prime fields
+//
+// In characteristic 2, adding rows is a bitwise XOR, and multiplying a packed byte by a fixed
+// field element is linear over GF(2). Thus, the multiplication table for a field element f
+// is determined by its values on the low and high nibble: f·x = f·(x & 0x0F) ^ f·(x & 0xF0).
+// With these two 16-byte tables, a row can be multiplied with PSHUFB-type shuffles.
+//
+// The instruction set is selected at run time. The environment variable MTX_SIMD can be set to
+// "none", "sse4.1", "avx2", or "avx512" to limit the instruction set, e.g., for benchmarking.
+
+// Nibble multiplication tables: nibbleTab[f][0..15] = f·i, nibbleTab[f][16..31] = f·(16i).
+static MTX_THREAD_LOCAL const uint8_t (*nibbleTab)[32] = NULL;
+
+// Prime fields GF(p) with 17 ≤ p ≤ 251 are stored with one element per byte, and the element
+// number is the residue modulo p. Instead of two table lookups per element, the prime field
+// operations compute with integers and reduce modulo p only when necessary:
+// - primeMulAdd computes dest = (dest + f·src) mod p. Since dest + f·src < 2¹⁶, the quotient is
+//   approximated by multiplication with ⌊2¹⁶/p⌋, followed by one conditional subtraction.
+// - primeAcc accumulates f·src into 32-bit lanes without any reduction. The caller must reduce
+//   the accumulator after at most primeMaxTerms products.
+// Both are plain loops which the compiler vectorizes for the selected instruction set.
+
+static MTX_THREAD_LOCAL uint32_t primeP = 0;        // p, or 0 if not a prime field > 16
+static MTX_THREAD_LOCAL uint32_t primeInv = 0;      // ⌊2¹⁶/p⌋
+static MTX_THREAD_LOCAL uint32_t primeMaxTerms = 0; // max. number of products fitting into 32 bits
+
+typedef void XorBytesFunc(uint8_t* dest, const uint8_t* src, size_t n);
+typedef void MulAddBytesFunc(uint8_t* dest, const uint8_t* src, const uint8_t* tab, size_t n);
+typedef void MulBytesFunc(uint8_t* dest, const uint8_t* tab, size_t n);
+typedef void PrimeMulAddFunc(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n);
+typedef void PrimeAccFunc(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n);
+
+static struct {
+   const char* name;
+   XorBytesFunc* xorBytes;          // dest ^= src
+   MulAddBytesFunc* mulAddBytes;    // dest ^= f·src
+   MulBytesFunc* mulBytes;          // dest = f·dest
+   PrimeMulAddFunc* primeMulAdd;    // dest = (dest + f·src) mod p
+   PrimeAccFunc* primeAcc;          // acc += f·src (no reduction)
+} rowOps = { NULL, NULL, NULL, NULL, NULL, NULL };
+
+// Scalar versions. «n» is always a multiple of sizeof(long).
+
+static void xorBytesScalar(uint8_t* dest, const uint8_t* src, size_t n)
+{
+   long* l1 = (long*) dest;
+   const long* l2 = (const long*) src;
+   for (size_t i = n / sizeof(long); i != 0; --i) {
+      const long x = *l2++;
+      if (x != 0) { *l1 ^= x; }
+      l1++;
+   }
+}
 
-static FILE *OpenTableFile(int fl)
+static void mulAddBytesScalar(uint8_t* dest, const uint8_t* src, const uint8_t* tab, size_t n)
 {
-   char fn[250];
-   FILE *fd;
+   for (; n != 0; --n) {
+      const uint8_t x = *src++;
+      if (x != 0) {
+         *dest ^= tab[x & 0x0F] ^ tab[16 + (x >> 4)];
+      }
+      ++dest;
+   }
+}
 
-   // Try to open the table file
-   sprintf(fn,"p%3.3d.zzz",fl);
-   if ((fd = sysFopen(fn,"rb::lib:noerror")) != NULL) {
-      return fd;
+static void mulBytesScalar(uint8_t* dest, const uint8_t* tab, size_t n)
+{
+   for (; n != 0; --n) {
+      const uint8_t x = *dest;
+      *dest++ = tab[x & 0x0F] ^ tab[16 + (x >> 4)];
    }
+}
 
-   // Create the table file.
-   if (ffMakeTables(fl) != 0) {
-      mtxAbort(MTX_HERE,"Unable to build arithmetic tables");
+// Prime field operations. These are compiled once for each instruction set, see below.
+
+static inline void primeMulAddBody(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n)
+{
+   const uint32_t p = primeP;
+   const uint32_t inv = primeInv;
+   for (size_t i = 0; i < n; ++i) {
+      const uint32_t x = dest[i] + f * src[i];
+      const uint32_t r = x - ((x * inv) >> 16) * p;
+      dest[i] = (uint8_t)(r >= p ? r - p : r);
    }
-   return sysFopen(fn,"rb::lib");
 }
 
+static inline void primeAccBody(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n)
+{
+   for (size_t i = 0; i < n; ++i) {
+      acc[i] += f * src[i];
+   }
+}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+static void primeMulAddScalar(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeMulAddBody(dest, src, f, n);
+}
 
-static void ReadTableFile(FILE *fd, int field)
+static void primeAccScalar(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n)
 {
-   uint32_t hdr[5];
+   primeAccBody(acc, src, f, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
 
-   // Read header, perform some checks
-   sysRead32(fd,hdr,5);
-   if ((hdr[2] != field) || (hdr[1] < 0) || (hdr[1] > field) ||
-       (hdr[0] <= 1) || (hdr[2] % hdr[0] != 0) || (hdr[3] < 1) || (hdr[3] > 8)) {
-      mtxAbort(MTX_HERE,"Table file is corrupted");
+#define MTX_HAVE_X86_SIMD
+
+__attribute__((target("sse4.1")))
+static void xorBytesSse(uint8_t* dest, const uint8_t* src, size_t n)
+{
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      const __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+      const __m128i y = _mm_loadu_si128((const __m128i*)(dest + i));
+      _mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(x, y));
    }
-   ffChar = hdr[0];
-   ffGen = (FEL) hdr[1];
-   MPB = hdr[3];
-   if (hdr[4] != (long) MTX_ZZZVERSION) {
-      mtxAbort(MTX_HERE,"Bad table file version: expected %d, found %d",
-                 (int)MTX_ZZZVERSION,(int)hdr[4]);
+   xorBytesScalar(dest + i, src + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void mulAddBytesSse(uint8_t* dest, const uint8_t* src, const uint8_t* tab, size_t n)
+{
+   const __m128i lo = _mm_loadu_si128((const __m128i*) tab);
+   const __m128i hi = _mm_loadu_si128((const __m128i*)(tab + 16));
+   const __m128i mask = _mm_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      const __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+      const __m128i p = _mm_xor_si128(
+            _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+            _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+      const __m128i y = _mm_loadu_si128((const __m128i*)(dest + i));
+      _mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(y, p));
    }
+   mulAddBytesScalar(dest + i, src + i, tab, n - i);
+}
 
-   uint32_t subfields[4];
+__attribute__((target("sse4.1")))
+static void mulBytesSse(uint8_t* dest, const uint8_t* tab, size_t n)
+{
+   const __m128i lo = _mm_loadu_si128((const __m128i*) tab);
+   const __m128i hi = _mm_loadu_si128((const __m128i*)(tab + 16));
+   const __m128i mask = _mm_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      const __m128i x = _mm_loadu_si128((const __m128i*)(dest + i));
+      const __m128i p = _mm_xor_si128(
+            _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+            _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), mask)));
+      _mm_storeu_si128((__m128i*)(dest + i), p);
+   }
+   mulBytesScalar(dest + i, tab, n - i);
+}
 
-   /* Read tables
-      ----------- */
-   sysRead8(fd, mtx_tmult, sizeof(mtx_tmult));
-   sysRead8(fd, mtx_tadd, sizeof(mtx_tadd));
-   sysRead8(fd, mtx_tffirst,sizeof(mtx_tffirst));
-   sysRead8(fd, mtx_textract,sizeof(mtx_textract));
-   sysRead8(fd, mtx_taddinv,sizeof(mtx_taddinv));
-   sysRead8(fd, mtx_tmultinv,sizeof(mtx_tmultinv));
-   sysRead8(fd, mtx_tnull,sizeof(mtx_tnull));
-   sysRead8(fd, mtx_tinsert,sizeof(mtx_tinsert));
-   sysRead32(fd,subfields,MTX_MAXSUBFIELDS);
-   sysRead8(fd,mtx_embed, MTX_MAXSUBFIELDS * MTX_MAXSUBFIELDORD);
-   sysRead8(fd,mtx_restrict, MTX_MAXSUBFIELDS * 256);
+__attribute__((target("avx2")))
+static void xorBytesAvx2(uint8_t* dest, const uint8_t* src, size_t n)
+{
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+      const __m256i y = _mm256_loadu_si256((const __m256i*)(dest + i));
+      _mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(x, y));
+   }
+   xorBytesScalar(dest + i, src + i, n - i);
+}
 
-   // Copy subfields to public table
-   memset(mtx_subfields, 0, sizeof(mtx_subfields));
-   for (int i = 0; i < 4 && subfields[i] >= 2; ++i) {
-      mtx_subfields[i] = (int) subfields[i];
+__attribute__((target("avx2")))
+static void mulAddBytesAvx2(uint8_t* dest, const uint8_t* src, const uint8_t* tab, size_t n)
+{
+   const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) tab));
+   const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(tab + 16)));
+   const __m256i mask = _mm256_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+      const __m256i p = _mm256_xor_si256(
+            _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask)));
+      const __m256i y = _mm256_loadu_si256((const __m256i*)(dest + i));
+      _mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(y, p));
    }
+   mulAddBytesScalar(dest + i, src + i, tab, n - i);
+}
 
-   ffOrder = field;
+__attribute__((target("avx2")))
+static void mulBytesAvx2(uint8_t* dest, const uint8_t* tab, size_t n)
+{
+   const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) tab));
+   const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(tab + 16)));
+   const __m256i mask = _mm256_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)(dest + i));
+      const __m256i p = _mm256_xor_si256(
+            _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask)));
+      _mm256_storeu_si256((__m256i*)(dest + i), p);
+   }
+   mulBytesScalar(dest + i, tab, n - i);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
+__attribute__((target("avx512f,avx512bw")))
+static void xorBytesAvx512(uint8_t* dest, const uint8_t* src, size_t n)
+{
+   size_t i = 0;
+   for (; i + 64 <= n; i += 64) {
+      const __m512i x = _mm512_loadu_si512((const void*)(src + i));
+      const __m512i y = _mm512_loadu_si512((const void*)(dest + i));
+      _mm512_storeu_si512((void*)(dest + i), _mm512_xor_si512(x, y));
+   }
+   xorBytesScalar(dest + i, src + i, n - i);
+}
 
-/// Sets the field order.
-///
-/// This function sets the current field to GF(@em field) and initializes the field arithmetic.
-/// Most kernel functions require that a field has been selected before they are used. Higher level
-/// functions like matXxx() call @c ffSetField internally.
-///
-/// This function is not treadsafe! Programs working with different fields must make sure that
-/// all threads are working with the same field at all times.
+__attribute__((target("avx512f,avx512bw")))
+static void mulAddBytesAvx512(uint8_t* dest, const uint8_t* src, const uint8_t* tab, size_t n)
+{
+   const __m512i lo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*) tab));
+   const __m512i hi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)(tab + 16)));
+   const __m512i mask = _mm512_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 64 <= n; i += 64) {
+      const __m512i x = _mm512_loadu_si512((const void*)(src + i));
+      const __m512i p = _mm512_xor_si512(
+            _mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+            _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi16(x, 4), mask)));
+      const __m512i y = _mm512_loadu_si512((const void*)(dest + i));
+      _mm512_storeu_si512((void*)(dest + i), _mm512_xor_si512(y, p));
+   }
+   mulAddBytesScalar(dest + i, src + i, tab, n - i);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void mulBytesAvx512(uint8_t* dest, const uint8_t* tab, size_t n)
+{
+   const __m512i lo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*) tab));
+   const __m512i hi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)(tab + 16)));
+   const __m512i mask = _mm512_set1_epi8(0x0F);
+   size_t i = 0;
+   for (; i + 64 <= n; i += 64) {
+      const __m512i x = _mm512_loadu_si512((const void*)(dest + i));
+      const __m512i p = _mm512_xor_si512(
+            _mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+            _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi16(x, 4), mask)));
+      _mm512_storeu_si512((void*)(dest + i), p);
+   }
+   mulBytesScalar(dest + i, tab, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void primeMulAddSse(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeMulAddBody(dest, src, f, n);
+}
+
+__attribute__((target("sse4.1")))
+static void primeAccSse(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeAccBody(acc, src, f, n);
+}
+
+__attribute__((target("avx2")))
+static void primeMulAddAvx2(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeMulAddBody(dest, src, f, n);
+}
+
+__attribute__((target("avx2")))
+static void primeAccAvx2(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeAccBody(acc, src, f, n);
+}
 
-void ffSetField(int field)
+__attribute__((target("avx512f,avx512bw")))
+static void primeMulAddAvx512(uint8_t* dest, const uint8_t* src, uint32_t f, size_t n)
 {
-   FILE *fd;
+   primeMulAddBody(dest, src, f, n);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void primeAccAvx512(uint32_t* acc, const uint8_t* src, uint32_t f, size_t n)
+{
+   primeAccBody(acc, src, f, n);
+}
 
-   if ((field == ffOrder) || (field < 2)) {
+#endif
+
+// Selects the row operations for the current CPU. Called once, or by ffSelectSimd().
+
+static void selectRowOps()
+{
+   const char* limit = getenv("MTX_SIMD");
+   if (limit == NULL) {
+      limit = "";
+   }
+   rowOps.name = "none";
+   rowOps.xorBytes = xorBytesScalar;
+   rowOps.mulAddBytes = mulAddBytesScalar;
+   rowOps.mulBytes = mulBytesScalar;
+   rowOps.primeMulAdd = primeMulAddScalar;
+   rowOps.primeAcc = primeAccScalar;
+   if (!strcmp(limit, "none")) {
       return;
    }
-   const int context = mtxBegin(MTX_HERE, "Loading arithmetic tables for GF(%d)", field);
-   fd = OpenTableFile(field);
-   if (fd == NULL) {
-      mtxAbort(MTX_HERE,"Cannot open table file for GF(%d)", field);
+#if defined(MTX_HAVE_X86_SIMD)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512bw") && strcmp(limit, "avx2") && strcmp(limit, "sse4.1")) {
+      rowOps.name = "avx512";
+      rowOps.xorBytes = xorBytesAvx512;
+      rowOps.mulAddBytes = mulAddBytesAvx512;
+      rowOps.mulBytes = mulBytesAvx512;
+      rowOps.primeMulAdd = primeMulAddAvx512;
+      rowOps.primeAcc = primeAccAvx512;
+   } else if (__builtin_cpu_supports("avx2") && strcmp(limit, "sse4.1")) {
+      rowOps.name = "avx2";
+      rowOps.xorBytes = xorBytesAvx2;
+      rowOps.mulAddBytes = mulAddBytesAvx2;
+      rowOps.mulBytes = mulBytesAvx2;
+      rowOps.primeMulAdd = primeMulAddAvx2;
+      rowOps.primeAcc = primeAccAvx2;
+   } else if (__builtin_cpu_supports("sse4.1")) {
+      rowOps.name = "sse4.1";
+      rowOps.xorBytes = xorBytesSse;
+      rowOps.mulAddBytes = mulAddBytesSse;
+      rowOps.mulBytes = mulBytesSse;
+      rowOps.primeMulAdd = primeMulAddSse;
+      rowOps.primeAcc = primeAccSse;
    }
-   ReadTableFile(fd,field);
-   mtxEnd(context);
-   fclose(fd);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Selects the SIMD row operations again.
+/// The row operations are normally selected once, when the first field is set up. This function
+/// repeats the selection, taking into account the current value of the MTX_SIMD environment
+/// variable. It is intended for tests and benchmarks and must not be called while other threads
+/// are using the kernel.
+/// @return The name of the selected instruction set ("none", "sse4.1", "avx2", or "avx512").
+
+const char* ffSelectSimd()
+{
+   selectRowOps();
+   return rowOps.name;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Creates the row layout and prepares the row operations for a new field context. Called by
+// ffContext().
+
+const void* ffCreateRowLayout(uint32_t order, int characteristic, int mpb,
+                              const FEL (*tmult)[256])
+{
+   if (rowOps.name == NULL) {
+      selectRowOps();
+      MTX_LOGD("Using %s row operations", rowOps.name);
+   }
+   struct RowLayout* layout = ALLOC(struct RowLayout);
+   memset(layout, 0, sizeof(*layout));
+   layout->mpb = mpb;
+   if (characteristic == 2) {
+      uint8_t (*tab)[32] = (uint8_t (*)[32]) sysMalloc(256 * 32);
+      for (int f = 0; f < 256; ++f) {
+         for (int i = 0; i < 16; ++i) {
+            tab[f][i] = tmult[f][i];
+            tab[f][16 + i] = tmult[f][i << 4];
+         }
+      }
+      layout->nibbleTab = (const uint8_t (*)[32]) tab;
+   }
+   if (order == (uint32_t) characteristic && mpb == 1) {
+      layout->primeP = order;
+      layout->primeInv = 65536 / layout->primeP;
+      layout->primeMaxTerms =
+         (UINT32_MAX - layout->primeP) / ((layout->primeP - 1) * (layout->primeP - 1));
+   }
+   return layout;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Makes a row layout current for the calling thread. Called by ffBindContext().
+
+void ffBindRowLayout(const void* rowLayout)
+{
+   const struct RowLayout* layout = (const struct RowLayout*) rowLayout;
+   MPB = layout->mpb;
+   nibbleTab = layout->nibbleTab;
+   primeP = layout->primeP;
+   primeInv = layout->primeInv;
+   primeMaxTerms = layout->primeMaxTerms;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -331,60 +655,6 @@ size_t ffRowSizeUsed(int noc)
 }
 
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/// Embed an element of a subfield.
-/// @param a Element of the subfield.
-/// @param subfield Subfield order. Must be a divisor of the current field order.
-/// @return @em a, embedded into the current field.
-
-FEL ffEmbed(FEL a, int subfield)
-{
-   int i;
-
-   if (subfield == ffOrder) {
-      return a;
-   }
-   for (i = 0; i < 4; ++i) {
-      if (mtx_subfields[i] == subfield) {
-         if (a >= subfield) {
-	    mtxAbort(MTX_HERE,"Invalid field element %d in GF(%d)",(int) a, subfield);
-	 }
-         return mtx_embed[i][a];
-      }
-   }
-   mtxAbort(MTX_HERE,"Cannot embed GF(%d) into GF(%d)",(int)subfield,(int)ffOrder);
-   return 0;
-}
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/// Restrict a field element to a subfield. The returned value can be used after switching to
-/// the subfield.
-///
-/// The function fails (aborting the program) if
-/// * \a subfield is not an integer root of the current field order, or
-/// * the element \a a is not a member of the subfield of order \a subfield.
-
-FEL ffRestrict(FEL a, int subfield)
-{
-   int i;
-
-   if (subfield == ffOrder) {
-      return a;
-   }
-   for (i = 0; i < 4; ++i) {
-      if (mtx_subfields[i] == subfield) {
-         FEL result = mtx_restrict[i][a];
-         if (result > subfield)
-            mtxAbort(MTX_HERE, "Field element is not in GF(%d) < GF(%d)", subfield, ffOrder);
-         return result;
-      }
-   }
-   mtxAbort(MTX_HERE,"Cannot restrict from GF(%d) to GF(%d)",ffOrder, subfield);
-   return 0;
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Add two rows.
@@ -399,19 +669,16 @@ PTR ffAddRow(PTR dest, PTR src, uint32_t noc)
    register int i;
 
    if (ffChar == 2) {   /* characteristic 2 is simple... */
-      register long *l1 = (long *) dest;
-      register long *l2 = (long *) src;
-      for (i = lpr(noc); i != 0; --i) {
-         register long x = *l2++;
-         if (x != 0) { *l1 ^= x; }
-         l1++;
-      }
+      rowOps.xorBytes(dest, src, ffRowSize(noc));
+   } else if (primeP != 0) {
+      rowOps.primeMulAdd(dest, src, 1, ffRowSize(noc));
    } else {             /* any other characteristic */
+      const FEL (* const tadd)[256] = mtx_tadd;  // not reloaded after each store
       register BYTE *p1 = dest;
       register BYTE *p2 = src;
       for (i = ffRowSize(noc); i != 0; --i) {
          register int x = *p2++;
-         if (x != 0) { *p1 = mtx_tadd[*p1][x]; }
+         if (x != 0) { *p1 = tadd[*p1][x]; }
          p1++;
       }
    }
@@ -438,21 +705,19 @@ void ffAddRowPartial(PTR dest, PTR src, uint32_t first, uint32_t noc)
 
    if (ffChar == 2)     /* characteristic 2 is simple... */
    {
-      const uint32_t firstl = first / MPB / sizeof(long);
-      long *l1 = (long *) dest + firstl;
-      long *l2 = (long *) src + firstl;
-      for (uint32_t i = ffRowSize(noc) / sizeof(long) - firstl; i > 0; --i) {
-         long x = *l2++;
-         *l1 ^= x;
-         l1++;
-      }
+      const size_t offset = first / MPB / sizeof(long) * sizeof(long);
+      rowOps.xorBytes(dest + offset, src + offset, ffRowSize(noc) - offset);
+   }
+   else if (primeP != 0) {
+      rowOps.primeMulAdd(dest + first, src + first, 1, ffRowSize(noc) - first);
    }
    else {               /* any other characteristic */
+      const FEL (* const tadd)[256] = mtx_tadd;
       BYTE *p1 = dest + first / MPB;
       BYTE *p2 = src + first / MPB;
       for (int i = ffRowSize(noc) - first / MPB; i != 0; --i) {
          int x = *p2++;
-         *p1 = mtx_tadd[*p1][x];
+         *p1 = tadd[*p1][x];
          p1++;
       }
    }
@@ -474,6 +739,8 @@ void ffMulRow(PTR row, FEL mark, int noc)
    MTX_ASSERT_DEBUG(isFel(mark));
    if (mark == FF_ZERO) {
       memset(row, 0, ffRowSize(noc));
+   } else if (mark != FF_ONE && ffChar == 2) {
+      rowOps.mulBytes(row, nibbleTab[mark], ffRowSize(noc));
    } else if (mark != FF_ONE) {
       const uint8_t* const multab = mtx_tmult[mark];
       uint8_t* m = row;
@@ -496,13 +763,20 @@ void ffAddMulRow(PTR dest, PTR src, FEL f, uint32_t noc)
    if (f == FF_ONE) {
       ffAddRow(dest,src, noc);
    }
+   else if (f != FF_ZERO && ffChar == 2) {
+      rowOps.mulAddBytes(dest, src, nibbleTab[f], ffRowSize(noc));
+   }
+   else if (f != FF_ZERO && primeP != 0) {
+      rowOps.primeMulAdd(dest, src, f, ffRowSize(noc));
+   }
    else if (f != FF_ZERO) {
-      uint8_t *multab = mtx_tmult[f];
+      const uint8_t *multab = mtx_tmult[f];
+      const FEL (* const tadd)[256] = mtx_tadd;
       uint8_t *p1 = dest;
       uint8_t *p2 = src;
       for (int i = ffRowSize(noc); i != 0; --i) {
          if (*p2 != 0) {
-            *p1 = mtx_tadd[*p1][multab[*p2]];
+            *p1 = tadd[*p1][multab[*p2]];
          }
          ++p1;
          ++p2;
@@ -533,13 +807,21 @@ void ffAddMulRowPartial(PTR dest, PTR src, FEL f, uint32_t firstcol, uint32_t no
    if (f == FF_ONE) {
       ffAddRowPartial(dest, src, firstcol, noc);
    }
+   else if (f != FF_ZERO && ffChar == 2) {
+      const size_t offset = firstcol / MPB;
+      rowOps.mulAddBytes(dest + offset, src + offset, nibbleTab[f], ffRowSize(noc) - offset);
+   }
+   else if (f != FF_ZERO && primeP != 0) {
+      rowOps.primeMulAdd(dest + firstcol, src + firstcol, f, ffRowSize(noc) - firstcol);
+   }
    else if (f != FF_ZERO) {
-      BYTE * const multab = mtx_tmult[f];
+      const BYTE * const multab = mtx_tmult[f];
+      const FEL (* const tadd)[256] = mtx_tadd;
       BYTE *p1 = dest + firstcol / MPB;
       BYTE *p2 = src + firstcol / MPB;
       for (uint32_t i = ffRowSize(noc) - firstcol / MPB; i != 0; --i) {
          if (*p2 != 0) {
-            *p1 = mtx_tadd[*p1][multab[*p2]];
+            *p1 = tadd[*p1][multab[*p2]];
          }
          ++p1;
          ++p2;
@@ -575,6 +857,44 @@ int ffToInt(FEL f)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// ffMapRow() for prime fields > 16. The result is accumulated in 32-bit integers, which are
+// reduced modulo p only when they might overflow. Columns are processed in chunks, so the
+// accumulator stays in the L1 cache.
+
+#define PRIME_CHUNK 1024
+
+static void mapRowPrime(PTR result, PTR row, PTR matrix, int nor, int noc)
+{
+   const size_t rowSize = ffRowSize(noc);
+   uint32_t acc[PRIME_CHUNK];
+
+   for (int c0 = 0; c0 < noc; c0 += PRIME_CHUNK) {
+      const size_t n = (noc - c0 < PRIME_CHUNK) ? (size_t)(noc - c0) : PRIME_CHUNK;
+      memset(acc, 0, n * sizeof(acc[0]));
+      uint32_t terms = 0;
+      const BYTE* m = (const BYTE*) matrix + c0;
+      for (int i = 0; i < nor; ++i, m += rowSize) {
+         const uint32_t f = row[i];
+         if (f == 0) {
+            continue;
+         }
+         if (terms == primeMaxTerms) {
+            for (size_t k = 0; k < n; ++k) {
+               acc[k] %= primeP;
+            }
+            terms = 1;
+         }
+         rowOps.primeAcc(acc, m, f, n);
+         ++terms;
+      }
+      for (size_t k = 0; k < n; ++k) {
+         result[c0 + k] = (BYTE)(acc[k] % primeP);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Multiply a vector by a matrix.
 /// This function multiplies the vector @p row from the right by the matrix @p mat and
 /// stores the result into @p result.
@@ -618,14 +938,13 @@ void ffMapRow(PTR result, PTR row, PTR matrix, int nor, int noc)
             }
             else
             {
-               register long *x2 = (long *)result;
-               register int k;
-               for (k = LPR; k; --k) {
-                  *x2++ ^= *x1++;
-               }
+               rowOps.xorBytes(result, (const uint8_t*) x1, LPR * sizeof(long));
+               x1 += LPR;
             }
          }
       }
+   } else if (primeP != 0) {
+      mapRowPrime(result, row, matrix, nor, noc);
    } else {             /* Any other field */
       const size_t rowSize = ffRowSize(noc);
       register BYTE *brow = (BYTE *) row;
@@ -636,23 +955,30 @@ void ffMapRow(PTR result, PTR row, PTR matrix, int nor, int noc)
             pos = 0;
             ++brow;
          }
-         if (f != FF_ZERO) {
+         if (f != FF_ZERO && ffChar == 2) {
+            if (f == FF_ONE) {
+               rowOps.xorBytes(result, m, rowSize);
+            } else {
+               rowOps.mulAddBytes(result, m, nibbleTab[f], rowSize);
+            }
+         } else if (f != FF_ZERO) {
+            const FEL (* const tadd)[256] = mtx_tadd;
             register BYTE *v = m;
             register BYTE *r = result;
             register int k = rowSize;
             if (f == FF_ONE) {
                for (; k != 0; --k) {
                   if (*v != 0) {
-                     *r = mtx_tadd[*r][*v];
+                     *r = tadd[*r][*v];
                   }
                   ++r;
                   ++v;
                }
             } else {
-               register BYTE *multab = mtx_tmult[f];
+               register const BYTE *multab = mtx_tmult[f];
                for (; k != 0; --k) {
                   if (*v != 0) {
-                     *r = mtx_tadd[multab[*v]][*r];
+                     *r = tadd[multab[*v]][*r];
                   }
                   ++v;
                   ++r;
@@ -678,6 +1004,19 @@ FEL ffScalarProduct(PTR a, PTR b, int noc)
    const uint8_t *bp = (const uint8_t *) b;
    FEL f = FF_ZERO;
 
+   if (primeP != 0) {
+      // Delayed reduction, the partial sum (< p) counts as one product.
+      uint32_t sum = 0;
+      for (int i0 = 0; i0 < noc; i0 += primeMaxTerms - 1) {
+         const int n = (noc - i0 < (int) primeMaxTerms - 1) ? noc - i0 : (int) primeMaxTerms - 1;
+         for (int i = i0; i < i0 + n; ++i) {
+            sum += (uint32_t) ap[i] * bp[i];
+         }
+         sum %= primeP;
+      }
+      return (FEL) sum;
+   }
+
    int i = noc;
    // full bytes
    for (; i >= MPB; i -= MPB) {
@@ -715,7 +1054,7 @@ FEL ffScalarProduct(PTR a, PTR b, int noc)
 void ffExtractColumn(PTR mat, int nor, int noc, int col, PTR result)
 {
    register BYTE *x = (BYTE *)mat + (col / MPB);
-   register BYTE *extab = mtx_textract[col % MPB];
+   register const BYTE *extab = mtx_textract[col % MPB];
    register BYTE a = 0;
    register int ind = 0;
    register BYTE *y = result;
@@ -36,20 +36,25 @@
 // programs. The chosen generator of the field's multiplicative group (@ref ffOrder) has the
 // same external representation
 
-int mtx_subfields[17];                    // public list of subfields, terminated with 0
-
-static uint16_t minusone;                 // -1
-static uint16_t *inc = NULL;              // inc[a] = a+1
-static uint16_t *FfFromIntTable = NULL;
-static uint16_t *FfToIntTable = NULL;
-static uint16_t subfieldsTable[17];       // internal list of subfield orders, terminated with 0
-static uint16_t *embeddingTables = NULL;  // combined embed/restrict tables
-
-static uint32_t P = 0;         // Characteristic
-static uint32_t Q = 0;         // Field order
-static uint32_t Q1 = 0;        // Q-1, order of the multiplicative group
-static uint32_t N;             // Degree over prime field, Q=P^N
-static uint32_t Gen;           // Generator of the multiplicative group
+// The following variables describe the current field. They are per-thread copies of the current
+// field context, see ffBindContext().
+
+MTX_THREAD_LOCAL int mtx_subfields[17];          // public list of subfields, terminated with 0
+MTX_THREAD_LOCAL int mtx_linearRows = 0;         // 1: rows contain integers instead of logarithms
+
+static MTX_THREAD_LOCAL uint16_t minusone;                 // -1
+// The tables point into the mapped table file, see LoadTables_().
+static MTX_THREAD_LOCAL const uint16_t *inc = NULL;        // inc[a] = a+1
+static MTX_THREAD_LOCAL const uint16_t *FfFromIntTable = NULL;
+static MTX_THREAD_LOCAL const uint16_t *FfToIntTable = NULL;
+static MTX_THREAD_LOCAL uint16_t subfieldsTable[17];       // internal list of subfield orders
+static MTX_THREAD_LOCAL const uint16_t *embeddingTables = NULL;  // combined embed/restrict tables
+
+static MTX_THREAD_LOCAL uint32_t P = 0;         // Characteristic
+static MTX_THREAD_LOCAL uint32_t Q = 0;         // Field order
+static MTX_THREAD_LOCAL uint32_t Q1 = 0;        // Q-1, order of the multiplicative group
+static MTX_THREAD_LOCAL uint32_t N;             // Degree over prime field, Q=P^N
+static MTX_THREAD_LOCAL uint32_t Gen;           // Generator of the multiplicative group
 
 //#define FF_INVALID 0xFFFE
 
@@ -73,119 +78,838 @@ static uint32_t Gen;           // Generator of the multiplicative group
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+// Linear representation of rows
+//
+// For prime fields and for fields of characteristic 2, rows are stored in memory using the integer
+// representation of field elements (see ffToInt()) instead of logarithms. Field elements (FEL)
+// keep their logarithmic representation and are converted when they are inserted into or
+// extracted from a row. Data files still contain logarithms, see ffPackRow() and ffUnpackRow().
+//
+// For prime fields, rows contain residues 0,...,p-1, and row operations are plain integer
+// arithmetic modulo p, which can be vectorized:
+// - Addition is done in 32 bits with one conditional subtraction.
+// - Multiplication by a fixed c uses Shoup's method: with c' = ⌊c·2³²/p⌋, the quotient of x·c by
+//   p is approximated by (x·c')/2³², followed by one conditional subtraction.
+// - ffMapRow() accumulates products in 64-bit integers and reduces only once per column.
+//
+// For q=2ⁿ, the integer representation is the coefficient vector with respect to the polynomial
+// basis, so addition is XOR. Multiplication by a fixed c is a GF(2)-linear map, which is applied
+// with small tables instead of the 128 KB logarithm tables:
+// - The generic and AVX2 versions look up the images of the four nibbles of each element in
+//   16-entry tables ("split tables", PSHUFB on AVX2).
+// - With GFNI, the map is split into four 8×8 bit matrices, which are applied to 64 bytes at
+//   once with GF2P8AFFINEQB.
+// - ffMapRow() uses carry-less multiplication (PCLMULQDQ or VPCLMULQDQ). Unreduced products
+//   are accumulated with XOR and reduced modulo the defining polynomial once per column.
+//
+// The instruction set is selected at run time. The environment variable MTX_SIMD can be set to
+// "none", "sse4.1", "avx2", or "avx512" to limit the instruction set, e.g., for benchmarking.
+
+typedef void LinAddFunc(FEL* dest, const FEL* src, size_t n);
+typedef void LinMulAddFunc(FEL* dest, const FEL* src, uint32_t c, size_t n);
+typedef void LinAccFunc(uint64_t* acc, const FEL* src, uint32_t c, size_t n);
+
+// Multiplication by a fixed nonzero element c in characteristic 2.
+typedef struct {
+   uint16_t img[16];          // img[j] = c·xʲ
+   uint16_t nib[4][16];       // nib[k][a] = c·a·x⁴ᵏ for 0≤a<16
+} Char2Factor;
+
+// dest = c·src (add=0) or dest = dest + c·src (add=1)
+typedef void Char2MulFunc(FEL* dest, const FEL* src, const Char2Factor* c, size_t n, int add);
+
+// acc[k] = Σᵢ row[i]·matrix[i·step + k] for 0≤k<n≤LINEAR_CHUNK, without reduction
+typedef void Char2MapFunc(uint32_t* acc, const FEL* row, const FEL* matrix, size_t step, int nor,
+      size_t n);
+
+#define LINEAR_CHUNK 512
+
+static MTX_THREAD_LOCAL uint32_t char2Poly;        // xᴺ in the integer representation
+static MTX_THREAD_LOCAL uint16_t char2Red[4][16];  // char2Red[k][a] = a·xᴺ⁺⁴ᵏ for 0≤a<16
+
+/// @private
+/// Field context, see ffContext(). Contexts are created once per field and never change, so they
+/// can be shared by all threads.
+struct FfContext {
+   struct FfContext* next;
+   uint32_t p, q, n, gen;
+   int linearRows;
+   uint16_t minusone;
+   const uint16_t *inc;
+   const uint16_t *fromInt;
+   const uint16_t *toInt;
+   uint16_t subfieldsTable[17];
+   const uint16_t *embeddingTables;
+   int subfields[17];
+   uint32_t char2Poly;
+   uint16_t char2Red[4][16];
+};
+
+static struct {
+   const char* name;
+   LinAddFunc* add;           // dest = dest + src
+   LinMulAddFunc* mulAdd;     // dest = dest + c·src
+   LinAccFunc* acc;           // acc += c·src (no reduction)
+   Char2MulFunc* char2Mul;    // see Char2MulFunc
+   Char2MapFunc* char2Map;    // see Char2MapFunc, NULL if not available
+} linOps = { NULL, NULL, NULL, NULL, NULL, NULL };
+
+static inline uint32_t toLinear(FEL a)
+{
+   return a == FF_ZERO ? 0 : FfToIntTable[a];
+}
+
+static inline uint32_t shoupFactor(uint32_t c)
+{
+   return (uint32_t)(((uint64_t) c << 32) / P);
+}
+
+static inline uint32_t mulShoup(uint32_t x, uint32_t c, uint32_t cs, uint32_t p)
+{
+   const uint32_t q = (uint32_t)(((uint64_t) x * cs) >> 32);
+   const uint32_t t = x * c - q * p;
+   return t >= p ? t - p : t;
+}
+
+static inline void linAddBody(FEL* dest, const FEL* src, size_t n)
+{
+   const uint32_t p = P;
+   for (size_t i = 0; i < n; ++i) {
+      const uint32_t t = (uint32_t) dest[i] + src[i];
+      dest[i] = (FEL)(t >= p ? t - p : t);
+   }
+}
+
+static inline void linMulAddBody(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   const uint32_t p = P;
+   const uint32_t cs = shoupFactor(c);
+   for (size_t i = 0; i < n; ++i) {
+      const uint32_t t = mulShoup(src[i], c, cs, p) + dest[i];
+      dest[i] = (FEL)(t >= p ? t - p : t);
+   }
+}
+
+static inline void linAccBody(uint64_t* acc, const FEL* src, uint32_t c, size_t n)
+{
+   for (size_t i = 0; i < n; ++i) {
+      acc[i] += (uint32_t)(src[i] * c);
+   }
+}
+
+static void linAddScalar(FEL* dest, const FEL* src, size_t n)
+{
+   linAddBody(dest, src, n);
+}
+
+static void linMulAddScalar(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   linMulAddBody(dest, src, c, n);
+}
+
+static void linAccScalar(uint64_t* acc, const FEL* src, uint32_t c, size_t n)
+{
+   linAccBody(acc, src, c, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define MTX_HAVE_X86_SIMD
+
+__attribute__((target("sse4.1")))
+static void linAddSse(FEL* dest, const FEL* src, size_t n)
+{
+   linAddBody(dest, src, n);
+}
+
+__attribute__((target("sse4.1")))
+static void linMulAddSse(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   linMulAddBody(dest, src, c, n);
+}
+
+__attribute__((target("sse4.1")))
+static void linAccSse(uint64_t* acc, const FEL* src, uint32_t c, size_t n)
+{
+   linAccBody(acc, src, c, n);
+}
+
+__attribute__((target("avx2")))
+static void linAddAvx2(FEL* dest, const FEL* src, size_t n)
+{
+   linAddBody(dest, src, n);
+}
+
+__attribute__((target("avx2")))
+static void linMulAddAvx2(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   linMulAddBody(dest, src, c, n);
+}
+
+__attribute__((target("avx2")))
+static void linAccAvx2(uint64_t* acc, const FEL* src, uint32_t c, size_t n)
+{
+   linAccBody(acc, src, c, n);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void linAddAvx512(FEL* dest, const FEL* src, size_t n)
+{
+   linAddBody(dest, src, n);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void linMulAddAvx512(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   linMulAddBody(dest, src, c, n);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void linAccAvx512(uint64_t* acc, const FEL* src, uint32_t c, size_t n)
+{
+   linAccBody(acc, src, c, n);
+}
+
+#endif
+
+// Multiplies a by x in characteristic 2 (integer representation).
+
+static inline uint32_t char2MulX(uint32_t a)
+{
+   a <<= 1;
+   return (a >> N) ? a ^ (1U << N) ^ char2Poly : a;
+}
+
+// Initializes char2Poly and char2Red for a new field context.
+
+static void char2Init(struct FfContext* ctx)
+{
+   const uint32_t n = ctx->n;
+   ctx->char2Poly = (n == 1) ? 1 : ctx->toInt[(n * ctx->fromInt[2]) % (ctx->q - 1)];
+   uint32_t pow[16];
+   pow[0] = ctx->char2Poly;
+   for (int j = 1; j < 16; ++j) {
+      const uint32_t a = pow[j - 1] << 1;
+      pow[j] = (a >> n) ? a ^ (1U << n) ^ ctx->char2Poly : a;
+   }
+   for (int k = 0; k < 4; ++k) {
+      ctx->char2Red[k][0] = 0;
+      for (uint32_t a = 1; a < 16; ++a) {
+         ctx->char2Red[k][a] = ctx->char2Red[k][a & (a - 1)] ^ pow[4 * k + __builtin_ctz(a)];
+      }
+   }
+}
+
+// Reduces a product of two elements (degree < 2N) modulo the defining polynomial.
 
-static int loadEmbedAndRestrictTables(FILE *fd)
+static inline FEL char2Reduce(uint32_t a)
 {
-   uint16_t numberOfSubfields;
-   sysRead16(fd, &numberOfSubfields, 1);
-   MTX_ASSERT(numberOfSubfields <= 16);
-        
-   sysRead16(fd, subfieldsTable, numberOfSubfields);
-   subfieldsTable[numberOfSubfields] = 0;
+   const uint32_t h = a >> N;
+   return (FEL)((a & ((1U << N) - 1)) ^ char2Red[0][h & 15] ^ char2Red[1][(h >> 4) & 15]
+         ^ char2Red[2][(h >> 8) & 15] ^ char2Red[3][(h >> 12) & 15]);
+}
+
+// Carry-less product of a and b (b < 2¹⁶).
+
+static inline uint32_t clmul16(uint32_t a, uint32_t b)
+{
+   uint32_t r = 0;
+   for (; b != 0; b &= b - 1) {
+      r ^= a << __builtin_ctz(b);
+   }
+   return r;
+}
+
+// Prepares multiplication by c (c≠0, integer representation) in characteristic 2.
+
+static void char2Prepare(Char2Factor* f, uint32_t c)
+{
+   memset(f->img, 0, sizeof(f->img));
+   f->img[0] = (uint16_t) c;
+   for (uint32_t j = 1; j < N; ++j) {
+      f->img[j] = (uint16_t) char2MulX(f->img[j - 1]);
+   }
+   for (int k = 0; k < 4; ++k) {
+      f->nib[k][0] = 0;
+      for (uint32_t a = 1; a < 16; ++a) {
+         f->nib[k][a] = f->nib[k][a & (a - 1)] ^ f->img[4 * k + __builtin_ctz(a)];
+      }
+   }
+}
+
+static inline uint16_t char2MulOne(uint16_t x, const Char2Factor* f)
+{
+   return f->nib[0][x & 15] ^ f->nib[1][(x >> 4) & 15] ^ f->nib[2][(x >> 8) & 15]
+      ^ f->nib[3][x >> 12];
+}
+
+static void char2MulScalar(FEL* dest, const FEL* src, const Char2Factor* f, size_t n, int add)
+{
+   const uint16_t keep = add ? 0xFFFF : 0;
+   for (size_t i = 0; i < n; ++i) {
+      dest[i] = (dest[i] & keep) ^ char2MulOne(src[i], f);
+   }
+}
+
+#if defined(MTX_HAVE_X86_SIMD)
+
+#include <immintrin.h>
+
+__attribute__((target("sse4.1")))
+static void char2MulSse(FEL* dest, const FEL* src, const Char2Factor* f, size_t n, int add)
+{
+   // Split each nibble table into low and high bytes for PSHUFB, see char2MulAvx2().
+   __m128i lo[4], hi[4];
+   for (int k = 0; k < 4; ++k) {
+      uint8_t l[16], h[16];
+      for (int a = 0; a < 16; ++a) {
+         l[a] = (uint8_t) f->nib[k][a];
+         h[a] = (uint8_t)(f->nib[k][a] >> 8);
+      }
+      lo[k] = _mm_loadu_si128((const __m128i*) l);
+      hi[k] = _mm_loadu_si128((const __m128i*) h);
+   }
+   const __m128i mask = _mm_set1_epi16(0x0F);
+   const __m128i keep = _mm_set1_epi16(add ? -1 : 0);
+
+   size_t i = 0;
+   for (; i + 8 <= n; i += 8) {
+      const __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+      const __m128i n0 = _mm_and_si128(x, mask);
+      const __m128i n1 = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+      const __m128i n2 = _mm_and_si128(_mm_srli_epi16(x, 8), mask);
+      const __m128i n3 = _mm_srli_epi16(x, 12);
+      __m128i rl = _mm_xor_si128(_mm_shuffle_epi8(lo[0], n0), _mm_shuffle_epi8(lo[1], n1));
+      rl = _mm_xor_si128(rl, _mm_shuffle_epi8(lo[2], n2));
+      rl = _mm_xor_si128(rl, _mm_shuffle_epi8(lo[3], n3));
+      __m128i rh = _mm_xor_si128(_mm_shuffle_epi8(hi[0], n0), _mm_shuffle_epi8(hi[1], n1));
+      rh = _mm_xor_si128(rh, _mm_shuffle_epi8(hi[2], n2));
+      rh = _mm_xor_si128(rh, _mm_shuffle_epi8(hi[3], n3));
+      const __m128i r = _mm_xor_si128(rl, _mm_slli_epi16(rh, 8));
+      const __m128i d = _mm_and_si128(_mm_loadu_si128((const __m128i*)(dest + i)), keep);
+      _mm_storeu_si128((__m128i*)(dest + i), _mm_xor_si128(d, r));
+   }
+   char2MulScalar(dest + i, src + i, f, n - i, add);
+}
+
+__attribute__((target("avx2")))
+static void char2MulAvx2(FEL* dest, const FEL* src, const Char2Factor* f, size_t n, int add)
+{
+   // Split each nibble table into low and high bytes for PSHUFB (per 128-bit lane).
+   __m256i lo[4], hi[4];
+   for (int k = 0; k < 4; ++k) {
+      uint8_t l[16], h[16];
+      for (int a = 0; a < 16; ++a) {
+         l[a] = (uint8_t) f->nib[k][a];
+         h[a] = (uint8_t)(f->nib[k][a] >> 8);
+      }
+      lo[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) l));
+      hi[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) h));
+   }
+   const __m256i mask = _mm256_set1_epi16(0x0F);
+   const __m256i keep = _mm256_set1_epi16(add ? -1 : 0);
+
+   size_t i = 0;
+   for (; i + 16 <= n; i += 16) {
+      // The high byte of each index is 0, and nib[k][0] = 0, so the high byte of each lookup
+      // is 0.
+      const __m256i x = _mm256_loadu_si256((const __m256i*)(src + i));
+      const __m256i n0 = _mm256_and_si256(x, mask);
+      const __m256i n1 = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask);
+      const __m256i n2 = _mm256_and_si256(_mm256_srli_epi16(x, 8), mask);
+      const __m256i n3 = _mm256_srli_epi16(x, 12);
+      __m256i rl = _mm256_xor_si256(_mm256_shuffle_epi8(lo[0], n0), _mm256_shuffle_epi8(lo[1], n1));
+      rl = _mm256_xor_si256(rl, _mm256_shuffle_epi8(lo[2], n2));
+      rl = _mm256_xor_si256(rl, _mm256_shuffle_epi8(lo[3], n3));
+      __m256i rh = _mm256_xor_si256(_mm256_shuffle_epi8(hi[0], n0), _mm256_shuffle_epi8(hi[1], n1));
+      rh = _mm256_xor_si256(rh, _mm256_shuffle_epi8(hi[2], n2));
+      rh = _mm256_xor_si256(rh, _mm256_shuffle_epi8(hi[3], n3));
+      const __m256i r = _mm256_xor_si256(rl, _mm256_slli_epi16(rh, 8));
+      const __m256i d = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(dest + i)), keep);
+      _mm256_storeu_si256((__m256i*)(dest + i), _mm256_xor_si256(d, r));
+   }
+   char2MulScalar(dest + i, src + i, f, n - i, add);
+}
+
+// Returns the 8×8 block of the multiplication map with output byte «out» and input byte «in»,
+// in the format expected by GF2P8AFFINEQB: byte 7-i selects the input bits of output bit i.
+
+static uint64_t char2AffineMatrix(const Char2Factor* f, int out, int in)
+{
+   // Byte j of m is the image of input bit j. Transpose the 8×8 bit matrix, then reverse the
+   // byte order.
+   uint64_t m = 0;
+   for (int j = 0; j < 8; ++j) {
+      m |= (uint64_t)((f->img[8 * in + j] >> (8 * out)) & 0xFF) << (8 * j);
+   }
+   uint64_t t;
+   t = (m ^ (m >> 7)) & 0x00AA00AA00AA00AAULL;
+   m ^= t ^ (t << 7);
+   t = (m ^ (m >> 14)) & 0x0000CCCC0000CCCCULL;
+   m ^= t ^ (t << 14);
+   t = (m ^ (m >> 28)) & 0x00000000F0F0F0F0ULL;
+   m ^= t ^ (t << 28);
+   return __builtin_bswap64(m);
+}
+
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void char2MulGfni(FEL* dest, const FEL* src, const Char2Factor* f, size_t n, int add)
+{
+   const __m512i all = _mm512_set1_epi64((long long) char2AffineMatrix(f, 0, 0));
+   const __m512i alh = _mm512_set1_epi64((long long) char2AffineMatrix(f, 0, 1));
+   const __m512i ahl = _mm512_set1_epi64((long long) char2AffineMatrix(f, 1, 0));
+   const __m512i ahh = _mm512_set1_epi64((long long) char2AffineMatrix(f, 1, 1));
+   const __mmask64 highBytes = 0xAAAAAAAAAAAAAAAAULL;
+   const __m512i keep = _mm512_set1_epi16(add ? -1 : 0);
+
+   size_t i = 0;
+   for (; i + 32 <= n; i += 32) {
+      const __m512i x = _mm512_loadu_si512((const void*)(src + i));
+      const __m512i xs = _mm512_or_si512(_mm512_slli_epi16(x, 8), _mm512_srli_epi16(x, 8));
+      const __m512i rl = _mm512_xor_si512(_mm512_gf2p8affine_epi64_epi8(x, all, 0),
+            _mm512_gf2p8affine_epi64_epi8(xs, alh, 0));
+      const __m512i rh = _mm512_xor_si512(_mm512_gf2p8affine_epi64_epi8(xs, ahl, 0),
+            _mm512_gf2p8affine_epi64_epi8(x, ahh, 0));
+      const __m512i r = _mm512_mask_blend_epi8(highBytes, rl, rh);
+      const __m512i d = _mm512_and_si512(_mm512_loadu_si512((const void*)(dest + i)), keep);
+      _mm512_storeu_si512((void*)(dest + i), _mm512_xor_si512(d, r));
+   }
+   char2MulScalar(dest + i, src + i, f, n - i, add);
+}
+
+// The Char2MapFunc implementations split each 64-bit word of a matrix row into the even and odd
+// elements, so each carry-less product of a 64-bit word with row[i] contains two 31-bit products
+// at offsets 0 and 32. «even» and «odd» receive these 32-bit sums in the order of the words.
+
+static void char2Unpack(uint32_t* acc, const uint32_t* even, const uint32_t* odd, size_t n)
+{
+   for (size_t k = 0; k < n; ++k) {
+      const size_t i = (k / 4) * 2 + (k & 2) / 2;
+      acc[k] = (k & 1) ? odd[i] : even[i];
+   }
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static void char2MapPclmul(uint32_t* acc, const FEL* row, const FEL* matrix, size_t step, int nor,
+      size_t n)
+{
+   __m128i v[LINEAR_CHUNK / 4];
+   const size_t nv = n / 8;
+   uint32_t tail[8] = {0};
+   for (size_t k = 0; k < 2 * nv; ++k) {
+      v[k] = _mm_setzero_si128();
+   }
+   const __m128i mask = _mm_set1_epi64x(0x0000FFFF0000FFFFLL);
+
+   for (int i = 0; i < nor; ++i) {
+      const uint32_t c = row[i];
+      if (c == 0) {
+         continue;
+      }
+      const __m128i cv = _mm_cvtsi32_si128((int) c);
+      const FEL* m = matrix + i * step;
+      for (size_t k = 0; k < nv; ++k) {
+         const __m128i x = _mm_loadu_si128((const __m128i*)(m + 8 * k));
+         const __m128i e = _mm_and_si128(x, mask);
+         const __m128i o = _mm_and_si128(_mm_srli_epi64(x, 16), mask);
+         v[2 * k] = _mm_xor_si128(v[2 * k], _mm_unpacklo_epi64(
+                  _mm_clmulepi64_si128(e, cv, 0x00), _mm_clmulepi64_si128(e, cv, 0x01)));
+         v[2 * k + 1] = _mm_xor_si128(v[2 * k + 1], _mm_unpacklo_epi64(
+                  _mm_clmulepi64_si128(o, cv, 0x00), _mm_clmulepi64_si128(o, cv, 0x01)));
+      }
+      for (size_t k = 8 * nv; k < n; ++k) {
+         tail[k - 8 * nv] ^= clmul16(c, m[k]);
+      }
+   }
+
+   uint32_t even[LINEAR_CHUNK / 2], odd[LINEAR_CHUNK / 2];
+   for (size_t k = 0; k < nv; ++k) {
+      _mm_storeu_si128((__m128i*)(even + 4 * k), v[2 * k]);
+      _mm_storeu_si128((__m128i*)(odd + 4 * k), v[2 * k + 1]);
+   }
+   char2Unpack(acc, even, odd, 8 * nv);
+   memcpy(acc + 8 * nv, tail, (n - 8 * nv) * sizeof(uint32_t));
+}
+
+__attribute__((target("avx512f,avx512bw,vpclmulqdq")))
+static void char2MapVpclmul(uint32_t* acc, const FEL* row, const FEL* matrix, size_t step,
+      int nor, size_t n)
+{
+   __m512i v[LINEAR_CHUNK / 16];
+   const size_t nv = (n + 31) / 32;
+   const __mmask32 lastMask = (n % 32 == 0) ? 0xFFFFFFFF : (1U << (n % 32)) - 1;
+   for (size_t k = 0; k < 2 * nv; ++k) {
+      v[k] = _mm512_setzero_si512();
+   }
+   const __m512i mask = _mm512_set1_epi64(0x0000FFFF0000FFFFLL);
+
+   for (int i = 0; i < nor; ++i) {
+      if (row[i] == 0) {
+         continue;
+      }
+      const __m512i cv = _mm512_set1_epi64(row[i]);
+      const FEL* m = matrix + i * step;
+      for (size_t k = 0; k < nv; ++k) {
+         // The last block is loaded with a mask, so we do not read beyond the end of the row.
+         const __m512i x = _mm512_maskz_loadu_epi16(k + 1 < nv ? 0xFFFFFFFF : lastMask,
+               m + 32 * k);
+         const __m512i e = _mm512_and_si512(x, mask);
+         const __m512i o = _mm512_and_si512(_mm512_srli_epi64(x, 16), mask);
+         v[2 * k] = _mm512_xor_si512(v[2 * k], _mm512_unpacklo_epi64(
+                  _mm512_clmulepi64_epi128(e, cv, 0x00), _mm512_clmulepi64_epi128(e, cv, 0x01)));
+         v[2 * k + 1] = _mm512_xor_si512(v[2 * k + 1], _mm512_unpacklo_epi64(
+                  _mm512_clmulepi64_epi128(o, cv, 0x00), _mm512_clmulepi64_epi128(o, cv, 0x01)));
+      }
+   }
+
+   uint32_t even[LINEAR_CHUNK / 2], odd[LINEAR_CHUNK / 2];
+   for (size_t k = 0; k < nv; ++k) {
+      _mm512_storeu_si512((void*)(even + 16 * k), v[2 * k]);
+      _mm512_storeu_si512((void*)(odd + 16 * k), v[2 * k + 1]);
+   }
+   char2Unpack(acc, even, odd, n);
+}
+
+#endif
+
+// Selects the row operations for the current CPU. Called once, or by ffSelectSimd().
+
+static void selectLinOps()
+{
+   const char* limit = getenv("MTX_SIMD");
+   if (limit == NULL) {
+      limit = "";
+   }
+   linOps.name = "none";
+   linOps.add = linAddScalar;
+   linOps.mulAdd = linMulAddScalar;
+   linOps.acc = linAccScalar;
+   linOps.char2Mul = char2MulScalar;
+   linOps.char2Map = NULL;
+   if (!strcmp(limit, "none")) {
+      return;
+   }
+#if defined(MTX_HAVE_X86_SIMD)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512bw") && strcmp(limit, "avx2") && strcmp(limit, "sse4.1")) {
+      linOps.name = "avx512";
+      linOps.add = linAddAvx512;
+      linOps.mulAdd = linMulAddAvx512;
+      linOps.acc = linAccAvx512;
+      linOps.char2Mul = __builtin_cpu_supports("gfni") ? char2MulGfni : char2MulAvx2;
+      if (__builtin_cpu_supports("vpclmulqdq")) {
+         linOps.char2Map = char2MapVpclmul;
+      }
+   } else if (__builtin_cpu_supports("avx2") && strcmp(limit, "sse4.1")) {
+      linOps.name = "avx2";
+      linOps.add = linAddAvx2;
+      linOps.mulAdd = linMulAddAvx2;
+      linOps.acc = linAccAvx2;
+      linOps.char2Mul = char2MulAvx2;
+   } else if (__builtin_cpu_supports("sse4.1")) {
+      linOps.name = "sse4.1";
+      linOps.add = linAddSse;
+      linOps.mulAdd = linMulAddSse;
+      linOps.acc = linAccSse;
+      linOps.char2Mul = char2MulSse;
+   }
+   if (linOps.char2Map == NULL && __builtin_cpu_supports("pclmul")) {
+      linOps.char2Map = char2MapPclmul;
+   }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Selects the SIMD row operations again.
+/// The row operations are normally selected once, when the first field is set up. This function
+/// repeats the selection, taking into account the current value of the MTX_SIMD environment
+/// variable. It is intended for tests and benchmarks and must not be called while other threads
+/// are using the kernel.
+/// @return The name of the selected instruction set ("none", "sse4.1", "avx2", or "avx512").
+
+const char* ffSelectSimd()
+{
+   selectLinOps();
+   return linOps.name;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// dest = dest + src (linear rows)
+
+static void linAdd(FEL* dest, const FEL* src, size_t n)
+{
+   if (P == 2) {
+      for (size_t i = 0; i < n; ++i) {
+         dest[i] ^= src[i];
+      }
+   } else {
+      linOps.add(dest, src, n);
+   }
+}
+
+// dest = dest + c·src (linear rows, c≠0 in integer representation)
+
+static void linMulAdd(FEL* dest, const FEL* src, uint32_t c, size_t n)
+{
+   if (P == 2) {
+      Char2Factor f;
+      char2Prepare(&f, c);
+      linOps.char2Mul(dest, src, &f, n, 1);
+   } else {
+      linOps.mulAdd(dest, src, c, n);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Sets up the subfield tables of a new field context. «t» points to the number of subfields, «end»
+// to the end of the table file.
+
+static void loadEmbedAndRestrictTables(
+      struct FfContext* ctx, const uint16_t* t, const uint16_t* end)
+{
+   const uint16_t numberOfSubfields = *t++;
+   if (numberOfSubfields > 16 || t + numberOfSubfields > end) {
+      mtxAbort(MTX_HERE,"Corrupt table file (number of subfields)");
+   }
+   memcpy(ctx->subfieldsTable, t, numberOfSubfields * sizeof(uint16_t));
+   t += numberOfSubfields;
+   ctx->subfieldsTable[numberOfSubfields] = 0;
    size_t tblSize = 0;
-   for (FEL* sf = subfieldsTable; *sf != 0; ++sf) {
-      if (*sf >= Q) {
+   for (const FEL* sf = ctx->subfieldsTable; *sf != 0; ++sf) {
+      if (*sf >= ctx->q) {
          mtxAbort(MTX_HERE,"Corrupt table file (subfield order)");
       }
-      tblSize += *sf + Q;
+      tblSize += *sf + ctx->q;
    }
-   embeddingTables = NREALLOC(embeddingTables, FEL, tblSize);
-   if (fread(embeddingTables, sizeof(FEL), tblSize, fd) != tblSize) {
+   if (t + tblSize > end) {
       mtxAbort(MTX_HERE,"Corrupt table file (subfield embeddings)");
-      return -1;
    }
+   ctx->embeddingTables = t;
 
    // Copy subfields to public table
-   subfieldsTable[numberOfSubfields] = 0;
-   memset(mtx_subfields, 0, sizeof(mtx_subfields));
-   for (int i = 0; i < numberOfSubfields && subfieldsTable[i] != 0; ++i) {
-      mtx_subfields[i] = (int) subfieldsTable[i];
+   for (int i = 0; i < numberOfSubfields && ctx->subfieldsTable[i] != 0; ++i) {
+      ctx->subfields[i] = (int) ctx->subfieldsTable[i];
    }
+}
 
-   return 0;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t le32(const uint8_t* p)
+{
+   return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+      | ((uint32_t) p[3] << 24);
+}
+
+// Returns the tables (everything after the header) in host byte order. The table file uses
+// little-endian format, so on big-endian hosts a converted copy is made, which is kept for later
+// use like the mapping itself.
+
+static const uint16_t* hostOrderTables(const uint8_t* data, size_t size)
+{
+   static struct Converted {
+      const uint8_t* data;
+      uint16_t* tables;
+      struct Converted* next;
+   } *converted = NULL;
+
+   if (!mtxIsBigEndian()) {
+      return (const uint16_t*)(data + 20);
+   }
+   for (struct Converted* c = converted; c != NULL; c = c->next) {
+      if (c->data == data) {
+         return c->tables;
+      }
+   }
+   const size_t n = (size - 20) / 2;
+   struct Converted* c = ALLOC(struct Converted);
+   c->data = data;
+   c->tables = NALLOC(uint16_t, n);
+   for (size_t i = 0; i < n; ++i) {
+      c->tables[i] = (uint16_t)(data[20 + 2 * i] | (data[21 + 2 * i] << 8));
+   }
+   c->next = converted;
+   converted = c;
+   return c->tables;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Tries loading the tables from "pXXXXX.zzz".
+// Tries loading the tables from "pXXXXX.zzz" into a new field context.
 // Returns 1 on success or 0 if the file does not exist. If the file exists but cannot be opened
 // or contains invalid data, the function raises an error, see @ref MtxError.
-static int LoadTables_(int fieldOrder, const char* fileName)
+// The table file is mapped into memory (see sysMapFile()) and the tables are used in place, so
+// they are shared with other processes.
+
+static int LoadTables_(struct FfContext* ctx, int fieldOrder, const char* fileName)
 {
-   FILE* fd = sysFopen(fileName,"rb::lib:noerror");
-   if (fd == NULL)
+   size_t size;
+   const uint8_t* data = (const uint8_t*) sysMapFile(fileName, "rb::lib:noerror", &size);
+   if (data == NULL)
       return 0;
 
    // read header
+   if (size < 5 * 4 + 2 * 2) {
+      mtxAbort(MTX_HERE,"ERROR IN TABLE FILE HEADER");
+   }
    uint32_t info[5];
-   sysRead32(fd, info, 5);
+   for (int i = 0; i < 5; ++i) {
+      info[i] = le32(data + 4 * i);
+   }
 
-   P = info[1];
-   Q = info[2];
-   N = info[3];
-   Gen = info[4];
-   Q1 = Q - 1;
-   ffOrder = (long) Q;
-   ffChar = (long) P;
-   ffGen = (Q == 2) ? 0 : 1;
+   ctx->p = info[1];
+   ctx->q = info[2];
+   ctx->n = info[3];
+   ctx->gen = info[4];
 
    if (info[0] != MTX_ZZZVERSION) {
       mtxAbort(MTX_HERE,"Invalid table file: wrong version %d (expected %d)", info[0], MTX_ZZZVERSION);
    }
 
-   if ((Q != fieldOrder) || (Q < 2) || (P < 2)
-         || (P > Q) || (Q % P != 0)) {
+   const uint32_t p = ctx->p;
+   const uint32_t q = ctx->q;
+   if ((q != fieldOrder) || (q < 2) || (p < 2)
+         || (p > q) || (q % p != 0) || (size < 20 + 2 * (3 * (size_t) q + 1))) {
       mtxAbort(MTX_HERE,"ERROR IN TABLE FILE HEADER");
    }
 
+   // Set up tables
+   const uint16_t* t = hostOrderTables(data, size);
+   const uint16_t* const end = t + (size - 20) / 2;
+   ctx->minusone = *t++;
+   ctx->inc = t;
+   t += q - 1;
+   ctx->toInt = t;
+   t += q;
+   ctx->fromInt = t;
+   t += q;
+   loadEmbedAndRestrictTables(ctx, t, end);
+
+   ctx->linearRows = (ctx->n == 1 || p == 2);
+   if (ctx->linearRows && linOps.name == NULL) {
+      selectLinOps();
+      MTX_LOGD("Using %s row operations for linear rows", linOps.name);
+   }
+   if (ctx->linearRows && p == 2) {
+      char2Init(ctx);
+   }
 
-   // Read tables
-   sysRead16(fd, &minusone, 1);
-   inc = NREALLOC(inc, FEL, Q - 1);
-   sysRead16(fd, inc, Q - 1);
-   FfToIntTable = NREALLOC(FfToIntTable, uint16_t, Q);
-   sysRead16(fd, FfToIntTable,Q);
-   FfFromIntTable = NREALLOC(FfFromIntTable, uint16_t, Q);
-   sysRead16(fd, FfFromIntTable,Q);
-   loadEmbedAndRestrictTables(fd);
-
-   fclose(fd);
    return 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static int LoadTables(int fieldOrder)
+static int LoadTables(struct FfContext* ctx, int fieldOrder)
 {
-   static char fileName[50];
+   char fileName[50];
    snprintf(fileName, sizeof(fileName), "p%5.5d.zzz", fieldOrder);
    const int context = mtxBegin(MTX_HERE, "Loading arithmetic tables: %s", fileName);
-   int rc = LoadTables_(fieldOrder, fileName);
+   int rc = LoadTables_(ctx, fieldOrder, fileName);
    mtxEnd(context);
    return rc;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Field contexts
+
+static struct FfContext* contexts = NULL;      // all loaded fields
+#if defined(MTX_DEFAULT_THREADS)
+static pthread_mutex_t contextsMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+static MTX_THREAD_LOCAL const struct FfContext* currentContext = NULL;
+
+/// Returns the field context for GF(@em field).
+/// See the standard kernel for details.
+
+const FfContext_t* ffContext(int field)
+{
+   MTX_ASSERT(sizeof(FEL) == 2);
+   MTX_ASSERT(sizeof(unsigned int) >= 4);
+   if (field < 2) {
+      mtxAbort(MTX_HERE, "Invalid field order %d", field);
+   }
+
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_lock(&contextsMutex);
+#endif
+   struct FfContext* ctx = contexts;
+   while (ctx != NULL && ctx->q != (uint32_t) field) {
+      ctx = ctx->next;
+   }
+   if (ctx == NULL) {
+      ctx = ALLOC(struct FfContext);
+      memset(ctx, 0, sizeof(*ctx));
+      if (!LoadTables(ctx, field)) {
+         ffMakeTables(field);
+         if (!LoadTables(ctx, field)) {
+            mtxAbort(MTX_HERE,"COULD NOT LOAD ARITHMETIC TABLE FILE");
+         }
+      }
+      ctx->next = contexts;
+      contexts = ctx;
+   }
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_unlock(&contextsMutex);
+#endif
+   return ctx;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Returns the current field context of the calling thread, or NULL if no field was selected.
+
+const FfContext_t* ffCurrentContext()
+{
+   return currentContext;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Makes a field context the current field of the calling thread.
+/// See the standard kernel for details.
+
+void ffBindContext(const FfContext_t* ctx)
+{
+   MTX_ASSERT(ctx != NULL);
+   if (ctx == currentContext) {
+      return;
+   }
+   P = ctx->p;
+   Q = ctx->q;
+   Q1 = ctx->q - 1;
+   N = ctx->n;
+   Gen = ctx->gen;
+   mtx_linearRows = ctx->linearRows;
+   minusone = ctx->minusone;
+   inc = ctx->inc;
+   FfFromIntTable = ctx->fromInt;
+   FfToIntTable = ctx->toInt;
+   memcpy(subfieldsTable, ctx->subfieldsTable, sizeof(subfieldsTable));
+   embeddingTables = ctx->embeddingTables;
+   memcpy(mtx_subfields, ctx->subfields, sizeof(mtx_subfields));
+   char2Poly = ctx->char2Poly;
+   memcpy(char2Red, ctx->char2Red, sizeof(char2Red));
+   ffOrder = ctx->q;
+   ffChar = ctx->p;
+   ffGen = (ctx->q == 2) ? 0 : 1;
+   currentContext = ctx;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Sets the field order.
 /// This function sets the current field to GF(@em field) and initializes the field arithmetic.
 /// Most kernel functions require that a field has been selected before they are used.
+/// The current field is a per-thread setting, see ffContext() and ffBindContext().
 /// @param field Field order.
-/// @return 0 on success, -1 otherwise.
 
 void ffSetField(int field)
 {
-   MTX_ASSERT(sizeof(FEL) == 2);
-   MTX_ASSERT(sizeof(unsigned int) >= 4);
-
    if ((field == ffOrder) || (field < 2)) {
       return;
    }
-   if (!LoadTables(field)) {
-      ffMakeTables(field);
-      if (!LoadTables(field)) {
-         mtxAbort(MTX_HERE,"COULD NOT LOAD ARITHMETIC TABLE FILE");
-      }
-   }
+   ffBindContext(ffContext(field));
 }
 
 
@@ -326,6 +1050,66 @@ size_t ffRowSizeUsed(int noc)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Converts a row to the file format.
+/// Data files contain field elements in their logarithmic representation. This function stores
+/// the first @p noc elements of @p row in this format into @p buf, which must have room for
+/// ffRowSizeUsed(noc) bytes.
+
+void ffPackRow(uint8_t* buf, PTR row, uint32_t noc)
+{
+   if (mtx_linearRows) {
+      FEL* out = (FEL*) buf;
+      for (uint32_t i = 0; i < noc; ++i) {
+         out[i] = FfFromIntTable[row[i]];
+      }
+   } else {
+      memcpy(buf, row, ffRowSizeUsed(noc));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Converts a row from the file format.
+/// This is the inverse of ffPackRow(). The whole row, including padding, is overwritten.
+
+void ffUnpackRow(PTR row, const uint8_t* buf, uint32_t noc)
+{
+   ffMulRow(row, FF_ZERO, noc);
+   if (mtx_linearRows) {
+      const FEL* in = (const FEL*) buf;
+      for (uint32_t i = 0; i < noc; ++i) {
+         CHECKFEL(in[i]);
+         row[i] = (FEL) toLinear(in[i]);
+      }
+   } else {
+      memcpy(row, buf, ffRowSizeUsed(noc));
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Insert a mark into a row.
+/// See the standard kernel for details. For prime fields, the mark is converted to the linear
+/// representation used in rows.
+
+void ffInsert(PTR row, int col, FEL mark)
+{
+   CHECKFEL(mark);
+   row[col] = mtx_linearRows ? (FEL) toLinear(mark) : mark;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Extract a mark from a row.
+/// See the standard kernel for details.
+
+FEL ffExtract(PTR row, int col)
+{
+   return mtx_linearRows ? FfFromIntTable[row[col]] : row[col];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 // Organization of subfield embedding/restriction tables:
 // 
 // uint16_t subfields[] contains the list of subfields. The list is terminated by 0. Note that we do
@@ -340,11 +1124,11 @@ size_t ffRowSizeUsed(int noc)
 
 // Returns a pointer to the combined embed/restrict table for F(r)<F(q).
 // The table has size r + q.
-static FEL* getEmbeddingTable(uint16_t r)
+static const FEL* getEmbeddingTable(uint16_t r)
 {
    // Look up the subfield for every call, assuming ffEmbed() performance is not critical.
    FEL* sptr = subfieldsTable;
-   FEL* tptr = embeddingTables;
+   const FEL* tptr = embeddingTables;
    while (*sptr != r) {
       if (*sptr == 0xFFFF) {
          mtxAbort(MTX_HERE,"Bad subfield. Cannot embed F(%d) into F(%d).", r, Q);
@@ -368,7 +1152,7 @@ FEL ffRestrict(FEL a, int subfield)
    if (a == FF_ONE) {return FF_ONE;}
    CHECKFEL(a);
 
-   FEL* table = getEmbeddingTable(subfield);
+   const FEL* table = getEmbeddingTable(subfield);
    FEL result = table[subfield + a];
    if (result == FF_ZERO) {
       mtxAbort(MTX_HERE,"%s(): Element %u is not in subfield F(%u).", __func__, a, subfield);
@@ -387,7 +1171,7 @@ FEL ffEmbed(FEL a, int subfield)
       mtxAbort(MTX_HERE,"FfEmbed: subfield element 0x%x not in F(%u)", a, subfield);
       return FF_ZERO;
    }
-   FEL* table = getEmbeddingTable(subfield);
+   const FEL* table = getEmbeddingTable(subfield);
    return table ? table[a] : FF_ZERO;
 }
 
@@ -397,11 +1181,12 @@ uint32_t ffFindPivot(PTR row, FEL* mark, int noc)
 {
    register long i;
    register PTR p = row;
+   const FEL zero = mtx_linearRows ? 0 : FF_ZERO;
 
    for (i = 0; i < noc; ++i, ++p) {
-      if (*p != FF_ZERO) {
+      if (*p != zero) {
          if (mark != NULL) {
-            *mark = *p;
+            *mark = mtx_linearRows ? FfFromIntTable[*p] : *p;
          }
          return i;
       }
@@ -413,6 +1198,10 @@ uint32_t ffFindPivot(PTR row, FEL* mark, int noc)
 
 PTR ffAddRow(PTR dest, PTR src, uint32_t noc)
 {
+   if (mtx_linearRows) {
+      linAdd(dest, src, noc);
+      return dest;
+   }
    FEL *p1 = dest;
    FEL *p2 = src;
 
@@ -429,6 +1218,10 @@ void ffAddRowPartial(PTR dest, PTR src, uint32_t first, uint32_t noc)
 {
    MTX_ASSERT(first >= 0 && first < noc);
 
+   if (mtx_linearRows) {
+      linAdd(dest + first, src + first, noc - first);
+      return;
+   }
    PTR p1 = dest + first;
    PTR p2 = src + first;
    for (uint32_t i = noc - first; i != 0; --i) {
@@ -446,6 +1239,22 @@ void ffMulRow(PTR row, FEL mark, int noc)
    register long i;
 
    CHECKFEL(mark);
+   if (mtx_linearRows) {
+      if (mark == FF_ZERO) {
+         memset(row, 0, ffRowSize(noc));
+      } else if (mark != FF_ONE && P == 2) {
+         Char2Factor f;
+         char2Prepare(&f, toLinear(mark));
+         linOps.char2Mul(row, row, &f, noc, 0);
+      } else if (mark != FF_ONE) {
+         const uint32_t c = toLinear(mark);
+         const uint32_t cs = shoupFactor(c);
+         for (i = 0; i < noc; ++i) {
+            row[i] = (FEL) mulShoup(row[i], c, cs, P);
+         }
+      }
+      return;
+   }
    if (mark == FF_ZERO) {
       m = row;
       for (i = noc; i != 0; --i) {
@@ -477,6 +1286,9 @@ void ffAddMulRow(PTR row1, PTR row2, FEL f, uint32_t noc)
       ffAddRow(row1, row2, noc);
       return;
    }
+   else if (f != FF_ZERO && mtx_linearRows) {
+      linMulAdd(row1, row2, toLinear(f), noc);
+   }
    else if (f != FF_ZERO) {
       FEL* p1 = row1;
       FEL* p2 = row2;
@@ -499,6 +1311,9 @@ void ffAddMulRowPartial(PTR dest, PTR src, FEL f, uint32_t firstcol, uint32_t no
       ffAddRowPartial(dest, src, firstcol, noc);
       return;
    }
+   else if (f != FF_ZERO && mtx_linearRows) {
+      linMulAdd(dest + firstcol, src + firstcol, toLinear(f), noc - firstcol);
+   }
    else if (f != FF_ZERO) {
       PTR p1 = dest + firstcol;
       PTR p2 = src + firstcol;
@@ -531,9 +1346,64 @@ int ffToInt(FEL f)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// ffMapRow() for linear rows. In characteristic 2, products are accumulated without reduction
+// by linOps.char2Map, or the rows of the matrix are added with linMulAdd() if carry-less
+// multiplication is not available. For prime fields, products are accumulated in 64-bit integers, which cannot overflow
+// for less than 2³¹ rows, and reduced at the end. Columns are processed in chunks, so the
+// accumulator stays in the L1 cache.
+
+static void mapRowLinear(PTR result, PTR row, PTR matrix, int nor, int noc)
+{
+   const size_t step = ffRowSize(noc) / sizeof(FEL);
+   if (P == 2 && linOps.char2Map != NULL) {
+      uint32_t acc[LINEAR_CHUNK];
+      for (int c0 = 0; c0 < noc; c0 += LINEAR_CHUNK) {
+         const size_t n = (noc - c0 < LINEAR_CHUNK) ? (size_t)(noc - c0) : LINEAR_CHUNK;
+         linOps.char2Map(acc, row, matrix + c0, step, nor, n);
+         for (size_t k = 0; k < n; ++k) {
+            result[c0 + k] = char2Reduce(acc[k]);
+         }
+      }
+      return;
+   }
+   if (P == 2) {
+      const FEL* m = matrix;
+      for (int i = 0; i < nor; ++i, m += step) {
+         if (row[i] == 1) {
+            linAdd(result, m, noc);
+         } else if (row[i] != 0) {
+            linMulAdd(result, m, row[i], noc);
+         }
+      }
+      return;
+   }
+
+   uint64_t acc[LINEAR_CHUNK];
+
+   for (int c0 = 0; c0 < noc; c0 += LINEAR_CHUNK) {
+      const size_t n = (noc - c0 < LINEAR_CHUNK) ? (size_t)(noc - c0) : LINEAR_CHUNK;
+      memset(acc, 0, n * sizeof(acc[0]));
+      const FEL* m = matrix + c0;
+      for (int i = 0; i < nor; ++i, m += step) {
+         if (row[i] != 0) {
+            linOps.acc(acc, m, row[i], n);
+         }
+      }
+      for (size_t k = 0; k < n; ++k) {
+         result[c0 + k] = (FEL)(acc[k] % P);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void ffMapRow(PTR result, PTR row, PTR matrix, int nor, int noc)
 {
    ffMulRow(result, FF_ZERO, noc);
+   if (mtx_linearRows) {
+      mapRowLinear(result, row, matrix, nor, noc);
+      return;
+   }
 
    FEL *brow = row;
    FEL *m = matrix;
@@ -570,6 +1440,22 @@ FEL ffScalarProduct(PTR a, PTR b, int noc)
    FEL *ap = a;
    FEL *bp = b;
    FEL f = FF_ZERO;
+   if (mtx_linearRows && P == 2) {
+      uint32_t sum = 0;
+      for (int i = 0; i < noc; ++i) {
+         if (ap[i] != 0 && bp[i] != 0) {
+            sum ^= FfToIntTable[(FfFromIntTable[ap[i]] + FfFromIntTable[bp[i]]) % Q1];
+         }
+      }
+      return FfFromIntTable[sum];
+   }
+   if (mtx_linearRows) {
+      uint64_t sum = 0;
+      for (int i = 0; i < noc; ++i) {
+         sum += (uint32_t) ap[i] * bp[i];
+      }
+      return FfFromIntTable[sum % P];
+   }
    for (int i = noc; i > 0; --i) {
       f = ffAdd(f,ffMul(*ap++,*bp++));
    }
@@ -0,0 +1,587 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// C MeatAxe - Finite field arithmetic and common functions
+// This is the "bit-sliced" version for GF(2), GF(3), GF(4), GF(8), and GF(16).
+//
+// This program is free software; see the file COPYING for details.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "meataxe.h"
+
+// The bit-sliced kernel supports the fields GF(2), GF(3), GF(4), GF(8), and GF(16).
+//
+// Field elements are numbered as in the standard kernel (see kernel-0.c), and the same arithmetic
+// tables are used for operations on single field elements. Only the memory layout of rows is
+// different. A row is divided into units of 64 columns, and each unit is stored as NP 64-bit
+// words ("planes"). Bit i of each plane in unit u belongs to column 64u+i.
+// For GF(2ⁿ), plane k holds bit k of the element number, i.e., the coefficient of xᵏ in the
+// polynomial representing the element. For GF(3), plane 0 marks the elements equal to 1, and
+// plane 1 marks the elements equal to 2. In both cases, the planes of a single column, read as a
+// binary number, give the element number.
+//
+// With this layout, row operations process 64 columns with a few word operations:
+// - In characteristic 2, addition is a bitwise XOR, and multiplication by a fixed field element
+//   is a linear map of the planes (see planeMap).
+// - In GF(3), addition is a short boolean formula, and multiplication by 2 swaps the planes.
+//
+// Data files use the same format as the standard kernel. Rows are converted when they are read or
+// written, see ffPackRow() and ffUnpackRow().
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Gobal data
+
+typedef uint64_t WORD;
+#define UNIT_COLS 64            // columns per unit
+
+// The following variables describe the current field. They are per-thread copies of the current
+// field context, see ffBindContext().
+
+static MTX_THREAD_LOCAL int MPB = 0;             // No. of marks per byte in the file format
+static MTX_THREAD_LOCAL int NP = 0;              // No. of planes per unit
+
+// planeMap[f][j] is the set of planes k (as bit mask) for which f·xᵏ has a nonzero coefficient
+// at xʲ. Plane j of f·a is the XOR of these planes of a. Used in characteristic 2 only.
+static MTX_THREAD_LOCAL uint8_t planeMap[16][4];
+
+/// @private
+/// Row layout of a field, see ffCreateRowLayout().
+struct RowLayout {
+   int mpb;
+   int np;
+   uint8_t planeMap[16][4];
+};
+
+static int isFel(FEL x) { return (unsigned int) x < (unsigned int) ffOrder; }
+
+#if defined(__GNUC__)
+#define lowestBit(x) __builtin_ctzll(x)
+#define popCount(x) __builtin_popcountll(x)
+#else
+static int lowestBit(WORD x)
+{
+   int n = 0;
+   for (; (x & 1) == 0; x >>= 1) {
+      ++n;
+   }
+   return n;
+}
+
+static int popCount(WORD x)
+{
+   int n = 0;
+   for (; x != 0; x &= x - 1) {
+      ++n;
+   }
+   return n;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Creates the plane layout for a new field context. Called by ffContext().
+
+const void* ffCreateRowLayout(uint32_t order, int characteristic, int mpb,
+                              const FEL (*tmult)[256])
+{
+   struct RowLayout* layout = ALLOC(struct RowLayout);
+   memset(layout, 0, sizeof(*layout));
+   layout->mpb = mpb;
+   while ((1U << layout->np) < order) {
+      ++layout->np;
+   }
+   if (characteristic == 2) {
+      for (uint32_t f = 0; f < order; ++f) {
+         for (int k = 0; k < layout->np; ++k) {
+            const FEL p = tmult[f][1 << k];
+            for (int j = 0; j < layout->np; ++j) {
+               if ((p >> j) & 1) {
+                  layout->planeMap[f][j] |= (uint8_t)(1 << k);
+               }
+            }
+         }
+      }
+   }
+   return layout;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Makes a plane layout current for the calling thread. Called by ffBindContext().
+
+void ffBindRowLayout(const void* rowLayout)
+{
+   const struct RowLayout* layout = (const struct RowLayout*) rowLayout;
+   MPB = layout->mpb;
+   NP = layout->np;
+   memcpy(planeMap, layout->planeMap, sizeof(planeMap));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Units per row.
+static size_t upr(uint32_t noc)
+{
+   return (noc + UNIT_COLS - 1) / UNIT_COLS;
+}
+
+// Returns the field element in column «bit» of a unit.
+static inline FEL getElement(const WORD* unit, int bit)
+{
+   FEL f = 0;
+   for (int k = 0; k < NP; ++k) {
+      f |= (FEL)(((unit[k] >> bit) & 1) << k);
+   }
+   return f;
+}
+
+// Returns the XOR of the planes selected by «mask».
+static inline WORD combinePlanes(const WORD* unit, int mask)
+{
+   WORD r = 0;
+   for (int k = 0; mask != 0; ++k, mask >>= 1) {
+      if (mask & 1) {
+         r ^= unit[k];
+      }
+   }
+   return r;
+}
+
+// GF(3) addition of one unit: (x0,x1) += (y0,y1).
+static inline void addUnit3(WORD* x, WORD y0, WORD y1)
+{
+   const WORD x0 = x[0];
+   const WORD x1 = x[1];
+   const WORD xz = ~(x0 | x1);
+   const WORD yz = ~(y0 | y1);
+   x[0] = (x0 & yz) | (y0 & xz) | (x1 & y1);
+   x[1] = (x1 & yz) | (y1 & xz) | (x0 & y0);
+}
+
+// Adds «nUnits» units of «src» to «dest».
+static void addUnits(WORD* dest, const WORD* src, size_t nUnits)
+{
+   if (ffChar == 2) {
+      for (size_t i = nUnits * NP; i > 0; --i) {
+         *dest++ ^= *src++;
+      }
+   } else {
+      for (; nUnits > 0; --nUnits, dest += 2, src += 2) {
+         addUnit3(dest, src[0], src[1]);
+      }
+   }
+}
+
+// Adds «f» times «nUnits» units of «src» to «dest».
+static void addMulUnits(WORD* dest, const WORD* src, FEL f, size_t nUnits)
+{
+   if (f == FF_ZERO) {
+      return;
+   }
+   if (f == FF_ONE) {
+      addUnits(dest, src, nUnits);
+   } else if (ffChar == 2) {
+      const uint8_t* const map = planeMap[f];
+      for (; nUnits > 0; --nUnits, dest += NP, src += NP) {
+         for (int j = 0; j < NP; ++j) {
+            dest[j] ^= combinePlanes(src, map[j]);
+         }
+      }
+   } else {    // GF(3), f = 2 = -1
+      for (; nUnits > 0; --nUnits, dest += 2, src += 2) {
+         addUnit3(dest, src[1], src[0]);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Calculate row size.
+/// Returns the number of bytes occupied in memory by a row of @em noc Elements.
+/// The row size is always a multiple of <tt>sizeof(long)</tt>. Depending on the number of
+/// columns there may be unused padding bits at the end of each plane.
+
+size_t ffRowSize(uint32_t noc)
+{
+   return upr(noc) * NP * sizeof(WORD);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Returns the number of bytes occupied in memory by @p nor rows of @p noc elements.
+
+ssize_t ffSize(uint32_t nor, uint32_t noc)
+{
+   return nor == 0 ? 0 : nor * ffRowSize(noc);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Number of used bytes in a row.
+/// This function returns the number of bytes occupied by a row of @em noc Elements in a data file.
+/// Unlike the other kernels, the bit-sliced kernel uses a different format in memory, so this
+/// number is not related to <tt>ffRowSize(noc)</tt>. See ffPackRow().
+
+size_t ffRowSizeUsed(int noc)
+{
+   if (noc == 0) {
+      return 0;
+   }
+   MTX_ASSERT(noc > 0);
+   return (noc - 1) / MPB + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Converts a row to the file format.
+/// This function stores the first @p noc elements of @p row in packed form (as used by the
+/// standard kernel) into @p buf, which must have room for ffRowSizeUsed(noc) bytes.
+
+void ffPackRow(uint8_t* buf, PTR row, uint32_t noc)
+{
+   memset(buf, 0, ffRowSizeUsed(noc));
+   for (uint32_t i = 0; i < noc; ++i) {
+      buf[i / MPB] = (uint8_t)(buf[i / MPB] + mtx_tinsert[i % MPB][ffExtract(row, i)]);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Converts a row from the file format.
+/// This is the inverse of ffPackRow(). The whole row, including padding, is overwritten.
+
+void ffUnpackRow(PTR row, const uint8_t* buf, uint32_t noc)
+{
+   ffMulRow(row, FF_ZERO, noc);
+   for (uint32_t i = 0; i < noc; ++i) {
+      const FEL f = mtx_textract[i % MPB][buf[i / MPB]];
+      if (f != FF_ZERO) {
+         ffInsert(row, i, f);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Add two rows.
+/// This function adds src to dest. Field order and row size must have been set before.
+/// @param dest The row to add to.
+/// @param src The row to add.
+/// @param noc Row size (number of columns).
+/// @return Always returns dest.
+
+PTR ffAddRow(PTR dest, PTR src, uint32_t noc)
+{
+   addUnits((WORD*) dest, (const WORD*) src, upr(noc));
+   return dest;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Adds a row to another row, starting at the given column.
+/// This is an optimized version of @ref ffAddRow to be used in row cleaning operations.
+/// The function assumes that both source and target rows have already been partially cleaned
+/// and contain only zeroes before @p firstcol. If this is not the case, the result is
+/// unspecified.
+///
+/// @param dest The row to add to.
+/// @param src The row to add.
+/// @param first First column to add.
+/// @param noc Row size (number of columns).
+
+void ffAddRowPartial(PTR dest, PTR src, uint32_t first, uint32_t noc)
+{
+   MTX_ASSERT(first < noc);
+   const size_t u0 = first / UNIT_COLS;
+   addUnits((WORD*) dest + u0 * NP, (const WORD*) src + u0 * NP, upr(noc) - u0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Multiply a vector by a field element.
+/// This function multiplies each element of @p row by @p mark.
+/// The field order must have been set before.
+///
+/// Multiplying a row with zero (FF_ZERO) initializes all elements to zero and is permitted even if
+/// @p row points to uninitialized memory. Furthermore, multiplying with FF_ZERO fills unused bits
+/// at the end of the row with zeroes.
+
+void ffMulRow(PTR row, FEL mark, int noc)
+{
+   MTX_ASSERT_DEBUG(isFel(mark));
+   WORD* x = (WORD*) row;
+   if (mark == FF_ZERO) {
+      memset(row, 0, ffRowSize(noc));
+   } else if (mark != FF_ONE && ffChar == 2) {
+      const uint8_t* const map = planeMap[mark];
+      for (size_t u = upr(noc); u > 0; --u, x += NP) {
+         WORD y[4];
+         for (int j = 0; j < NP; ++j) {
+            y[j] = combinePlanes(x, map[j]);
+         }
+         memcpy(x, y, NP * sizeof(WORD));
+      }
+   } else if (mark != FF_ONE) {        // GF(3), mark = 2
+      for (size_t u = upr(noc); u > 0; --u, x += 2) {
+         const WORD tmp = x[0];
+         x[0] = x[1];
+         x[1] = tmp;
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Adds a multiple of a row (@p src) to another row (@p dest). Both rows must have the same
+/// size (@p noc).
+
+void ffAddMulRow(PTR dest, PTR src, FEL f, uint32_t noc)
+{
+   MTX_ASSERT_DEBUG(isFel(f));
+   addMulUnits((WORD*) dest, (const WORD*) src, f, upr(noc));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Adds a multiple of a row, starting at the given column.
+///
+/// This is an optimized version of @ref ffAddMulRow to be used in row cleaning operations.
+/// The function assumes that both source and target rows have already been partially cleaned
+/// and contain only zeroes before @p firstcol. If this is not the case, the result is
+/// unspecified.
+///
+/// @param dest The row to add to.
+/// @param src The row to add.
+/// @param f The multiplier.
+/// @param firstcol First column to add.
+/// @param noc Row size (number of columns).
+
+void ffAddMulRowPartial(PTR dest, PTR src, FEL f, uint32_t firstcol, uint32_t noc)
+{
+   MTX_ASSERT_DEBUG(isFel(f));
+   MTX_ASSERT_DEBUG(firstcol < noc);
+   const size_t u0 = firstcol / UNIT_COLS;
+   addMulUnits((WORD*) dest + u0 * NP, (const WORD*) src + u0 * NP, f, upr(noc) - u0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Convert integer to field element.
+/// This function, together with ffFromInt(), defines a bijection between field elements and
+/// the set of integers {0, 1, ... q-1}, where q is the field order. The mapping is the same as
+/// in the standard kernel.
+
+FEL ffFromInt(int l)
+{
+   MTX_ASSERT(isFel(l));
+   return (FEL) l;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Inverse of @ref ffFromInt.
+
+int ffToInt(FEL f)
+{
+   return (int) f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Multiply a vector by a matrix.
+/// This function multiplies the vector @p row from the right by the matrix @p mat and
+/// stores the result into @p result.
+///
+/// @attention @em result and @em row must not overlap. Otherwise the result is undefined.
+///
+/// @param[out] result The resulting vector (@p noc columns).
+/// @param row The source vector (\a nor columns).
+/// @param matrix The matrix (\a nor by \a noc).
+/// @param nor number of rows in the matrix.
+/// @param noc number of columns in the matrix.
+
+void ffMapRow(PTR result, PTR row, PTR matrix, int nor, int noc)
+{
+   // Check that result and row do not overlap.
+   MTX_ASSERT(ffGetPtr(row, 1, nor) <= result || row >= ffGetPtr(result, 1, noc));
+
+   ffMulRow(result, FF_ZERO, noc);
+
+   const size_t nu = upr(noc);
+   const size_t wordsPerRow = nu * NP;
+   const WORD* const m = (const WORD*) matrix;
+   const WORD* r = (const WORD*) row;
+   for (int i0 = 0; i0 < nor; i0 += UNIT_COLS, r += NP) {
+      WORD nz = 0;
+      for (int k = 0; k < NP; ++k) {
+         nz |= r[k];
+      }
+      // «row» may be part of a longer row, ignore columns beyond «nor».
+      if (nor - i0 < UNIT_COLS) {
+         nz &= ((WORD) 1 << (nor - i0)) - 1;
+      }
+      while (nz != 0) {
+         const int bit = lowestBit(nz);
+         nz &= nz - 1;
+         addMulUnits((WORD*) result, m + (i0 + bit) * wordsPerRow, getElement(r, bit), nu);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Calculates the scalar product of two vectors, which must have equal size.
+/// @param a The first vector.
+/// @param b The second vector.
+/// @param noc Row size (number of columns).
+/// @return Scalar product of the two vectors.
+
+FEL ffScalarProduct(PTR a, PTR b, int noc)
+{
+   const WORD* x = (const WORD*) a;
+   const WORD* y = (const WORD*) b;
+   const size_t nu = upr(noc);
+
+   if (ffChar == 2) {
+      // parity[k][l] = sum of the products (plane k of a)·(plane l of b), mod 2
+      int parity[4][4] = {{0}};
+      for (size_t u = 0; u < nu; ++u, x += NP, y += NP) {
+         for (int k = 0; k < NP; ++k) {
+            for (int l = 0; l < NP; ++l) {
+               parity[k][l] ^= popCount(x[k] & y[l]) & 1;
+            }
+         }
+      }
+      FEL f = FF_ZERO;
+      for (int k = 0; k < NP; ++k) {
+         for (int l = 0; l < NP; ++l) {
+            if (parity[k][l]) {
+               f = ffAdd(f, ffMul((FEL)(1 << k), (FEL)(1 << l)));
+            }
+         }
+      }
+      return f;
+   }
+
+   // GF(3): count products equal to 1 and 2
+   size_t n1 = 0, n2 = 0;
+   for (size_t u = 0; u < nu; ++u, x += 2, y += 2) {
+      n1 += popCount(x[0] & y[0]) + popCount(x[1] & y[1]);
+      n2 += popCount(x[0] & y[1]) + popCount(x[1] & y[0]);
+   }
+   return ffFromInt((int)((n1 + 2 * (n2 % 3)) % 3));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Extract one column of a matrix.
+/// This function extracts one column out of a matrix and converts it into a row vector.
+/// in the call. The result is a row with @p nor entries, and the output buffer,
+/// @p result, must be large enough to store a vector of this size.
+/// @p mat and @p result must not overlap. If they do, the result is undefined.
+///
+/// @param mat Pointer to the matrix (@p nor by @p noc).
+/// @param nor Number of rows in matrix.
+/// @param noc Number of columns in matrix.
+/// @param col Column to extract (starting with 0).
+/// @param result Pointer to buffer for the extracted column (@p nor columns).
+
+void ffExtractColumn(PTR mat, int nor, int noc, int col, PTR result)
+{
+   const size_t wordsPerRow = upr(noc) * NP;
+   const int bit = col % UNIT_COLS;
+   const WORD* x = (const WORD*) mat + col / UNIT_COLS * NP;
+   WORD* y = (WORD*) result;
+
+   memset(result, 0, ffRowSize(nor));
+   for (int i = 0; i < nor; ++i, x += wordsPerRow) {
+      WORD* yu = y + i / UNIT_COLS * NP;
+      for (int k = 0; k < NP; ++k) {
+         yu[k] |= ((x[k] >> bit) & 1) << (i % UNIT_COLS);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Insert a mark into a row
+/// This function inserts the field element @em mark at position @em col into @em row.
+/// Column indexes start with 0.
+/// Before this function can be used, the field must be selected with ffSetField().
+///
+/// @note @c ffInsert() fails on negative column numbvers but does not detect writing beyond
+/// the end of @p row. Doing so results in undefined behaviour.
+///
+/// @param row Pointer to the row.
+/// @param col Insert position (0-based).
+/// @param mark Value to insert.
+
+void ffInsert(PTR row, int col, FEL mark)
+{
+   MTX_ASSERT(col >= 0);
+   MTX_ASSERT_DEBUG(isFel(mark));
+
+   WORD* unit = (WORD*) row + col / UNIT_COLS * NP;
+   const int bit = col % UNIT_COLS;
+   for (int k = 0; k < NP; ++k) {
+      unit[k] = (unit[k] & ~((WORD) 1 << bit)) | ((WORD)((mark >> k) & 1) << bit);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Extract a mark from a row
+/// This function returns the entry at position @p col of @p row.
+/// Note that column indexes start with 0, i.e., ffExtract(row,0) returns the first entry.
+/// Like ffInsert(), this function does not depend on the current row size.
+/// The index, @p col, is not checked. Reading at negative positions or beyond the end of the row
+/// results in undefined behaviour.
+///
+/// @param row Pointer to the row.
+/// @param col Index of mark to extract (0 based).
+/// @return The specified mark
+///
+/// @see FfInsert
+
+FEL ffExtract(PTR row, int col)
+{
+   FEL result = getElement((const WORD*) row + col / UNIT_COLS * NP, col % UNIT_COLS);
+   MTX_ASSERT_DEBUG(isFel(result));
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Find pivot column.
+/// This function finds the first non-zero mark in a row vector.
+/// The mark is stored into <tt>*mark</tt> and its position (counting from 0) is returned.
+/// If the whole vector is zero, <tt>ffFindPivot()</tt> returns @ref MTX_NVAL and
+/// leaves <tt>*mark</tt> unchanged.
+/// @param row Pointer to the row vector (@p noc columns).
+/// @param mark Buffer for pivot element. May be NULL if the value is not needed.
+/// @param noc Number of columns.
+/// @return Index of the first non-zero entry in @p row or -1 if all entries are zero.
+
+uint32_t ffFindPivot(PTR row, FEL *mark, int noc)
+{
+   const WORD* x = (const WORD*) row;
+   const size_t nu = upr(noc);
+   for (size_t u = 0; u < nu; ++u, x += NP) {
+      WORD nz = 0;
+      for (int k = 0; k < NP; ++k) {
+         nz |= x[k];
+      }
+      if (nz != 0) {
+         const int bit = lowestBit(nz);
+         const uint32_t idx = (uint32_t)(u * UNIT_COLS + bit);
+         if (idx >= (uint32_t) noc) {     // Ignore garbage in padding bits
+            return MTX_NVAL;
+         }
+         if (mark != NULL) {
+            *mark = getElement(x, bit);
+         }
+         return idx;
+      }
+   }
+   return MTX_NVAL;
+}
+
+// vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -19,17 +19,19 @@ typedef unsigned char POLY[MAXGRAD+1];
    ----------------------------------------------------------------- */
 
 
-uint8_t
-    mtx_tmult[256][256],
-    mtx_tadd[256][256],
-    mtx_taddinv[256],
-    mtx_tmultinv[256],
-	mtx_tffirst[256][2],
-	mtx_textract[8][256],
-	mtx_tnull[8][256],
-	mtx_tinsert[8][256];
-uint8_t mtx_embed[MTX_MAXSUBFIELDS][MTX_MAXSUBFIELDORD]; /* Embeddings of subfields */
-uint8_t mtx_restrict[MTX_MAXSUBFIELDS][256];	  /* Restriction to subfields */
+// Tables are computed here and written to the table file. The kernel does not use these arrays
+// but maps the table file, see ffSetField().
+static uint8_t
+    tmult[256][256],
+    tadd[256][256],
+    taddinv[256],
+    tmultinv[256],
+	tffirst[256][2],
+	textract[8][256],
+	tnull[8][256],
+	tinsert[8][256];
+static uint8_t tembed[MTX_MAXSUBFIELDS][MTX_MAXSUBFIELDORD]; /* Embeddings of subfields */
+static uint8_t trestrict[MTX_MAXSUBFIELDS][256];	  /* Restriction to subfields */
 static uint32_t subfieldOrder[MTX_MAXSUBFIELDS];		  /* Subfield orders */
 
 static uint32_t info[4] = {0L,0L,0L,0L};
@@ -43,6 +45,7 @@ static long G;		// generator for the multiplicative group
 static long CPM;	// no. of field elements (FELs) per uint8_t
 static long maxmem;	// (highest value stored in uint8_t) + 1
 static FILE *fd;	// table file pointer
+static char *tempName;	// temporary file name, see sysFopenTemp()
 
 
 static POLY irred;		/*  Polynomial which defines the field */
@@ -305,7 +308,7 @@ static void writeheader()
     int i, j;
 
     sprintf(filename,"p%3.3ld.zzz",Q);
-    fd = sysFopen(filename,"wb::lib");
+    fd = sysFopenTemp(filename,"wb::lib",&tempName);
     if (fd == NULL)
     {
 	perror(filename);
@@ -353,14 +356,14 @@ static void writeheader()
 
 static void inittables()
 {
-	memset(mtx_tmult,0xFF,sizeof(mtx_tmult));
-	memset(mtx_tadd,0xFF,sizeof(mtx_tadd));
-	memset(mtx_tffirst,0xFF,sizeof(mtx_tffirst));
-	memset(mtx_textract,0xFF,sizeof(mtx_textract));
-	memset(mtx_taddinv,0xFF,sizeof(mtx_taddinv));
-	memset(mtx_tmultinv,0xFF,sizeof(mtx_tmultinv));
-	memset(mtx_tnull,0xFF,sizeof(mtx_tnull));
-	memset(mtx_tinsert,0xFF,sizeof(mtx_tinsert));
+	memset(tmult,0xFF,sizeof(tmult));
+	memset(tadd,0xFF,sizeof(tadd));
+	memset(tffirst,0xFF,sizeof(tffirst));
+	memset(textract,0xFF,sizeof(textract));
+	memset(taddinv,0xFF,sizeof(taddinv));
+	memset(tmultinv,0xFF,sizeof(tmultinv));
+	memset(tnull,0xFF,sizeof(tnull));
+	memset(tinsert,0xFF,sizeof(tinsert));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -376,8 +379,8 @@ static void mkembed()
    int count = 0;  // number of proper subfields
    uint8_t emb, f;
 
-   memset(mtx_embed, 255, sizeof(mtx_embed));
-   memset(mtx_restrict, 255, sizeof(mtx_restrict));
+   memset(tembed, 255, sizeof(tembed));
+   memset(trestrict, 255, sizeof(trestrict));
    memset(subfieldOrder, 0, sizeof(subfieldOrder));       // mark as unused
 
    MTX_LOGD("Calculating embeddings of subfields");
@@ -391,8 +394,8 @@ static void mkembed()
          MTX_LOGD("GF(%ld)", P);
          subfieldOrder[count] = P;
          for (i = 0; i < (int) P; ++i) {
-            mtx_embed[count][i] = (uint8_t) i;
-            mtx_restrict[count][i] = (uint8_t) i;
+            tembed[count][i] = (uint8_t) i;
+            trestrict[count][i] = (uint8_t) i;
          }
          ++count;
          continue;
@@ -401,8 +404,8 @@ static void mkembed()
       // Calculate the subfield order
       for (q = 1, i = n; i > 0; --i, q *= P) {}
       subfieldOrder[count] = q;
-      mtx_embed[count][0] = 0;
-      mtx_restrict[count][0] = 0;
+      tembed[count][0] = 0;
+      trestrict[count][0] = 0;
       MTX_ASSERT((Q - 1) % (q - 1) == 0);
 
       // Calculate a generator for the subfield
@@ -427,8 +430,8 @@ static void mkembed()
       a[0] = 1;                 // a=X^0
       f = FF_ONE;
       for (i = 0; i < (int)q - 1; ++i) {
-         mtx_embed[count][number(a)] = f;
-         mtx_restrict[count][f] = number(a);
+         tembed[count][number(a)] = f;
+         trestrict[count][f] = number(a);
          polmultx(a);
          polymod(a, subirred);
          f = mult(f, emb);
@@ -440,7 +443,7 @@ static void mkembed()
       MTX_XLOG2(msg) {
          sbPrintf(msg, "GF(%2d) embedding: ", (int)subfieldOrder[i]);
          for (k = 0; k < 16; ++k) {
-            sbPrintf(msg, "%4d", mtx_embed[i][k]);
+            sbPrintf(msg, "%4d", tembed[i][k]);
          }
       }
    }
@@ -491,9 +494,9 @@ int ffMakeTables(int field)
 	for (j = 0; j < (int) CPM; j++)
     	{
 	    a[j] = (uint8_t) i;
-	    mtx_tinsert[j][i] = pack(a);	/* Insert-table */
+	    tinsert[j][i] = pack(a);	/* Insert-table */
 	    MTX_LOG2("insert[%d][%d]=%u (0x%x)",j,i,
-	     mtx_tinsert[j][i],mtx_tinsert[j][i]);
+	     tinsert[j][i],tinsert[j][i]);
 	    a[j] = 0;
     	}
     }
@@ -506,16 +509,16 @@ int ffMakeTables(int field)
 	flag = 0;
 	for (j = 0; j < (int) CPM; j++)
 	{
-	    mtx_textract[j][i] = a[j];
+	    textract[j][i] = a[j];
 	    z = a[j];
 	    a[j] = 0;
-	    mtx_tnull[j][i] = pack(a);     /* Null-table */
+	    tnull[j][i] = pack(a);     /* Null-table */
 	    a[j] = z;
 	    if (!flag && z)
 	    {
 		flag = 1;
-		mtx_tffirst[i][0] = z;  /* Find first table: mark */
-		mtx_tffirst[i][1] = (uint8_t)j;  /* Find first table: pos. */
+		tffirst[i][0] = z;  /* Find first table: mark */
+		tffirst[i][1] = (uint8_t)j;  /* Find first table: pos. */
 	    }
 	}
 	if (Q != 2)
@@ -527,27 +530,27 @@ int ffMakeTables(int field)
 		{
 		    for (k=0; k < (int) CPM; k++)
 			c[k] = add(a[k],b[k]);
-		    mtx_tadd[i][j] = pack(c);
+		    tadd[i][j] = pack(c);
 		}
 		else
-		    mtx_tadd[i][j]=mtx_tadd[j][i];
+		    tadd[i][j]=tadd[j][i];
 
 		if (i < (int) Q)
 		{
 		    for (k=0; k < (int) CPM; k++)
 			d[k] = mult(a[(int)CPM-1],b[k]);
-		    mtx_tmult[i][j] = pack(d);
+		    tmult[i][j] = pack(d);
 		}
 		else
-		    mtx_tmult[i][j] = mtx_tmult[i-(int)Q][j];
+		    tmult[i][j] = tmult[i-(int)Q][j];
 	    }
 	}
 	else	/* GF(2) */
 	{
 	    for (j=0; j < (int) maxmem; j++)
 	    {
-		mtx_tadd[i][j] = (uint8_t)(i ^ j);
-		mtx_tmult[i][j] = (uint8_t)((i & 1) != 0 ?  j : 0);
+		tadd[i][j] = (uint8_t)(i ^ j);
+		tmult[i][j] = (uint8_t)((i & 1) != 0 ?  j : 0);
 	    }
 	}
     }
@@ -558,8 +561,8 @@ int ffMakeTables(int field)
     {
         for (j = 0; j < (int)Q; j++)
 	{
-	    if (add((uint8_t)i,(uint8_t)j) == 0) mtx_taddinv[i] = (uint8_t)j;
-	    if (mult((uint8_t)i,(uint8_t)j) == 1) mtx_tmultinv[i] = (uint8_t)j;
+	    if (add((uint8_t)i,(uint8_t)j) == 0) taddinv[i] = (uint8_t)j;
+	    if (mult((uint8_t)i,(uint8_t)j) == 1) tmultinv[i] = (uint8_t)j;
 	}
     }
 
@@ -568,19 +571,19 @@ int ffMakeTables(int field)
     MTX_LOGD("Writing tables to %s",filename);
     sysWrite32(fd,info,4);
     sysWrite32(fd,&ver,1);
-    sysWrite8(fd,mtx_tmult,sizeof(mtx_tmult));
-    sysWrite8(fd,mtx_tadd,sizeof(mtx_tadd));
-    sysWrite8(fd, mtx_tffirst,sizeof(mtx_tffirst));
-    sysWrite8(fd, mtx_textract,sizeof(mtx_textract));
-    sysWrite8(fd, mtx_taddinv,sizeof(mtx_taddinv));
-    sysWrite8(fd, mtx_tmultinv,sizeof(mtx_tmultinv));
-    sysWrite8(fd, mtx_tnull,sizeof(mtx_tnull));
-    sysWrite8(fd, mtx_tinsert,sizeof(mtx_tinsert));
+    sysWrite8(fd,tmult,sizeof(tmult));
+    sysWrite8(fd,tadd,sizeof(tadd));
+    sysWrite8(fd, tffirst,sizeof(tffirst));
+    sysWrite8(fd, textract,sizeof(textract));
+    sysWrite8(fd, taddinv,sizeof(taddinv));
+    sysWrite8(fd, tmultinv,sizeof(tmultinv));
+    sysWrite8(fd, tnull,sizeof(tnull));
+    sysWrite8(fd, tinsert,sizeof(tinsert));
     sysWrite32(fd,subfieldOrder,MTX_MAXSUBFIELDS);
-    sysWrite8(fd,mtx_embed, MTX_MAXSUBFIELDS * MTX_MAXSUBFIELDORD);
-    sysWrite8(fd,mtx_restrict, MTX_MAXSUBFIELDS * 256);
+    sysWrite8(fd,tembed, MTX_MAXSUBFIELDS * MTX_MAXSUBFIELDORD);
+    sysWrite8(fd,trestrict, MTX_MAXSUBFIELDS * 256);
 
-    fclose(fd);
+    sysCommitFile(fd, tempName);
     return(0);
 }
 
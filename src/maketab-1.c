@@ -43,6 +43,7 @@ static uint32_t N;        // Q = P^N
 static uint16_t Gen;      // Generator
 
 static FILE *fd;                // Output file
+static char *tempName;          // Temporary file name, see sysFopenTemp()
 
 // The defining polynomial d(x). For prime fields, the polynomial is
 // not relevant and set to d(x)=x.
@@ -558,7 +559,7 @@ static void writeHeader()
 
    char fname[50];
    sprintf(fname, "p%5.5ld.zzz", (long) Q);
-   fd = sysFopen(fname, "wb::lib");
+   fd = sysFopenTemp(fname, "wb::lib", &tempName);
 
    const uint32_t header[5] = { MTX_ZZZVERSION, P, Q, N, Gen };
    sysWrite32(fd, header, 5);
@@ -603,7 +604,7 @@ static void writeTables()
    sysWrite16(fd, &numberOfSubfields,1);
    sysWrite16(fd, subfieldOrders, numberOfSubfields);
    sysWrite16(fd, embeddingTables, embeddingTablesSize);
-   fclose(fd);
+   sysCommitFile(fd, tempName);
    MTX_LOGD("Ok\n");
 }
 
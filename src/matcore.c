@@ -189,13 +189,51 @@ void mat_DeletePivotTable(Matrix_t *mat)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Prepares a destination matrix.
+/// This function is used internally by the matXxxInto() functions, applications should never call
+/// it directly. If @p dest is NULL, a new @p nor by @p noc matrix over GF(@p field) is created.
+/// Otherwise, @p dest is changed to the given field and dimensions, and its pivot table is
+/// deleted. The row buffer is kept if the size does not change, and the contents of the matrix
+/// are undefined on return. The caller must overwrite all rows.
+///
+/// @return @p dest, or the new matrix.
+
+Matrix_t *mat_Prepare(Matrix_t *dest, int field, uint32_t nor, uint32_t noc)
+{
+   if (dest == NULL) {
+      return matAlloc(field, nor, noc);
+   }
+   matValidate(MTX_HERE, dest);
+   mat_DeletePivotTable(dest);
+   if (dest->field != field || dest->nor != nor || dest->noc != noc) {
+      if (dest->field == ffOrder) {
+         ffFreeRows(dest->data, dest->nor, dest->noc);
+      } else {
+         sysFree(dest->data);
+      }
+      ffSetField(field);
+      dest->field = field;
+      dest->nor = nor;
+      dest->noc = noc;
+      dest->data = ffAlloc(nor, noc);
+   }
+   ffSetField(field);
+   return dest;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Deletes a matrix and releases all associated resources.
 
 void matFree(Matrix_t *mat)
 {
    matValidate(MTX_HERE, mat);
    mat_DeletePivotTable(mat);
-   sysFree(mat->data);
+   if (mat->field == ffOrder) {
+      ffFreeRows(mat->data, mat->nor, mat->noc);     // keep for reuse, see ffAlloc()
+   } else {
+      sysFree(mat->data);
+   }
    mat->data = NULL;
    mmFree(mat, MTX_TYPE_MATRIX);
 }
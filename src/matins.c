@@ -3,152 +3,287 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "meataxe.h"
+#include <string.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Local data
 
+// Maximal number of powers Aⁱ which are kept for the Paterson-Stockmeyer scheme.
+#define MAX_POWERS 16
 
-/// @addtogroup mat
-/// @{
+/// @private
+/// Powers A, A², ..., Aᵏ of a square matrix, see matPowersAlloc().
+struct MatPowers {
+   int field;
+   uint32_t nor;
+   uint32_t count;              // Number of available powers
+   int ownsFirst;               // 0: power[0] belongs to the caller
+   PTR power[MAX_POWERS];       // power[i] = Aⁱ⁺¹
+};
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-/// Insert a matrix into a polynomial
-/// Given a square matrix A and a polynomial p over the same field, this functions
-/// calculates p(A). Unlike matInsert() this function is destructive. The result
-/// is stored in the original matrix and the old value is lost.
-/// @param mat Pointer to the matrix.
-/// @param pol Pointer to the polynomial.
-/// @return The function returns @em mat, or 0 on error.
 
-Matrix_t* matInsert_(Matrix_t* mat, const Poly_t* pol)
+// Returns the number of matrix multiplications needed to evaluate a polynomial of degree «d» ≥ 1
+// with step «s» (1 ≤ s ≤ d), if the first «count» powers of the matrix are already known.
+
+static uint32_t cost(uint32_t d, uint32_t s, uint32_t count)
 {
-   int i;
-   int l;
-   PTR v;
-   FEL f;
+   const uint32_t newPowers = s > count ? s - count : 0;
+   return newPowers + (d % s == 0 ? d / s - 1 : d / s);
+}
 
-   matValidate(MTX_HERE, mat);
-   polValidate(MTX_HERE, pol);
-   const uint32_t nor = mat->nor;
-   if (nor != mat->noc || mat->field != pol->field) {
-      mtxAbort(MTX_HERE, "%s", MTX_ERR_NOTSQUARE);
+// Releases the powers which are owned by the table.
+
+static void freePowers(struct MatPowers* pw)
+{
+   for (uint32_t i = pw->ownsFirst ? 0 : 1; i < pw->count; ++i) {
+      if (pw->field == ffOrder) {
+         ffFreeRows(pw->power[i], pw->nor, pw->nor);     // keep for reuse, see ffAlloc()
+      } else {
+         sysFree(pw->power[i]);
+      }
    }
+   pw->count = 0;
+}
 
-   ffSetField(mat->field);
+// Calculates the missing powers up to Aˢ.
 
-   // Special case: p(x) = 0
-   if (pol->degree == -1) {
-      for (l = 0, v = mat->data; l < nor; ffStepPtr(&v, nor), ++l) {
-         ffMulRow(v, FF_ZERO, nor);
+static void extendPowers(struct MatPowers* pw, uint32_t s)
+{
+   const uint32_t nor = pw->nor;
+   for (; pw->count < s; ++pw->count) {
+      PTR x = ffAlloc(nor, nor);
+      ffMulMatrix(x, pw->power[pw->count - 1], pw->power[0], nor, nor, nor);
+      pw->power[pw->count] = x;
+   }
+}
+
+// Adds ∑ cᵢ·Aⁱ⁻ᶠⁱʳˢᵗ to «r», where cᵢ are the coefficients of «pol» and the sum runs over
+// first ≤ i ≤ last.
+
+static void addBlock(PTR r, const struct MatPowers* pw, const Poly_t* pol, int first, int last)
+{
+   const uint32_t nor = pw->nor;
+   for (int i = first; i <= last; ++i) {
+      const FEL f = pol->data[i];
+      if (f == FF_ZERO) {
+         continue;
+      }
+      PTR y = r;
+      if (i == first) {
+         for (uint32_t l = 0; l < nor; ++l, ffStepPtr(&y, nor)) {
+            ffInsert(y, l, ffAdd(ffExtract(y, l), f));
+         }
+      } else {
+         PTR x = pw->power[i - first - 1];
+         for (uint32_t l = 0; l < nor; ++l, ffStepPtr(&x, nor), ffStepPtr(&y, nor)) {
+            ffAddMulRow(y, x, f, nor);
+         }
       }
-      return mat;
    }
+}
 
-   // Special case: deg(p) = 0
-   if (pol->degree == 0) {
-      for (l = 0, v = mat->data; l < nor; ffStepPtr(&v, nor), ++l) {
-         ffMulRow(v, FF_ZERO, nor);
-         ffInsert(v, l, pol->data[0]);
+// Calculates pol(A) for a polynomial of degree at least 1 (Paterson-Stockmeyer scheme). The
+// polynomial is split into blocks of s coefficients, p(x) = ∑ⱼ Bⱼ(x)·xˢʲ with deg(Bⱼ) < s.
+// Each Bⱼ(A) is a linear combination of the powers A⁰,...,Aˢ⁻¹, and the blocks are combined with
+// the Horner scheme in Aˢ. The step s is chosen to minimize the number of matrix multiplications,
+// taking into account powers which are already known. Missing powers are added to «pw».
+
+static void insertPowers(Matrix_t* result, struct MatPowers* pw, const Poly_t* pol)
+{
+   const uint32_t d = pol->degree;
+   const uint32_t nor = pw->nor;
+   uint32_t s = 1;
+   for (uint32_t t = 2; t <= d && t <= MAX_POWERS; ++t) {
+      if (cost(d, t, pw->count) < cost(d, s, pw->count)) {
+         s = t;
       }
-      return mat;
    }
+   extendPowers(pw, s);
 
-   // Evaluate p(A)
-   Matrix_t* x = NULL;
-   if (pol->degree > 1) {
-      x = matDup(mat);
+   // The leading coefficient alone is combined with the block below.
+   int j = (int) (d / s);
+   if (d % s == 0) {
+      --j;
    }
-   if ((f = pol->data[pol->degree]) != FF_ONE) {
-      for (l = nor, v = mat->data; l > 0; --l, ffStepPtr(&v, nor)) {
-         ffMulRow(v, f, nor);
-      }
+   PTR r = result->data;
+   PTR tmp = NULL;
+   PTR v = r;
+   for (uint32_t l = 0; l < nor; ++l, ffStepPtr(&v, nor)) {
+      ffMulRow(v, FF_ZERO, nor);
    }
-   for (i = pol->degree - 1; i >= 0; --i) {
-      if ((f = pol->data[i]) != FF_ZERO) {
-         for (l = 0, v = mat->data; l < nor; ++l, ffStepPtr(&v, nor)) {
-            ffInsert(v, l, ffAdd(ffExtract(v, l), f));
-         }
-      }
-      if (i > 0) {
-         matMul(mat, x);
+   addBlock(r, pw, pol, j * s, d);
+   for (--j; j >= 0; --j) {
+      if (tmp == NULL) {
+         tmp = ffAlloc(nor, nor);
       }
+      ffMulMatrix(tmp, r, pw->power[s - 1], nor, nor, nor);
+      PTR swap = r;
+      r = tmp;
+      tmp = swap;
+      addBlock(r, pw, pol, j * s, j * s + s - 1);
    }
-   if (x != NULL) {
-      matFree(x);
+   result->data = r;
+   if (tmp != NULL) {
+      ffFreeRows(tmp, nor, nor);
    }
-   return mat;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Insert a matrix into a polynomial
+/// Given a square matrix A and a polynomial p over the same field, this functions
+/// calculates p(A). Unlike matInsert() this function is destructive. The result
+/// is stored in the original matrix and the old value is lost.
+/// @param mat Pointer to the matrix.
+/// @param pol Pointer to the polynomial.
+/// @return The function returns @em mat, or 0 on error.
+
+Matrix_t* matInsert_(Matrix_t* mat, const Poly_t* pol)
+{
+   matValidate(MTX_HERE, mat);
+   Matrix_t* x = matDup(mat);
+   matInsertInto(mat, x, pol);
+   matFree(x);
+   return mat;
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Insert a matrix into a polynomial
 /// Given a square matrix A and a polynomial p over the same field, this functions
 /// calculates p(A). Unlike matInsert_() this function returns a new matrix and does
 /// not modify the original matrix.
+/// @see matInsertInto()
 /// @param mat Pointer to the matrix.
 /// @param pol Pointer to the polynomial.
 /// @return @em pol(@em mat), or 0 on error.
 
 Matrix_t *matInsert(const Matrix_t *mat, const Poly_t *pol)
 {
-   Matrix_t *x;
-   int i;
-   uint32_t nor;
-   int l;
-   PTR v;
-   FEL f;
+   return matInsertInto(NULL, mat, pol);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Insert a matrix into a polynomial and store the result in a given matrix.
+/// This function works like matInsert(), but the result is stored in @em result. If @em result is
+/// NULL, a new matrix is created. Otherwise, @em result is resized if necessary and its previous
+/// contents are lost. @em result must not be the same matrix as @em mat.
+///
+/// p(A) is evaluated with the Paterson-Stockmeyer scheme, see matInsertPowers(). The powers of
+/// @em mat are discarded on return. To evaluate several polynomials at the same matrix, use
+/// matPowersAlloc() and matInsertPowers() instead. Temporary buffers are released with
+/// ffFreeRows() and can thus be reused by the next call.
+/// @param result Destination matrix or NULL.
+/// @param mat Pointer to the matrix.
+/// @param pol Pointer to the polynomial.
+/// @return @em pol(@em mat). This is @em result if it was not NULL.
 
+Matrix_t *matInsertInto(Matrix_t *result, const Matrix_t *mat, const Poly_t *pol)
+{
    matValidate(MTX_HERE, mat);
-   polValidate(MTX_HERE, pol);
-   if ((nor = mat->nor) != mat->noc) {
+   if (mat->nor != mat->noc) {
       mtxAbort(MTX_HERE,"%s",MTX_ERR_NOTSQUARE);
       return NULL;
    }
-   if (mat->field != pol->field) {
-      mtxAbort(MTX_HERE,"%s",MTX_ERR_INCOMPAT);
-      return NULL;
+   if (result == mat) {
+      mtxAbort(MTX_HERE,"Destination overlaps the argument: %s",MTX_ERR_BADARG);
    }
 
-   // Special case: p = 0
-   if (pol->degree == -1) {
-      return matAlloc(mat->field,nor,nor);
+   // Use a temporary power table which borrows the data of «mat».
+   struct MatPowers pw;
+   pw.field = mat->field;
+   pw.nor = mat->nor;
+   pw.count = 1;
+   pw.ownsFirst = 0;
+   pw.power[0] = mat->data;
+   result = matInsertPowers(result, &pw, pol);
+   freePowers(&pw);
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Creates a power table for a square matrix.
+/// The power table keeps the powers A, A², ..., Aᵏ of a square matrix A, which are calculated as
+/// needed by matInsertPowers(). Using the same power table for several polynomials avoids
+/// recalculating the powers. The power table holds a copy of @em mat, so the matrix may be
+/// modified or destroyed afterwards. The table must be released with matPowersFree().
+/// @param mat Pointer to the matrix.
+/// @return Pointer to the new power table.
+
+MatPowers_t* matPowersAlloc(const Matrix_t* mat)
+{
+   matValidate(MTX_HERE, mat);
+   if (mat->nor != mat->noc) {
+      mtxAbort(MTX_HERE,"%s",MTX_ERR_NOTSQUARE);
+      return NULL;
    }
+   MatPowers_t* pw = ALLOC(MatPowers_t);
+   memset(pw, 0, sizeof(*pw));
+   pw->field = mat->field;
+   pw->nor = mat->nor;
+   pw->count = 1;
+   pw->ownsFirst = 1;
+   ffSetField(mat->field);
+   pw->power[0] = ffAlloc(mat->nor, mat->nor);
+   memcpy(pw->power[0], mat->data, ffSize(mat->nor, mat->nor));
+   return pw;
+}
 
-   // Special case: deg(p) = 0
-   if (pol->degree == 0) {
-      x = matAlloc(mat->field,nor,nor);
-      if (x == NULL) {
-	  return NULL;
-      }
-      for (l = 0, v = x->data; l < nor; ++l, ffStepPtr(&v, nor)) {
-         ffInsert(v,l,pol->data[0]);
-      }
-      return x;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Releases a power table created by matPowersAlloc().
+/// @param pw Pointer to the power table. If NULL, the function does nothing.
+
+void matPowersFree(MatPowers_t* pw)
+{
+   if (pw == NULL) {
+      return;
    }
+   freePowers(pw);
+   memset(pw, 0, sizeof(*pw));
+   sysFree(pw);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Insert a matrix into a polynomial using a power table.
+/// This function works like matInsertInto(), but the matrix A is given by its power table (see
+/// matPowersAlloc()). Powers of A which are calculated during the evaluation are added to the
+/// table and will be reused by subsequent calls with the same table.
+///
+/// p(A) is evaluated with the Paterson-Stockmeyer scheme, which needs about 2√d matrix
+/// multiplications for a polynomial of degree d, or about d/k multiplications if the first k
+/// powers of A are already known. At most 16 powers are kept.
+/// @param result Destination matrix or NULL.
+/// @param pw Pointer to the power table.
+/// @param pol Pointer to the polynomial.
+/// @return @em pol(A). This is @em result if it was not NULL.
 
-   // Evaluate p(A)
-   x = matDup(mat);
-   if (x == NULL) {
+Matrix_t* matInsertPowers(Matrix_t* result, MatPowers_t* pw, const Poly_t* pol)
+{
+   polValidate(MTX_HERE, pol);
+   if (pw->field != pol->field) {
+      mtxAbort(MTX_HERE,"%s",MTX_ERR_INCOMPAT);
       return NULL;
    }
-   if ((f = pol->data[pol->degree]) != FF_ONE) {
-      for (l = nor, v = x->data; l > 0; --l, ffStepPtr(&v, nor)) {
-         ffMulRow(v,f, nor);
-      }
+   const uint32_t nor = pw->nor;
+   result = mat_Prepare(result, pw->field, nor, nor);
+   if (result->data == pw->power[0]) {
+      mtxAbort(MTX_HERE,"Destination overlaps the argument: %s",MTX_ERR_BADARG);
    }
-   for (i = pol->degree - 1; i >= 0; --i) {
-      if ((f = pol->data[i]) != FF_ZERO) {
-         for (l = 0, v = x->data; l < nor; ++l, ffStepPtr(&v, nor)) {
-            ffInsert(v,l,ffAdd(ffExtract(v,l),f));
+
+   // Special cases: p = 0 and deg(p) = 0
+   if (pol->degree <= 0) {
+      PTR v = result->data;
+      for (uint32_t l = 0; l < nor; ++l, ffStepPtr(&v, nor)) {
+         ffMulRow(v, FF_ZERO, nor);
+         if (pol->degree == 0) {
+            ffInsert(v, l, pol->data[0]);
          }
       }
-      if (i > 0) {
-         matMul(x,mat);
-      }
+      return result;
    }
-   return x;
-}
 
+   insertPowers(result, pw, pol);
+   return result;
+}
 
 /// @}
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -11,53 +11,29 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Inverts «mat» (which is destroyed) and stores the result in «result».
+// The rows of «mat» are reduced with ffPleDecompose(), applying the same operations to the
+// identity matrix. Afterwards, row i of «mat» is the unit vector with pivot rowPiv[i], so row i of
+// the transformed identity matrix is row rowPiv[i] of the inverse.
+
 static void zmatinv(PTR mat, PTR result, int noc)
 {
-   PTR xj1, xj2, xk1, xk2;
-   FEL f1 = FF_ZERO, f2;
-   long j, k;
-
-   // initialize result with identity matrix
-   for (j = 0, xj1 = result; j < noc; ++j, ffStepPtr(&xj1, noc)) {
-      ffMulRow(xj1,FF_ZERO, noc);
-      ffInsert(xj1,j,FF_ONE);
+   PTR t = ffAlloc(noc, noc);
+   PTR x = t;
+   for (long j = 0; j < noc; ++j, ffStepPtr(&x, noc)) {
+      ffInsert(x,j,FF_ONE);
    }
 
-   // matrix inversion
-   xj1 = mat;
-   xj2 = result;
-   for (j = 0; j < noc; ++j) {
-
-      for (xk1 = xj1, k = j;
-           k < noc && (f1 = ffExtract(xk1,j)) == FF_ZERO;
-           ++k, ffStepPtr(&xk1, noc)) {
-      }
-      if (f1 == FF_ZERO) {
-         mtxAbort(MTX_HERE,"%s",MTX_ERR_DIV0);
-      }
-      if (k > j) {
-         ffSwapRows(xk1,xj1,noc);
-         // xk2 = ffGetPtr(xj2,k-j,noc)
-         xk2 = (PTR)((char *)xj2 + (k - j) * ffRowSize(noc));
-         ffSwapRows(xk2,xj2,noc);
-      }
-      f2 = ffInv(f1);
-      ffMulRow(xj1,f2,noc);
-      ffMulRow(xj2,f2,noc);
-      xk1 = mat;
-      xk2 = result;
-      for (k = 0; k < noc; ++k) {
-         if (k != j) {
-            f1 = ffNeg(ffExtract(xk1,j));
-            ffAddMulRow(xk1,xj1,f1, noc);
-            ffAddMulRow(xk2,xj2,f1, noc);
-         }
-         ffStepPtr(&xk1, noc);
-         ffStepPtr(&xk2, noc);
-      }
-      ffStepPtr(&xj1, noc);
-      ffStepPtr(&xj2, noc);
+   uint32_t *rowPiv = NALLOC(uint32_t, noc);
+   if (ffPleDecompose(mat, noc, noc, t, noc, rowPiv, FF_PLE_REDUCE) < (uint32_t) noc) {
+      mtxAbort(MTX_HERE,"%s",MTX_ERR_DIV0);
+   }
+   x = t;
+   for (long j = 0; j < noc; ++j, ffStepPtr(&x, noc)) {
+      ffCopyRow(ffGetPtr(result, rowPiv[j], noc), x, noc);
    }
+   sysFree(rowPiv);
+   ffFreeRows(t, noc, noc);
 }
 
 
@@ -68,26 +44,41 @@ static void zmatinv(PTR mat, PTR result, int noc)
 /// Calculates and returns the inverse of a matrix. @p mat must be a non-singular square matrix,
 /// otherwise the program is aborted with an error message.
 /// The return value is a independent matrix, the original matrix remains unchanged.
+/// @see matInverseInto()
 
 Matrix_t *matInverse(const Matrix_t *mat)
 {
+   return matInverseInto(NULL, mat);
+}
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Calculates the inverse of a matrix and stores it in @p result.
+/// This function works like matInverse(). If @p result is NULL, a new matrix is created.
+/// Otherwise, @p result is resized if necessary and its previous contents are lost. @p result must
+/// not be the same matrix as @p mat.
+/// @return The inverse matrix. This is @p result if it was not NULL.
+
+Matrix_t *matInverseInto(Matrix_t *result, const Matrix_t *mat)
+{
    matValidate(MTX_HERE, mat);
    if (mat->nor != mat->noc) {
       mtxAbort(MTX_HERE,"%s",MTX_ERR_NOTSQUARE);
    }
+   if (result == mat) {
+      mtxAbort(MTX_HERE,"Destination overlaps the argument: %s",MTX_ERR_BADARG);
+   }
    const int dim = mat->nor;
-   Matrix_t *dest = matId(mat->field, dim);
+   result = mat_Prepare(result, mat->field, dim, dim);
 
    // Copy matrix into workspace
    PTR tmp = ffAlloc(dim, dim);
    memcpy(tmp,mat->data,ffSize(dim, dim));
 
    // Inversion
-   zmatinv(tmp,dest->data, dim);
-   ffFree(tmp);
+   zmatinv(tmp,result->data, dim);
+   ffFreeRows(tmp, dim, dim);
 
-   return dest;
+   return result;
 }
 
 /// @}
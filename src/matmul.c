@@ -3,14 +3,474 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "meataxe.h"
+#include <string.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Local data
 
+// Greased multiplication is only used for fields up to this order. For larger fields the
+// tables would hold too few rows to pay off.
+#define GREASE_MAX_FIELD 16
+
+// Maximal number of rows in a grease table.
+#define GREASE_MAX_TABLE 256
+
+// Products are distributed over the thread pool if the number of rows times the number of columns
+// of the left factor times the number of columns of the right factor is at least this value.
+#define PARALLEL_MIN_WORK ((uint64_t) 1 << 24)
+
+// Minimal number of result rows per task. Smaller blocks would not allow greased multiplication.
+#define PARALLEL_MIN_ROWS 256
+
+/// Cutoff for Strassen-Winograd multiplication.
+/// ffMulMatrix() uses the recursive Strassen-Winograd algorithm if all three matrix dimensions are
+/// at least this value. Below the cutoff, blocks are multiplied with the classical (or greased)
+/// method. The value may be changed at any time; 0 disables the Strassen-Winograd algorithm.
+
+uint32_t ffStrassenCutoff = 2048;
+
+/// Cache size for blocked multiplication.
+/// If the right factor does not fit into this many bytes, ffMulMatrix() processes it in tiles of
+/// half this size. The default value 0 selects the size of the L2 cache, see sysCacheSize(). The
+/// value may be changed at any time.
+
+size_t ffMulCacheSize = 0;
+
 
 /// @addtogroup mat
 /// @{
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the grease level, i.e. the number of rows of the right factor which are combined into
+// one table, or 0 if greased multiplication is not expected to be faster than the row-by-row
+// method. «nor» is the number of rows of the left factor, «nocA» the number of rows of the right
+// factor. The current field must have been set.
+
+static int greaseLevel(uint32_t nor, uint32_t nocA)
+{
+   if (ffOrder > GREASE_MAX_FIELD || nocA < 2) {
+      return 0;
+   }
+   int k = 0;
+   uint32_t tableSize = 1;
+   while (tableSize * ffOrder <= GREASE_MAX_TABLE && (uint32_t) k < nocA) {
+      tableSize *= ffOrder;
+      ++k;
+   }
+   if (k < 2) {
+      return 0;
+   }
+
+   // Cost in row operations per block of k rows: tableSize to build the table plus one addition
+   // per left factor row. The classical method needs k*(q-1)/q row operations per left factor row
+   // on average. We require a gain of at least 25%.
+   const double greased = (double) tableSize + (double) nor;
+   const double classical = (double) k * nor * (ffOrder - 1) / ffOrder;
+   return greased < 0.75 * classical ? k : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Fills the grease table for rows «b»,...,«b»+k-1 of the right factor. Table row number
+// c₀ + c₁q + ... + cₖ₋₁qᵏ⁻¹ contains the linear combination ∑ ffFromInt(cᵢ)·bᵢ.
+
+static void makeGreaseTable(PTR table, PTR b, int k, uint32_t noc)
+{
+   const size_t rowSize = ffRowSize(noc);
+   ffMulRow(table, FF_ZERO, noc);
+   uint32_t n = 1;      // number of valid table rows
+   for (int j = 0; j < k; ++j) {
+      PTR dest = (PTR)((char*) table + n * rowSize);
+      for (uint32_t c = 1; c < ffOrder; ++c) {
+         const FEL f = ffFromInt(c);
+         PTR src = table;
+         for (uint32_t i = 0; i < n; ++i) {
+            ffCopyRow(dest, src, noc);
+            ffAddMulRow(dest, b, f, noc);
+            ffStepPtr(&src, noc);
+            ffStepPtr(&dest, noc);
+         }
+      }
+      n *= ffOrder;
+      ffStepPtr(&b, noc);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Greased ("four Russians") multiplication. The right factor is processed in blocks of «k»
+// rows. For each block, all linear combinations of the block rows are precomputed, and each
+// row of the result is then updated with a single row addition.
+
+static void mulGreased(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB,
+      int k)
+{
+   uint32_t tableSize = 1;
+   for (int i = 0; i < k; ++i) {
+      tableSize *= ffOrder;
+   }
+   PTR table = ffAlloc(tableSize, nocB);
+   const size_t rowSize = ffRowSize(nocB);
+
+   for (uint32_t j0 = 0; j0 < nocA; j0 += k) {
+      const int kk = (nocA - j0 < (uint32_t) k) ? (int)(nocA - j0) : k;
+      makeGreaseTable(table, ffGetPtr(b, j0, nocB), kk, nocB);
+      PTR x = a;
+      PTR y = result;
+      for (uint32_t i = 0; i < norA; ++i) {
+         uint32_t index = 0;
+         for (int t = kk - 1; t >= 0; --t) {
+            index = index * ffOrder + ffToInt(ffExtract(x, j0 + t));
+         }
+         if (index != 0) {
+            ffAddRow(y, (PTR)((char*) table + index * rowSize), nocB);
+         }
+         ffStepPtr(&x, nocA);
+         ffStepPtr(&y, nocB);
+      }
+   }
+
+   ffFree(table);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the number of columns in the smallest row unit, i.e., the alignment for column
+// splits. A block starting at a multiple of this value starts at a unit boundary in the row,
+// regardless of how field elements are packed. This is one «long» for the standard and big
+// kernels, and 64 columns (all planes) for the bit-sliced kernel.
+
+static uint32_t colsPerUnit()
+{
+   const size_t unitSize = ffRowSize(1);
+   uint32_t n = 1;
+   while (ffRowSize(n + 1) == unitSize) {
+      ++n;
+   }
+   return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Copies the «nor» by «noc» block at («row0»,«col0») of the «srcNor» by «srcNoc» matrix «src»
+// into a new matrix. Rows and columns outside the source matrix are filled with zeroes.
+// «col0» and «noc» must be multiples of colsPerUnit().
+
+static Matrix_t* getBlock(PTR src, uint32_t srcNor, uint32_t srcNoc,
+      uint32_t row0, uint32_t col0, uint32_t nor, uint32_t noc)
+{
+   Matrix_t* blk = matAlloc(ffOrder, nor, noc);
+   if (row0 >= srcNor || col0 >= srcNoc) {
+      return blk;
+   }
+   const size_t srcRowSize = ffRowSize(srcNoc);
+   const size_t offset = ffRowSize(col0);
+   size_t n = ffRowSize(noc);
+   if (n > srcRowSize - offset) {
+      n = srcRowSize - offset;     // the padding of «src» is zero
+   }
+   const char* s = (const char*) ffGetPtr(src, row0, srcNoc) + offset;
+   PTR d = blk->data;
+   for (uint32_t i = row0; i < srcNor && i < row0 + nor; ++i) {
+      memcpy(d, s, n);
+      s += srcRowSize;
+      ffStepPtr(&d, noc);
+   }
+   return blk;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Inverse of getBlock(): copies the block «blk» to («row0»,«col0») of «dest». Parts of the
+// block outside the destination matrix are ignored and must be zero.
+
+static void putBlock(PTR dest, uint32_t destNor, uint32_t destNoc,
+      uint32_t row0, uint32_t col0, const Matrix_t* blk)
+{
+   if (row0 >= destNor || col0 >= destNoc) {
+      return;
+   }
+   const size_t destRowSize = ffRowSize(destNoc);
+   const size_t offset = ffRowSize(col0);
+   size_t n = ffRowSize(blk->noc);
+   if (n > destRowSize - offset) {
+      n = destRowSize - offset;
+   }
+   char* d = (char*) ffGetPtr(dest, row0, destNoc) + offset;
+   PTR s = blk->data;
+   for (uint32_t i = row0; i < destNor && i < row0 + blk->nor; ++i) {
+      memcpy(d, s, n);
+      d += destRowSize;
+      ffStepPtr(&s, blk->noc);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Multiplies two blocks, returning a new matrix.
+
+static Matrix_t* mulBlocks(const Matrix_t* a, const Matrix_t* b)
+{
+   Matrix_t* c = matAlloc(ffOrder, a->nor, b->noc);
+   ffMulMatrix(c->data, a->data, b->data, a->nor, a->noc, b->noc);
+   return c;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One level of Strassen-Winograd multiplication (7 block multiplications, 15 block additions).
+// The factors are split into 2x2 blocks. If a dimension is odd or the column split does not
+// fall on a unit boundary, the blocks are padded with zeroes.
+
+static void mulStrassen(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB)
+{
+   const uint32_t align = colsPerUnit();
+   const uint32_t hm = (norA + 1) / 2;
+   const uint32_t hk = ((nocA + 1) / 2 + align - 1) / align * align;
+   const uint32_t hn = ((nocB + 1) / 2 + align - 1) / align * align;
+   const FEL minusOne = ffNeg(FF_ONE);
+
+   Matrix_t* a11 = getBlock(a, norA, nocA, 0, 0, hm, hk);
+   Matrix_t* a12 = getBlock(a, norA, nocA, 0, hk, hm, hk);
+   Matrix_t* a21 = getBlock(a, norA, nocA, hm, 0, hm, hk);
+   Matrix_t* a22 = getBlock(a, norA, nocA, hm, hk, hm, hk);
+   Matrix_t* b11 = getBlock(b, nocA, nocB, 0, 0, hk, hn);
+   Matrix_t* b12 = getBlock(b, nocA, nocB, 0, hn, hk, hn);
+   Matrix_t* b21 = getBlock(b, nocA, nocB, hk, 0, hk, hn);
+   Matrix_t* b22 = getBlock(b, nocA, nocB, hk, hn, hk, hn);
+
+   // S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2
+   Matrix_t* s1 = matAdd(matDup(a21), a22);
+   Matrix_t* s2 = matAddMul(matDup(s1), a11, minusOne);
+   Matrix_t* s3 = matAddMul(matDup(a11), a21, minusOne);
+   Matrix_t* s4 = matAddMul(matDup(a12), s2, minusOne);
+   matFree(a21);
+
+   // T1 = B12 - B11, T2 = B22 - T1, T3 = B22 - B12, T4 = T2 - B21
+   Matrix_t* t1 = matAddMul(matDup(b12), b11, minusOne);
+   Matrix_t* t2 = matAddMul(matDup(b22), t1, minusOne);
+   Matrix_t* t3 = matAddMul(matDup(b22), b12, minusOne);
+   Matrix_t* t4 = matAddMul(matDup(t2), b21, minusOne);
+   matFree(b12);
+
+   Matrix_t* p1 = mulBlocks(a11, b11);
+   Matrix_t* p2 = mulBlocks(a12, b21);
+   Matrix_t* p3 = mulBlocks(s4, b22);
+   Matrix_t* p4 = mulBlocks(a22, t4);
+   Matrix_t* p5 = mulBlocks(s1, t1);
+   Matrix_t* p6 = mulBlocks(s2, t2);
+   Matrix_t* p7 = mulBlocks(s3, t3);
+   matFree(a11);
+   matFree(a12);
+   matFree(a22);
+   matFree(b11);
+   matFree(b21);
+   matFree(b22);
+   matFree(s1);
+   matFree(s2);
+   matFree(s3);
+   matFree(s4);
+   matFree(t1);
+   matFree(t2);
+   matFree(t3);
+   matFree(t4);
+
+   matAdd(p2, p1);                      // C11 = P1 + P2
+   matAdd(p6, p1);                      // U2 = P1 + P6
+   matAdd(p7, p6);                      // U3 = U2 + P7
+   matAdd(p6, p5);                      // U4 = U2 + P5
+   matAdd(p6, p3);                      // C12 = U4 + P3
+   matAdd(p5, p7);                      // C22 = U3 + P5
+   matAddMul(p7, p4, minusOne);         // C21 = U3 - P4
+
+   putBlock(result, norA, nocB, 0, 0, p2);
+   putBlock(result, norA, nocB, 0, hn, p6);
+   putBlock(result, norA, nocB, hm, 0, p7);
+   putBlock(result, norA, nocB, hm, hn, p5);
+
+   matFree(p1);
+   matFree(p2);
+   matFree(p3);
+   matFree(p4);
+   matFree(p5);
+   matFree(p6);
+   matFree(p7);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the cache size used for blocking, see ffMulCacheSize.
+
+static size_t cacheSize()
+{
+   return ffMulCacheSize > 0 ? ffMulCacheSize : sysCacheSize();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Row-by-row multiplication with cache blocking. The rows of the right factor are processed in
+// tiles that fit into the L2 cache, and each tile is applied to a panel of result rows before
+// moving on to the next tile. Tiles start at a unit boundary, so the corresponding part of a
+// row of «a» can be passed to ffMapRow() directly.
+
+static void mulTiled(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB)
+{
+   const size_t cache = cacheSize();
+   const size_t rowSize = ffRowSize(nocB);
+   const uint32_t align = colsPerUnit();
+   uint32_t tile = (uint32_t)(cache / 2 / rowSize) / align * align;
+   if (tile < align) {
+      tile = align;
+   }
+   uint32_t panel = (uint32_t)(cache / 4 / rowSize);
+   if (panel < 1) {
+      panel = 1;
+   }
+   const uint64_t startTime = sysTime();
+
+   PTR tmp = ffAlloc(1, nocB);
+   for (uint32_t i0 = 0; i0 < norA; i0 += panel) {
+      const uint32_t np = (norA - i0 < panel) ? norA - i0 : panel;
+      for (uint32_t j0 = 0; j0 < nocA; j0 += tile) {
+         const uint32_t nt = (nocA - j0 < tile) ? nocA - j0 : tile;
+         PTR bt = ffGetPtr(b, j0, nocB);
+         PTR x = ffGetPtr(a, i0, nocA);
+         PTR y = ffGetPtr(result, i0, nocB);
+         for (uint32_t i = 0; i < np; ++i) {
+            PTR xt = (PTR)((char*) x + ffRowSize(j0));
+            if (j0 == 0) {
+               ffMapRow(y, xt, bt, nt, nocB);
+            } else {
+               ffMapRow(tmp, xt, bt, nt, nocB);
+               ffAddRow(y, tmp, nocB);
+            }
+            ffStepPtr(&x, nocA);
+            ffStepPtr(&y, nocB);
+         }
+      }
+   }
+   ffFree(tmp);
+
+   if (logEnabled(MTX_LOG_DEBUG)) {
+      const uint64_t elapsed = sysTime() - startTime;
+      const double mBytes = (double) norA * ffSize(nocA, nocB) / 1e6;
+      MTX_LOGD("ffMulMatrix: %lux%lux%lu, tile=%lu rows, panel=%lu rows, %.0f MB/s",
+            (unsigned long) norA, (unsigned long) nocA, (unsigned long) nocB,
+            (unsigned long) tile, (unsigned long) panel,
+            elapsed > 0 ? mBytes * 1000 / elapsed : 0.0);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Multiplies without Strassen-Winograd splitting and without multithreading, see ffMulMatrix().
+
+static void mulSerial(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB)
+{
+   const int k = greaseLevel(norA, nocA);
+   if (k > 0) {
+      PTR y = result;
+      for (uint32_t i = 0; i < norA; ++i) {
+         ffMulRow(y, FF_ZERO, nocB);
+         ffStepPtr(&y, nocB);
+      }
+      mulGreased(result, a, b, norA, nocA, nocB, k);
+   } else if (ffSize(nocA, nocB) > (ssize_t) cacheSize() && norA > 1) {
+      mulTiled(result, a, b, norA, nocA, nocB);
+   } else {
+      PTR x = a;
+      PTR y = result;
+      for (uint32_t i = 0; i < norA; ++i) {
+         ffMapRow(y, x, b, nocA, nocB);
+         ffStepPtr(&x, nocA);
+         ffStepPtr(&y, nocB);
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @private
+typedef struct {
+   PTR result;
+   PTR a;
+   PTR b;
+   uint32_t nocA;
+   uint32_t nocB;
+} MulTask_t;
+
+// Task function for mulParallel(): calculates result rows «begin»,...,«end»-1.
+
+static void mulTask(void* userData, size_t begin, size_t end)
+{
+   const MulTask_t* t = (const MulTask_t*) userData;
+   mulSerial(ffGetPtr(t->result, begin, t->nocB), ffGetPtr(t->a, begin, t->nocA), t->b,
+         (uint32_t) (end - begin), t->nocA, t->nocB);
+}
+
+// Splits the result into blocks of rows and calculates them in parallel (see pexExecuteRange()).
+// The calling thread calculates the last block. Returns 0 without doing anything if the product
+// is too small, if there is no thread pool, or if the function is called in a worker thread,
+// where waiting for nested tasks could block all workers.
+
+static int mulParallel(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB)
+{
+   const int nThreads = pexPoolSize();
+   if (nThreads == 0 || norA < 2 * PARALLEL_MIN_ROWS
+         || (uint64_t) norA * nocA * nocB < PARALLEL_MIN_WORK || pexThreadNumber() != 0) {
+      return 0;
+   }
+   uint32_t nParts = (uint32_t) nThreads + 1;
+   if (nParts > norA / PARALLEL_MIN_ROWS) {
+      nParts = norA / PARALLEL_MIN_ROWS;
+   }
+
+   MulTask_t t = {.result = result, .a = a, .b = b, .nocA = nocA, .nocB = nocB};
+   PexGroup_t* group = pexCreateGroup();
+   uint32_t begin = 0;
+   for (uint32_t k = 1; k < nParts; ++k) {
+      const uint32_t end = (uint32_t) ((uint64_t) norA * k / nParts);
+      pexExecuteRange(group, mulTask, &t, begin, end);
+      begin = end;
+   }
+   mulTask(&t, begin, norA);
+   pexWait(group);
+   return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Multiplies two matrices given as row buffers.
+/// This is the low-level engine behind matMul(). It multiplies the @p norA by @p nocA matrix
+/// @p a from the right by the @p nocA by @p nocB matrix @p b and stores the product into
+/// @p result, which must have room for @p norA rows of size @p nocB. @p result must not
+/// overlap with either factor.
+///
+/// Depending on the field and matrix size, the function selects either the row-by-row method
+/// (one ffMapRow() call per row of @p a) or greased multiplication, where linear combinations
+/// of several rows of @p b are precomputed. If @p b does not fit into the L2 cache, the row-by-row
+/// method processes @p b in cache-sized tiles (see @ref ffMulCacheSize). Large matrices are first
+/// split recursively with the Strassen-Winograd algorithm, see @ref ffStrassenCutoff.
+///
+/// If the thread pool is active (see pexInit() and the "-j" option), large products are split into
+/// blocks of rows which are calculated in parallel. The result does not depend on the number of
+/// threads.
+///
+/// The field must have been selected with ffSetField() before calling this function.
+
+void ffMulMatrix(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB)
+{
+   const uint32_t cutoff = ffStrassenCutoff;
+   if (cutoff > 0 && norA >= cutoff && nocA >= cutoff && nocB >= cutoff) {
+      mulStrassen(result, a, b, norA, nocA, nocB);
+      return;
+   }
+   if (!mulParallel(result, a, b, norA, nocA, nocB)) {
+      mulSerial(result, a, b, norA, nocA, nocB);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// Multiply matrices
 /// This function multiplies @em dest from the right by @em src.
@@ -19,15 +479,14 @@
 /// number of rows of @em src.
 /// The result of the multiplication is stored in @em dest, overwriting the
 /// original contents.
-/// @see matPower()
+/// @see matMulInto() matPower() ffMulMatrix()
 /// @param dest Left factor and result.
 /// @param src Right factor.
 /// @return The function returns @em dest.
 
 Matrix_t *matMul(Matrix_t *dest, const Matrix_t *src)
 {
-   PTR x, tmp, result;
-   long i;
+   PTR result;
 
    // check arguments
 #ifdef MTX_DEBUG
@@ -42,14 +501,9 @@ Matrix_t *matMul(Matrix_t *dest, const Matrix_t *src)
 
    // matrix multiplication
    ffSetField(src->field);
-   result = tmp = ffAlloc(dest->nor, src->noc);
-   x = dest->data;
-   for (i = 0; i < dest->nor; ++i) {
-      ffMapRow(tmp, x,src->data,src->nor,src->noc);
-      ffStepPtr(&tmp, src->noc);
-      ffStepPtr(&x, dest->noc);
-   }
-   sysFree(dest->data);
+   result = ffAlloc(dest->nor, src->noc);
+   ffMulMatrix(result, dest->data, src->data, dest->nor, dest->noc, src->noc);
+   ffFreeRows(dest->data, dest->nor, dest->noc);
    dest->data = result;
    dest->noc = src->noc;
 
@@ -58,6 +512,39 @@ Matrix_t *matMul(Matrix_t *dest, const Matrix_t *src)
    return dest;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Multiply matrices into a given destination.
+/// This function calculates the product @em a·@em b and stores it in @em result. Unlike
+/// matMul(), it does not allocate a new row buffer if @em result already has the dimensions of the
+/// product. This allows to reuse the same destination matrix in a loop without allocating memory
+/// in each iteration.
+///
+/// If @em result is NULL, a new matrix is created. Otherwise, @em result is resized if necessary
+/// and its previous contents are lost. @em result must not be one of the factors.
+///
+/// @see matMul()
+/// @param result Destination matrix or NULL.
+/// @param a Left factor.
+/// @param b Right factor.
+/// @return The product. This is @em result if it was not NULL.
+
+Matrix_t *matMulInto(Matrix_t *result, const Matrix_t *a, const Matrix_t *b)
+{
+   matValidate(MTX_HERE, a);
+   matValidate(MTX_HERE, b);
+   if ((a->field != b->field) || (a->noc != b->nor)) {
+      mtxAbort(MTX_HERE,"Can't multiply %dx%d/GF(%d) by %dx%d/GF(%d): %s",
+                 a->nor,a->noc,a->field,b->nor,b->noc,b->field,MTX_ERR_INCOMPAT);
+   }
+   if (result == a || result == b) {
+      mtxAbort(MTX_HERE,"Destination overlaps a factor: %s",MTX_ERR_BADARG);
+   }
+
+   result = mat_Prepare(result, a->field, a->nor, b->noc);
+   ffMulMatrix(result->data, a->data, b->data, a->nor, a->noc, b->noc);
+   return result;
+}
+
 /// @}
 
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
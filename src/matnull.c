@@ -19,26 +19,24 @@ static uint32_t zmkechelon(PTR matrix, uint32_t nor, uint32_t noc, uint32_t *piv
       ispiv[i] = 0;
    }
 
-   // Echelonize the matrix and build the pivot table in <piv>.
-   // Keep track of assigned pivot columns in <ispiv>.
+   // Echelonize the matrix (see ffPleDecompose()) and move the nonzero rows to the top. Build
+   // the pivot table in <piv> and keep track of assigned pivot columns in <ispiv>.
+   uint32_t *rowPiv = NALLOC(uint32_t, nor);
+   const uint32_t rank = ffPleDecompose(matrix, nor, noc, NULL, 0, rowPiv, 0);
    PTR x = matrix;
-   uint32_t rank = 0;
    PTR newrow = matrix;
-   newrow = matrix;
-   for (i = 0, x = matrix; i < nor && rank < noc; ++i, ffStepPtr(&x, noc)) {
-      if (rank < i) {
-         ffCopyRow(newrow,x, noc);
-      }
-      ffCleanRow(newrow,matrix,rank,noc,piv);
-      FEL f;
-      uint32_t newpiv = ffFindPivot(newrow,&f, noc);
-      if (newpiv != MTX_NVAL) {
-         piv[rank] = newpiv;
-         ispiv[newpiv] = 1;
-         ++rank;
+   uint32_t k = 0;
+   for (i = 0; i < nor && k < rank; ++i, ffStepPtr(&x, noc)) {
+      if (rowPiv[i] != MTX_NVAL) {
+         if (newrow != x) {
+            ffCopyRow(newrow, x, noc);
+         }
+         piv[k++] = rowPiv[i];
+         ispiv[rowPiv[i]] = 1;
          ffStepPtr(&newrow, noc);
       }
    }
+   sysFree(rowPiv);
 
    // Insert the non-pivot columns
    uint32_t j = rank;
@@ -124,6 +122,58 @@ uint32_t matNullity__(Matrix_t *mat)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Nullity of a matrix.
+/// This function calculates the dimension of the null-space of a matrix. Unlike matNullity__(),
+/// the matrix is not deleted, but its contents are destroyed. The row buffer is kept, so the
+/// matrix can be reused as destination of another operation, for example matInsertInto():
+/// @code
+/// Matrix_t* tmp = NULL;
+/// for (...) {
+///    tmp = matInsertInto(tmp, word, pol);
+///    nul = matNullity_(tmp);
+/// }
+/// matFree(tmp);
+/// @endcode
+/// @param mat Pointer to the matrix.
+/// @return Nullity of @em mat.
+
+uint32_t matNullity_(Matrix_t *mat)
+{
+   matValidate(MTX_HERE, mat);
+   mat_DeletePivotTable(mat);
+   ffSetField(mat->field);
+   uint32_t *rowPiv = NALLOC(uint32_t, mat->nor);
+   const uint32_t rank = ffPleDecompose(mat->data, mat->nor, mat->noc, NULL, 0, rowPiv, 0);
+   sysFree(rowPiv);
+   return mat->noc - rank;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Bounded nullity of a matrix.
+/// This function calculates the nullity of a matrix if it is at most @em k. The elimination
+/// stops as soon as the number of dependent rows proves that the nullity is greater than @em k,
+/// see ffPleRank(). This is much faster than matNullity() when the nullity is large, for example
+/// when testing candidates for peak words. The matrix is neither copied nor modified.
+/// @param mat Pointer to the matrix.
+/// @param k Upper bound.
+/// @return Nullity of @em mat if it is at most @em k, otherwise @em k+1.
+
+uint32_t matNullityAtMost(const Matrix_t *mat, uint32_t k)
+{
+   matValidate(MTX_HERE, mat);
+
+   // The nullity is at least noc - nor.
+   if (mat->noc > mat->nor && mat->noc - mat->nor > k) {
+      return k + 1;
+   }
+   ffSetField(mat->field);
+   const uint32_t rank = ffPleRank(mat->data, mat->nor, mat->noc, k + mat->nor - mat->noc);
+   return rank == MTX_NVAL ? k + 1 : mat->noc - rank;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 static int zmkpivot(PTR matrix, uint32_t nor, uint32_t noc, uint32_t *piv, uint8_t *ispiv)
 {
    // Extract the pivot columns to «piv».
@@ -188,7 +238,6 @@ void matPivotize(Matrix_t *mat)
 static long znullsp(PTR matrix, int nor, int noc, uint32_t *piv, PTR nsp, int flags)
 {
    PTR x, y, a, b;
-   FEL f;
 
    // initialize result with identity
    x = nsp;
@@ -199,28 +248,10 @@ static long znullsp(PTR matrix, int nor, int noc, uint32_t *piv, PTR nsp, int fl
       ffStepPtr(&x, nor);
    }
 
-   // gaussian elimination
-   x = matrix;
-   y = nsp;
-   for (uint32_t i = 0; i < nor; ++i) {
-      PTR xx = matrix, yy = nsp;
-      uint32_t k, p;
-
-      for (k = 0; k < i; ++k) {
-         if (((p = piv[k]) != MTX_NVAL) && ((f = ffExtract(x,p)) != FF_ZERO)) {
-            f = ffNeg(ffDiv(f,ffExtract(xx,p)));
-            ffAddMulRow(x,xx,f, noc);
-            ffAddMulRow(y,yy,f, nor);
-         }
-         ffStepPtr(&xx, noc);
-         ffStepPtr(&yy, nor);
-      }
-      piv[i] = p = ffFindPivot(x,&f, noc);
-      ffStepPtr(&x, noc);
-      ffStepPtr(&y, nor);
-   }
+   // gaussian elimination, applying the same row operations to «nsp»
+   ffPleDecompose(matrix, nor, noc, nsp, nor, piv, 0);
 
-   // step 2: reduce the null space to echelon form.
+   // step 2: collect the null space and reduce it to echelon form.
    uint32_t dim = 0;
    x = y = nsp;
    a = b = matrix;
@@ -228,12 +259,7 @@ static long znullsp(PTR matrix, int nor, int noc, uint32_t *piv, PTR nsp, int fl
       if (piv[i] == MTX_NVAL) {
          if (y != x) 
             ffCopyRow(y,x, nor);
-         if (flags) {
-            ++dim;
-         } else {
-            ffCleanRow(y,nsp, dim, nor, piv);
-            piv[dim++] = ffFindPivot(y,&f, nor);
-         }
+         ++dim;
          ffStepPtr(&y, nor);
       } else {
          if (b != a) 
@@ -243,6 +269,9 @@ static long znullsp(PTR matrix, int nor, int noc, uint32_t *piv, PTR nsp, int fl
       ffStepPtr(&x, nor);
       ffStepPtr(&a, noc);
    }
+   if (!flags) {
+      ffPleDecompose(nsp, dim, nor, NULL, 0, piv, 0);
+   }
 
    return dim;
 }
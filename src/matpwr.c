@@ -18,13 +18,11 @@
 /// @param n The exponent.
 /// @param inp Input matrix (dim x dim)
 /// @param out Output matrix (dim x dim)
-/// @param tmp2 Workspace (1xdim)
+/// @param tmp2 Workspace (dim x dim)
 /// @param dim Matrix size
 
 static void matpwr_(long n, PTR inp, PTR out, PTR tmp2, int dim)
 {
-   PTR x, y;
-   long i;
    int first = 1;
 
    while (n > 0) {
@@ -33,24 +31,14 @@ static void matpwr_(long n, PTR inp, PTR out, PTR tmp2, int dim)
             memcpy(out,inp,ffSize(dim, dim));
             first = 0;
          } else {
-            x = out;
-            for (i = 0; i < dim; ++i) {
-               ffMapRow(tmp2, x,inp,dim,dim);
-               ffCopyRow(x,tmp2, dim);
-               ffStepPtr(&x, dim);
-            }
+            ffMulMatrix(tmp2, out, inp, dim, dim, dim);
+            memcpy(out,tmp2,ffSize(dim, dim));
          }
       }
       if (n == 1) {
          break;
       }
-      x = inp;
-      y = tmp2;
-      for (i = 0; i < dim; ++i) {
-         ffMapRow(y, x,inp,dim, dim);
-         ffStepPtr(&x, dim);
-         ffStepPtr(&y, dim);
-      }
+      ffMulMatrix(tmp2, inp, inp, dim, dim, dim);
       memcpy(inp,tmp2,ffSize(dim, dim));
       n /= 2;
    }
@@ -69,48 +57,63 @@ static void matpwr_(long n, PTR inp, PTR out, PTR tmp2, int dim)
 /// Negative exponents are not allowed. To calculate a negative power, you
 /// must first invert the matrix with matInverse() and then call matPower()
 /// with the inverted matrix and a positive exponent.
+/// @see matPowerInto()
 /// @param mat Pointer to the matrix.
 /// @param n Exponent.
 /// @return n-th power of mat, or NULL on error.
 
 Matrix_t *matPower(const Matrix_t *mat, long n)
 {
-   Matrix_t *result;
-   PTR tmp, tmp2;
+   return matPowerInto(NULL, mat, n);
+}
 
-   /* Check the arguments
-      ------------------- */
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Power of a matrix into a given destination.
+/// This function works like matPower() but stores the result in @p result. If @p result is NULL,
+/// a new matrix is created. Otherwise, @p result is resized if necessary and its previous contents
+/// are lost. @p result must not be the same matrix as @p mat. The temporary buffers are released
+/// with ffFreeRows(), so repeated calls with the same dimensions do not allocate new memory.
+/// @param result Destination matrix or NULL.
+/// @param mat Pointer to the matrix.
+/// @param n Exponent.
+/// @return n-th power of mat. This is @p result if it was not NULL.
+
+Matrix_t *matPowerInto(Matrix_t *result, const Matrix_t *mat, long n)
+{
+   // Check the arguments
    matValidate(MTX_HERE, mat);
    if (mat->nor != mat->noc) {
       mtxAbort(MTX_HERE,"matPower(): %s",MTX_ERR_NOTSQUARE);
       return NULL;
    }
+   if (n < 0) {
+      mtxAbort(MTX_HERE,"Negative exponent %ld: %s",n,MTX_ERR_BADARG);
+   }
+   if (result == mat) {
+      mtxAbort(MTX_HERE,"Destination overlaps the argument: %s",MTX_ERR_BADARG);
+   }
+   const uint32_t dim = mat->noc;
+   result = mat_Prepare(result, mat->field, dim, dim);
 
-   /* Handle special cases n = 0 and n = 1
-      ------------------------------------ */
+   // Handle special cases n = 0 and n = 1
    if (n == 0) {
-      return matId(mat->field,mat->nor);
+      PTR x = result->data;
+      for (uint32_t i = 0; i < dim; ++i, ffStepPtr(&x, dim)) {
+         ffMulRow(x, FF_ZERO, dim);
+         ffInsert(x, i, FF_ONE);
+      }
+      return result;
    } else if (n == 1) {
-      return matDup(mat);
+      memcpy(result->data,mat->data,ffSize(dim, dim));
+      return result;
    }
 
-   ffSetField(mat->field);
-   tmp = ffAlloc(mat->noc, mat->noc);
-   if (tmp == NULL) {
-       return NULL;
-   }
-   memcpy(tmp,mat->data,ffSize(mat->noc, mat->noc));
-   tmp2 = ffAlloc(mat->noc, mat->noc);
-   if (tmp2 == NULL) {
-       sysFree(tmp);
-       return NULL;
-   }
-   result = matAlloc(mat->field,mat->nor,mat->noc);
-   if (result != NULL) {
-      matpwr_(n, tmp, result->data, tmp2, mat->noc);
-   }
-   sysFree(tmp);
-   sysFree(tmp2);
+   PTR tmp = ffAlloc(dim, dim);
+   memcpy(tmp,mat->data,ffSize(dim, dim));
+   PTR tmp2 = ffAlloc(dim, dim);
+   matpwr_(n, tmp, result->data, tmp2, dim);
+   ffFreeRows(tmp, dim, dim);
+   ffFreeRows(tmp2, dim, dim);
    return result;
 }
 
@@ -24,6 +24,15 @@
 #define MTX_PRINTF(f,v)
 #endif
 
+// Storage class for per-thread data.
+#if !defined(MTX_DEFAULT_THREADS)
+#define MTX_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define MTX_THREAD_LOCAL __declspec(thread)
+#else
+#define MTX_THREAD_LOCAL __thread
+#endif
+
 enum MtxObjectType {
    MTX_TYPE_PERMUTATION = 0xFFFFFFFF,
    MTX_TYPE_POLYNOMIAL = 0xFFFFFFFE,
@@ -58,8 +67,12 @@ void mmRollback(uint32_t checkpoint);
 /// @addtogroup os
 /// @{
 
+size_t sysCacheSize();
+int sysCommitFile(FILE* f, char* tempName);
+int sysCpuCount();
 int sysCreateDirectory(const char* name);
 FILE* sysFopen(const char* name, const char*mode);
+FILE* sysFopenTemp(const char* name, const char* mode, char** tempName);
 void sysFree(void* x);
 int sysFseek(FILE *f, long pos);
 int sysFseekRelative(FILE *file, long distance);
@@ -67,6 +80,7 @@ const char* sysGetExecutableName(const char* argv0);
 int sysGetPid();
 void sysInit(void);
 void* sysMalloc(size_t nbytes);
+const void* sysMapFile(const char* name, const char* mode, size_t* size);
 size_t sysPad(size_t x, size_t unit);
 void sysRead16(FILE *f, void* buf, size_t n);
 void sysRead32(FILE *f, void* buf, size_t n);
@@ -97,13 +111,22 @@ void sysWrite8(FILE *f, const void* buf, size_t n);
 typedef struct PexGroup PexGroup_t;
 
 struct ErrorContextStack* pexContextStack();
+void pexCancel(PexGroup_t* group);
 PexGroup_t* pexCreateGroup();
 void pexExecute(PexGroup_t* group, void (*f)(void* userData), void* userData);
 void pexExecuteRange(PexGroup_t* group, void (*f)(void* userData, size_t begin, size_t end),
 	void* userData, size_t begin, size_t end);
 //void pexFinally(PexGroup_t* group, void(*f)(void* userData), void* userData);
 void pexInit(int nThreads);
+int pexIsCancelled();
 const char* pexLogPrefix();
+size_t pexParallelFindFirst(size_t begin, size_t end, size_t grain,
+      int (*predicate)(void* userData, size_t i), void* userData);
+void pexParallelFor(size_t begin, size_t end, size_t grain,
+      void (*body)(void* userData, size_t begin, size_t end), void* userData);
+uint64_t pexParallelMin(size_t begin, size_t end, size_t grain,
+      uint64_t (*body)(void* userData, size_t begin, size_t end), void* userData);
+void pexPinThreads(int enable);
 int pexPoolSize();
 MTX_PRINTF(1,2)
 void pexSetThreadName(const char* name, ...);
@@ -123,7 +146,7 @@ void pexWait(PexGroup_t* group);
 /// @addtogroup ff
 /// @{
 
-#if MTX_ZZZ == 0
+#if MTX_ZZZ == 0 || MTX_ZZZ == 2
 
 typedef uint8_t FEL;            ///< A finite field element
 typedef FEL *PTR;               ///< A pointer to a row vector
@@ -262,9 +285,13 @@ void mfWrite8(MtxFile_t* file, const void* buf, size_t count);
 /// @addtogroup ff
 /// @{
 
-extern uint32_t ffOrder;        // Current field order
-extern int ffChar;              // Current field characteristic
-extern FEL ffGen;               // Generator for the current field.
+// The current field is a per-thread setting, see ffSetField().
+extern MTX_THREAD_LOCAL uint32_t ffOrder;        // Current field order
+extern MTX_THREAD_LOCAL int ffChar;              // Current field characteristic
+extern MTX_THREAD_LOCAL FEL ffGen;               // Generator for the current field.
+
+/// Field context (arithmetic tables and row layout for one field), see ffContext().
+typedef struct FfContext FfContext_t;
 
 /// An invalid value. Used in places where a row/colum index is expected to signal that no value
 /// is avalable.
@@ -293,7 +320,9 @@ FEL ffEmbed(FEL a, int subfield);
 void ffExtractColumn(PTR mat,int nor,int noc,int col,PTR result);
 FEL ffExtract(PTR row, int col);
 uint32_t ffFindPivot(PTR row, FEL *mark, int noc);
+void ffFlushRowCache();
 void ffFree(PTR x);
+void ffFreeRows(PTR x, int nor, int noc);
 FEL ffFromInt(int l);
 PTR ffGetPtr(PTR base, int row, int noc);
 int ffMakeTables(int field);
@@ -304,6 +333,9 @@ size_t ffRowSize(uint32_t noc);
 size_t ffRowSizeUsed(int noc);
 FEL ffScalarProduct(PTR a, PTR b, int noc);
 void ffSetField(int field);
+const FfContext_t* ffContext(int field);
+const FfContext_t* ffCurrentContext();
+void ffBindContext(const FfContext_t* context);
 ssize_t ffSize(uint32_t nor, uint32_t noc);
 void ffStepPtr(PTR *x, int noc);
 void ffSwapRows(PTR dest, PTR src, int noc);
@@ -311,23 +343,33 @@ int ffToInt(FEL f);
 void ffWriteRows(MtxFile_t* file, PTR buf, uint32_t nor, uint32_t noc);
 
 /// List of subfield orders, terminated with 0.
-extern int mtx_subfields[17];
+extern MTX_THREAD_LOCAL int mtx_subfields[17];
+#if MTX_ZZZ == 1
+/// 1 if rows of the current field contain integers instead of logarithms, see ffPackRow().
+extern MTX_THREAD_LOCAL int mtx_linearRows;
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Macro versions of kernel functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#if MTX_ZZZ == 0
+#if MTX_ZZZ == 0 || MTX_ZZZ == 2
+
+// Arithmetic tables. They point into the table file, which is mapped read-only.
+extern MTX_THREAD_LOCAL const FEL (*mtx_tmult)[256];
+extern MTX_THREAD_LOCAL const FEL (*mtx_tadd)[256];
+extern MTX_THREAD_LOCAL const FEL *mtx_taddinv, *mtx_tmultinv;
+extern MTX_THREAD_LOCAL const FEL (*mtx_tffirst)[2];
+extern MTX_THREAD_LOCAL const FEL (*mtx_textract)[256];
+extern MTX_THREAD_LOCAL const FEL (*mtx_tnull)[256];
+extern MTX_THREAD_LOCAL const FEL (*mtx_tinsert)[256];
+extern MTX_THREAD_LOCAL const FEL (*mtx_embed)[MTX_MAXSUBFIELDORD];
+extern MTX_THREAD_LOCAL const FEL (*mtx_restrict)[256];
 
-extern FEL mtx_tmult[256][256];
-extern FEL mtx_tadd[256][256];
-extern FEL mtx_taddinv[256], mtx_tmultinv[256];
-extern FEL mtx_tffirst[256][2];
-extern FEL mtx_textract[8][256];
-extern FEL mtx_tnull[8][256];
-extern FEL mtx_tinsert[8][256];
-extern FEL mtx_embed[4][16];
-extern FEL mtx_restrict[4][256];
+// Kernel specific part of a field context, used by ffContext() and ffBindContext().
+const void* ffCreateRowLayout(uint32_t order, int characteristic, int mpb,
+                              const FEL (*tmult)[256]);
+void ffBindRowLayout(const void* layout);
 
 #define ffAdd(a,b) ((FEL)mtx_tadd[(uint8_t)a][(uint8_t)b])
 #define ffDiv(a,b) ffMul((a),ffInv(b))
@@ -340,13 +382,21 @@ void ffInsert(PTR row, int col, FEL mark);
 
 #elif MTX_ZZZ == 1
 
-#define ffExtract(row,col) ((FEL)((row)[col]))
-#define ffInsert(row,col,mark) ((void)((row)[col] = mark))
+void ffInsert(PTR row, int col, FEL mark);
 
 #else
    #error Illegal value of MTX_ZZZ
 #endif
 
+#if MTX_ZZZ == 0 || MTX_ZZZ == 1
+const char* ffSelectSimd();
+#endif
+
+#if MTX_ZZZ == 1 || MTX_ZZZ == 2
+void ffPackRow(uint8_t* buf, PTR row, uint32_t noc);
+void ffUnpackRow(PTR row, const uint8_t* buf, uint32_t noc);
+#endif
+
 /// @}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -354,6 +404,13 @@ void ffInsert(PTR row, int col, FEL mark);
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void ffMapRow(PTR result, PTR row, PTR matrix, int nor, int noc);
+void ffMulMatrix(PTR result, PTR a, PTR b, uint32_t norA, uint32_t nocA, uint32_t nocB);
+extern uint32_t ffStrassenCutoff;
+extern size_t ffMulCacheSize;
+#define FF_PLE_REDUCE 0x01
+uint32_t ffPleDecompose(
+      PTR a, uint32_t nor, uint32_t noc, PTR t, uint32_t noct, uint32_t* rowPiv, int flags);
+uint32_t ffPleRank(PTR a, uint32_t nor, uint32_t noc, uint32_t maxDependent);
 void ffPermRow(PTR result, PTR row, const uint32_t* perm, int noc);
 int ffSumAndIntersection(int noc, PTR wrk1, uint32_t* nor1, uint32_t* nor2, PTR wrk2, uint32_t* piv);
 
@@ -464,10 +521,13 @@ int appGetArguments(MtxApplication_t* app, int min_argc, int max_argc);
 #if defined(MTX_DEFAULT_THREADS)
    #define MTX_THREAD_OPTION_DESCRIPTION \
       "    -j <n> .................. Parallel execution on <n> CPU cores (default: "\
-        STRINGIFY(MTX_DEFAULT_THREADS) ")\n"
+        STRINGIFY(MTX_DEFAULT_THREADS) ")\n" \
+      "                              \"auto\" uses all available CPUs (affinity, cgroup quota)\n" \
+      "    --pin ................... Pin threads to CPUs\n"
 #else
    #define MTX_THREAD_OPTION_DESCRIPTION \
-      "    -j <n> .................. Ignored (threading support is disabled)\n"
+      "    -j <n> .................. Ignored (threading support is disabled)\n" \
+      "    --pin ................... Ignored (threading support is disabled)\n"
 #endif
 
 #define MTX_COMMON_OPTIONS_DESCRIPTION \
@@ -615,11 +675,15 @@ void matFree(Matrix_t* mat);
 PTR matGetPtr(const Matrix_t* mat, uint32_t row);
 Matrix_t* matId(int fl, uint32_t nor);
 Matrix_t* matInverse(const Matrix_t* src);
+Matrix_t* matInverseInto(Matrix_t* result, const Matrix_t* src);
 int matIsValid(const Matrix_t* m);
 Matrix_t* matLoad(const char* fn);
 Matrix_t* matMul(Matrix_t* dest, const Matrix_t* src);
+Matrix_t* matMulInto(Matrix_t* result, const Matrix_t* a, const Matrix_t* b);
 Matrix_t* matMulScalar(Matrix_t* dest, FEL coeff);
 uint32_t matNullity(const Matrix_t* mat);
+uint32_t matNullity_(Matrix_t* mat);
+uint32_t matNullityAtMost(const Matrix_t* mat, uint32_t k);
 uint32_t matNullity__(Matrix_t* mat);
 Matrix_t* matNullSpace(const Matrix_t* mat);
 Matrix_t* matNullSpace_(Matrix_t* mat, int flags);
@@ -627,6 +691,7 @@ Matrix_t* matNullSpace__(Matrix_t* mat);
 int matOrder(const Matrix_t* mat);
 void matPivotize(Matrix_t* mat);
 Matrix_t* matPower(const Matrix_t* mat, long n);
+Matrix_t* matPowerInto(Matrix_t* result, const Matrix_t* mat, long n);
 void matPrint(const char* name, const Matrix_t* m);
 Matrix_t* matReadData(MtxFile_t* f);
 void matSave(const Matrix_t* mat, const char* fn);
@@ -637,6 +702,7 @@ void matWrite(const Matrix_t* mat, MtxFile_t* file);
 
 /* For internal use only */
 void mat_DeletePivotTable(Matrix_t* mat);
+Matrix_t* mat_Prepare(Matrix_t* dest, int field, uint32_t nor, uint32_t noc);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Permutations
@@ -709,6 +775,9 @@ void polSave(const Poly_t* pol, const char* fn);
 char* polToEphemeralString(const Poly_t* p);
 void polValidate(const struct MtxSourceLocation* sl, const Poly_t* p);
 void polWrite(const Poly_t* p, MtxFile_t* file);
+extern uint32_t polKaratsubaCutoff;
+extern uint32_t polNewtonCutoff;
+extern uint32_t polHalfGcdCutoff;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factored polynomials
@@ -872,6 +941,7 @@ int* wgDescribeWord(WgData_t* b, uint32_t n);
 int wgFree(WgData_t* b);
 Matrix_t* wgMakeWord(WgData_t* b, uint32_t n);
 Matrix_t* wgMakeWord2(WgData_t* b, uint32_t n);
+Matrix_t* wgMakeWordInto(Matrix_t* result, WgData_t* b, uint32_t n);
 void wgMakeFingerPrint(WgData_t* b, uint32_t fp[6]);
 const char* wgSymbolicName(WgData_t* b, long n);
 
@@ -927,6 +997,11 @@ int svgMakeNext(PTR vec, uint32_t* number, const Matrix_t* basis);
 
 Matrix_t* matInsert_(Matrix_t* mat, const Poly_t* pol);
 Matrix_t* matInsert(const Matrix_t* mat, const Poly_t* pol);
+Matrix_t* matInsertInto(Matrix_t* result, const Matrix_t* mat, const Poly_t* pol);
+typedef struct MatPowers MatPowers_t;
+MatPowers_t* matPowersAlloc(const Matrix_t* mat);
+void matPowersFree(MatPowers_t* pw);
+Matrix_t* matInsertPowers(Matrix_t* result, MatPowers_t* pw, const Poly_t* pol);
 int IsSubspace(const Matrix_t* sub, const Matrix_t* space, int ngen);
 
 Matrix_t* matTensor(const Matrix_t* m1, const Matrix_t* m2);
@@ -938,10 +1013,11 @@ int StablePower(const Matrix_t* mat, int* pwr, Matrix_t **ker);
 int StablePower_(Matrix_t* mat, int* pwr, Matrix_t **ker);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// Polynomial factorization (Berlekamp algorithm)
+// Polynomial factorization (Berlekamp and Cantor-Zassenhaus algorithms)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 FPoly_t* Factorization(const Poly_t* pol);
+extern uint32_t polCantorZassenhausCutoff;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Characteristic and minimal polynomials
@@ -73,6 +73,8 @@ static int isValidFieldOrder(uint32_t x)
    static const uint32_t MTX_MAX_Q = 256;
    #elif MTX_ZZZ == 1
    static const uint32_t MTX_MAX_Q = 65536;
+   #elif MTX_ZZZ == 2
+   static const uint32_t MTX_MAX_Q = 16;
    #else
    #error
    #endif
@@ -222,11 +222,10 @@ static int isotype(int mnt)
 
 // Find all maximal submodules of sub[begin]..sub[end-1]
 // Sets sub[i]->isMountain and sub[i]->maxSubmodules
-static void findMaxTask(void* data, const size_t part, const size_t nParts)
+static void findMaxTask(void* data, const size_t begin, const size_t end)
 {
-   //MTX_LOGD("Start  task %lu/%lu", (unsigned long) part, (unsigned long) nParts);
    uint8_t* flag = NALLOC(uint8_t, nsub);   // 0=unknown, 1=maximal, 2=not maximal
-   for (unsigned topIndex = part; topIndex < nsub; topIndex += nParts) {
+   for (unsigned topIndex = begin; topIndex < end; ++topIndex) {
       struct Submodule* const top = sub[topIndex];
       unsigned nMaxSubmodules = 0;
       memset(flag, 0, sizeof(uint8_t) * topIndex);
@@ -264,22 +263,13 @@ static void findMaxTask(void* data, const size_t part, const size_t nParts)
    }
 
    sysFree(flag);
-   //MTX_LOGD("Done   task %lu/%lu", (unsigned long) part, (unsigned long) nParts);
-   //pexSleep(1000);
-   //MTX_LOGD("Exit   task %lu/%lu", (unsigned long) part, (unsigned long) nParts);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 static void findMaxSubmodules()
 {
-   size_t nParts = pexPoolSize() * 2 + 1;
-   PexGroup_t* grp = pexCreateGroup();
-   for (unsigned part = 0; part < nParts; ++part) {
-      //MTX_LOGD("Create task %lu/%lu", (unsigned long) part, (unsigned long) nParts);
-      pexExecuteRange(grp, findMaxTask, NULL, part, nParts);
-   }
-   pexWait(grp);
+   pexParallelFor(0, nsub, 1, findMaxTask, NULL);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -22,15 +22,68 @@ struct Object {
    uint32_t typeId;
 };
 
+// Live objects are kept in several lists (shards). The shard of an object is determined by its
+// address, so threads which allocate or free objects at the same time rarely need the same lock.
+
+#define MM_NSHARDS 64
+
+/// @private
+struct Shard {
 #if defined(MTX_DEFAULT_THREADS)
-static pthread_mutex_t listLock = PTHREAD_MUTEX_INITIALIZER;
+   pthread_mutex_t lock;
+#endif
+   struct Object* head;
+   size_t nObjs;
+   char padding[64];            // keep shards in separate cache lines
+};
+
+static struct Shard shards[MM_NSHARDS];
+static uint32_t sequenceCounter = 0;      // atomic
+
+/// @private
+struct RollbackEntry {
+   struct Object* obj;          // NULL if the object has been destroyed
+   uint32_t seq;
+};
+
+// Objects which are being destroyed by mmRollback() in the calling thread, sorted by sequence
+// number. mmFree() clears the entries of objects which are destroyed by their owner.
+static MTX_THREAD_LOCAL struct RollbackEntry* rollbackList = NULL;
+static MTX_THREAD_LOCAL size_t rollbackSize = 0;
+
+#if defined(MTX_DEFAULT_THREADS)
+static pthread_once_t initShardsOnce = PTHREAD_ONCE_INIT;
+
+static void initShards()
+{
+   for (int i = 0; i < MM_NSHARDS; ++i) {
+      pthread_mutex_init(&shards[i].lock, NULL);
+   }
+}
 #endif
-uint32_t sequenceCounter = 0;
-static struct Object *objsHead = NULL;
-static struct Object **objsTail = &objsHead;
-static struct Object *delHead = NULL;
-static struct Object **delTail = &delHead;
-static size_t nObjs = 0;
+
+static struct Shard* shardOf(const struct Object* obj)
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_once(&initShardsOnce, initShards);
+#endif
+   const uint64_t h = (uint64_t)((uintptr_t) obj >> 4) * 0x9E3779B97F4A7C15ULL;
+   return shards + (h >> 58) % MM_NSHARDS;
+}
+
+static void lockShard(struct Shard* shard)
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_lock(&shard->lock);
+#endif
+}
+
+static void unlockShard(struct Shard* shard)
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_unlock(&shard->lock);
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -45,49 +98,41 @@ void* mmAlloc(uint32_t typeId, size_t size)
     MTX_ASSERT(size >= sizeof(struct Object));
     struct Object* obj = (struct Object*) sysMalloc(size);
     obj->typeId = typeId;
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_lock(&listLock);
-#endif
-    obj->seq = ++sequenceCounter;
-    obj->prev = objsTail;
-    *objsTail = obj;
-    objsTail = &obj->next;
-    ++nObjs;
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_unlock(&listLock);
-#endif
-    MTX_LOG2("alloc t=0x%8lx obj=0x%p seq=%lu oc=%lu",
-	    (unsigned long) obj->typeId, obj, (unsigned long) obj->seq, (unsigned long) nObjs);
+    struct Shard* shard = shardOf(obj);
+    lockShard(shard);
+    // The sequence number is taken while the shard is locked, so each shard is sorted by
+    // descending sequence number (see mmRollback()).
+    obj->seq = __atomic_add_fetch(&sequenceCounter, 1, __ATOMIC_RELAXED);
+    if ((obj->next = shard->head) != NULL)
+       obj->next->prev = &obj->next;
+    obj->prev = &shard->head;
+    shard->head = obj;
+    ++shard->nObjs;
+    unlockShard(shard);
+    MTX_LOG2("alloc t=0x%8lx obj=0x%p seq=%lu",
+	    (unsigned long) obj->typeId, obj, (unsigned long) obj->seq);
     return obj;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void unlockedMmFree(struct Object* obj, uint32_t typeId)
+// Removes an object from the list of objects to be destroyed by mmRollback().
+
+static void forgetObject(const struct Object* obj)
 {
-    MTX_ASSERT(nObjs > 0);
-    MTX_ASSERT(obj->prev != NULL);
-    MTX_ASSERT(obj->typeId == typeId);
-
-    if ((*obj->prev = obj->next) == NULL) {
-       if (objsTail == &obj->next)
-          objsTail = obj->prev;
-       else if (delTail == &obj->next)
-          delTail = obj->prev;
-       else
-          abort();
-    } else {
-	obj->next->prev = obj->prev;
-    }
-    --nObjs;
-
-// cannot use logging here!
-//    MTX_LOG2("free  t=0x%8lx obj=0x%p seq=%lu oc=%lu", (unsigned long) obj->typeId, obj,
-//	    (unsigned long) obj->seq, (unsigned long) nObjs);
-    obj->next = NULL;
-    obj->prev = NULL;
-    obj->typeId = 0;
-    sysFree(obj);
+   size_t lo = 0;
+   size_t hi = rollbackSize;
+   while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (rollbackList[mid].seq < obj->seq) {
+         lo = mid + 1;
+      } else {
+         hi = mid;
+      }
+   }
+   if (lo < rollbackSize && rollbackList[lo].obj == obj) {
+      rollbackList[lo].obj = NULL;
+   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,23 +143,39 @@ static void unlockedMmFree(struct Object* obj, uint32_t typeId)
 
 void mmFree(void* obj, uint32_t typeId)
 {
-   struct Object*o = (struct Object*) obj;
-   #if defined(MTX_DEFAULT_THREADS)
-   pthread_mutex_lock(&listLock);
-   #endif
-   unlockedMmFree(o, typeId);
-   #if defined(MTX_DEFAULT_THREADS)
-   pthread_mutex_unlock(&listLock);
-   #endif
+   struct Object* o = (struct Object*) obj;
+   struct Shard* shard = shardOf(o);
+   lockShard(shard);
+   MTX_ASSERT(shard->nObjs > 0);
+   MTX_ASSERT(o->prev != NULL);
+   MTX_ASSERT(o->typeId == typeId);
+   if ((*o->prev = o->next) != NULL)
+      o->next->prev = o->prev;
+   --shard->nObjs;
+   unlockShard(shard);
+   if (rollbackList != NULL) {
+      forgetObject(o);
+   }
+
+   // cannot use logging here!
+   o->next = NULL;
+   o->prev = NULL;
+   o->typeId = 0;
+   sysFree(o);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Prints a warning is there are any live (allocated but not released) objects.
+/// In debug builds (MTX_DEBUG), each live object is logged individually.
 
 void mmLeakCheck()
 {
-   if (objsHead == NULL) {
+   size_t nObjs = 0;
+   for (int i = 0; i < MM_NSHARDS; ++i) {
+      nObjs += shards[i].nObjs;
+   }
+   if (nObjs == 0) {
       return;
    }
    size_t nMatrix = 0;
@@ -130,23 +191,28 @@ void mmLeakCheck()
    size_t nOther = 0;
    size_t nCharpol = 0;
 
-   for (const struct Object* obj = objsHead; obj != NULL; obj = obj->next) {
-      switch (obj->typeId) {
-         case MTX_TYPE_MATRIX: ++nMatrix; break;
-         case MTX_TYPE_PERMUTATION: ++nPermutation; break;
-         case MTX_TYPE_POLYNOMIAL: ++nPolynomial; break;
-         case MTX_TYPE_FPOLY: ++nFPoly; break;
-         case MTX_TYPE_INTMATRIX: ++nIntMatrix; break;
-         case MTX_TYPE_BINFILE: ++nBinFile; break;
-         case MTX_TYPE_STFILE: ++nStFile; break;
-         case MTX_TYPE_WORD_GENERATOR: ++nWgen; break;
-         case MTX_TYPE_BITSTRING_FIXED: ++nBsFixed; break;
-         case MTX_TYPE_BITSTRING_DYNAMIC: ++nBsDynamic; break;
-         case MTX_TYPE_CPSTATE: ++nCharpol; break;
-         default: ++nOther; break;
+   // No locking here: logging creates objects.
+   for (int i = 0; i < MM_NSHARDS; ++i) {
+      for (const struct Object* obj = shards[i].head; obj != NULL; obj = obj->next) {
+         switch (obj->typeId) {
+            case MTX_TYPE_MATRIX: ++nMatrix; break;
+            case MTX_TYPE_PERMUTATION: ++nPermutation; break;
+            case MTX_TYPE_POLYNOMIAL: ++nPolynomial; break;
+            case MTX_TYPE_FPOLY: ++nFPoly; break;
+            case MTX_TYPE_INTMATRIX: ++nIntMatrix; break;
+            case MTX_TYPE_BINFILE: ++nBinFile; break;
+            case MTX_TYPE_STFILE: ++nStFile; break;
+            case MTX_TYPE_WORD_GENERATOR: ++nWgen; break;
+            case MTX_TYPE_BITSTRING_FIXED: ++nBsFixed; break;
+            case MTX_TYPE_BITSTRING_DYNAMIC: ++nBsDynamic; break;
+            case MTX_TYPE_CPSTATE: ++nCharpol; break;
+            default: ++nOther; break;
+         }
+#if defined(MTX_DEBUG)
+         MTX_LOGE("leak t=0x%8lx obj=0x%p seq=%lu",
+               (unsigned long) obj->typeId, obj, (unsigned long) obj->seq);
+#endif
       }
-      MTX_LOGE("leak t=0x%8lx obj=0x%p seq=%lu",
-	    (unsigned long) obj->typeId, obj, (unsigned long) obj->seq);
    }
    MTX_XLOGE(msg) {
       sbAppend(msg, "Leak check:");
@@ -168,24 +234,11 @@ void mmLeakCheck()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//static struct Object* mmTail()
-//{
-//   if (objsTail == &objsHead) return NULL;
-//   return (struct Object*) objsTail; // this works because "next" is the first field in struct Object!
-//}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Returns a checkpoint for @ref mmRollback.
 
 uint32_t mmCheckpoint()
 {
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_lock(&listLock);
-#endif
-    uint32_t checkpoint = sequenceCounter;
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_unlock(&listLock);
-#endif
-   return checkpoint;
+   return __atomic_load_n(&sequenceCounter, __ATOMIC_SEQ_CST);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -216,34 +269,65 @@ static void destroy(void* object)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Orders rollback entries by sequence number.
+
+static int compareEntries(const void* a, const void* b)
+{
+   const uint32_t x = ((const struct RollbackEntry*) a)->seq;
+   const uint32_t y = ((const struct RollbackEntry*) b)->seq;
+   return x < y ? -1 : x > y ? 1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Destroys all recent objects up to, but not including, @p checkpoint.
 /// If @p checkpoint was already destroyed, nothing happens.
+/// This function must not be called while other threads create or destroy objects.
 
 void mmRollback(uint32_t checkpoint)
 {
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_lock(&listLock);
-#endif
-    if (delHead != NULL || delTail != &delHead)
-       abort();
-    struct Object** o = &objsHead;
-    while (*o != NULL && (*o)->seq <= checkpoint)
-       o = &(*o)->next;
-    if (*o != NULL && (*o)->seq > checkpoint) {
-       // move to delete list
-       delHead = *o;
-       (*o)->prev = &delHead;
-       delTail = objsTail;
-       objsTail = o;
-       *objsTail = NULL;
-    }
-#if defined(MTX_DEFAULT_THREADS)
-    pthread_mutex_unlock(&listLock);
-#endif
+   // Objects must be destroyed in the order of creation, across all shards, because an object is
+   // always created before the objects it owns. Each shard is sorted by descending sequence
+   // number, so the new objects are a prefix of each shard. They are collected and sorted once.
+   // Destroying an object may destroy other objects, too. mmFree() removes them from the list.
+   // Objects created while destroying are handled in the next pass.
+   while (1) {
+      size_t n = 0;
+      for (int i = 0; i < MM_NSHARDS; ++i) {
+         lockShard(shards + i);
+         for (struct Object* obj = shards[i].head; obj != NULL && obj->seq > checkpoint;
+               obj = obj->next) {
+            ++n;
+         }
+         unlockShard(shards + i);
+      }
+      if (n == 0)
+         break;
+      struct RollbackEntry* list = NALLOC(struct RollbackEntry, n);
+      size_t k = 0;
+      for (int i = 0; i < MM_NSHARDS; ++i) {
+         lockShard(shards + i);
+         for (struct Object* obj = shards[i].head; obj != NULL && obj->seq > checkpoint;
+               obj = obj->next) {
+            list[k].obj = obj;
+            list[k].seq = obj->seq;
+            ++k;
+         }
+         unlockShard(shards + i);
+      }
+      qsort(list, n, sizeof(*list), compareEntries);
 
-    while (delHead != NULL) {
-       destroy(delHead);
-    }
+      rollbackList = list;
+      rollbackSize = n;
+      for (size_t i = 0; i < n; ++i) {
+         if (list[i].obj != NULL) {
+            destroy(list[i].obj);
+         }
+      }
+      rollbackList = NULL;
+      rollbackSize = 0;
+      sysFree(list);
+   }
 }
 
 /// @}
@@ -19,6 +19,10 @@
 // OS_NO_ITIMER ............ no interval timers
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // sched_getaffinity()
+#endif
+
 #include "meataxe.h"
 
 #if defined (_WIN32)
@@ -31,12 +35,16 @@
 
 #else
 
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/times.h>
 #include <signal.h>
 #include <unistd.h>
 #include <sys/resource.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 #endif
 
@@ -134,6 +142,122 @@ uint64_t sysTime()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Returns the size of the per-core (level 2) data cache in bytes.
+/// If the cache size cannot be determined, the function returns 256 KiB, which is a reasonable
+/// value for most current processors. The value is used to choose block sizes for cache-aware
+/// algorithms, see ffMulMatrix().
+
+size_t sysCacheSize()
+{
+   static size_t cacheSize = 0;
+   if (cacheSize == 0) {
+      long n = -1;
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+      n = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+      cacheSize = (n > 0) ? (size_t) n : 256 * 1024;
+   }
+   return cacheSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__linux__)
+
+// Reads the CPU limit (quota/period) of a cgroup v2 directory. Returns 0 if there is no limit.
+
+static double cgroup2Limit(const char* dir)
+{
+   char fileName[600];
+   snprintf(fileName, sizeof(fileName), "/sys/fs/cgroup%s/cpu.max", dir);
+   FILE* f = fopen(fileName, "r");
+   if (f == NULL)
+      return 0;
+   char quota[32];
+   double period = 0;
+   const int n = fscanf(f, "%31s %lf", quota, &period);
+   fclose(f);
+   if (n != 2 || strcmp(quota, "max") == 0 || period <= 0)
+      return 0;
+   return atof(quota) / period;
+}
+
+// Returns the CPU limit of the process's control group, or 0 if there is no limit. All ancestors
+// of the cgroup are checked (cgroup v2), and the smallest limit wins.
+
+static double cgroupCpuLimit()
+{
+   double limit = 0;
+   FILE* f = fopen("/proc/self/cgroup", "r");
+   if (f != NULL) {
+      char line[512];
+      while (fgets(line, sizeof(line), f) != NULL) {
+         if (strncmp(line, "0::", 3) != 0)
+            continue;
+         char* dir = line + 3;
+         dir[strcspn(dir, "\n")] = 0;
+         while (1) {
+            const double l = cgroup2Limit(strcmp(dir, "/") == 0 ? "" : dir);
+            if (l > 0 && (limit == 0 || l < limit))
+               limit = l;
+            char* slash = strrchr(dir, '/');
+            if (slash == NULL || slash == dir)
+               break;
+            *slash = 0;
+         }
+      }
+      fclose(f);
+   }
+   if (limit == 0) {
+      // cgroup v1
+      static const char* const dirs[] = {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"};
+      for (int i = 0; i < 2 && limit == 0; ++i) {
+         char fileName[100];
+         long quota = -1, period = 0;
+         snprintf(fileName, sizeof(fileName), "%s/cpu.cfs_quota_us", dirs[i]);
+         if ((f = fopen(fileName, "r")) != NULL) {
+            if (fscanf(f, "%ld", &quota) != 1) quota = -1;
+            fclose(f);
+         }
+         snprintf(fileName, sizeof(fileName), "%s/cpu.cfs_period_us", dirs[i]);
+         if ((f = fopen(fileName, "r")) != NULL) {
+            if (fscanf(f, "%ld", &period) != 1) period = 0;
+            fclose(f);
+         }
+         if (quota > 0 && period > 0)
+            limit = (double) quota / (double) period;
+      }
+   }
+   return limit;
+}
+
+#endif
+
+/// Returns the number of CPUs available to the process.
+/// On Linux, this is the number of CPUs in the affinity mask of the calling thread, reduced to
+/// the CPU quota of the process's control group (rounded up) if there is one. On other systems,
+/// the function returns the number of online CPUs. The return value is at least 1.
+
+int sysCpuCount()
+{
+   long n = -1;
+#if defined(__linux__)
+   cpu_set_t set;
+   if (sched_getaffinity(0, sizeof(set), &set) == 0)
+      n = CPU_COUNT(&set);
+   const double limit = cgroupCpuLimit();
+   if (limit > 0 && (n < 0 || limit < (double) n))
+      n = (long) limit + ((double)(long) limit < limit ? 1 : 0);
+#endif
+#if defined(_SC_NPROCESSORS_ONLN)
+   if (n <= 0)
+      n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+   return n > 0 ? (int) n : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Timer for repeated events.
 /// @p buf must point to a variable which must be initialized with zero.
 /// On the first call, the return value is 0.
@@ -213,37 +337,24 @@ void sysSetTimeLimit(long nsecs)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/// Opens a file. 
-/// This function works like fopen() with the following differences:
-/// * If the operation fails an error is raised, which normally aborts the program. If the
-///   application has defined an error handler that doe snot abort, sysFopen() returns NULL on
-///   error.
-/// * The @p mode string can be extended by appending "::FLAGS", where FLAGS is
-///   a colon-separated list of any of the following items:
-///   * "lib" - Try to open the file in the library directory (see @ref mtxLibraryDirectory),
-///     unless @p name starts with '/'. It this fails, try again using the file name as it is.
-///     No errors are reported if the first attempt fails and the second attempt succeeds.
-///   * "noerror" - Do not raise an error if the file cannot be opened, just return NULL.
-///   For example: sysFopen("coeff7.txt", "r::lib:noerror")
-///
-/// @return A pointer to the open file or NULL on error.
+// Splits a sysFopen() mode into the mode for fopen() and MeatAxe flags.
 
-FILE *sysFopen(const char *name, const char* mode)
+static void parseMode(const char* mode, char* sysMode, size_t sysModeSize, int* useLibDir,
+      int* raiseError)
 {
-   char sysMode[20];
    const char* mtxExt = strstr(mode, "::");
-   int useLibDir = 0;
-   int raiseError = 1;
+   *useLibDir = 0;
+   *raiseError = 1;
    if (mtxExt != NULL) {
-      snprintf(sysMode, sizeof(sysMode), "%.*s", (int)(mtxExt - mode), mode);
+      snprintf(sysMode, sysModeSize, "%.*s", (int)(mtxExt - mode), mode);
       const char* c = mtxExt + 2;
       while (1) {
          if (strncmp(c, "lib", 3) == 0) {
-            useLibDir = 1;
+            *useLibDir = 1;
             c += 3;
          }
          else if (strncmp(c, "noerror", 7) == 0) {
-            raiseError = 0;
+            *raiseError = 0;
             c += 7;
          } else {
             break;
@@ -253,11 +364,34 @@ FILE *sysFopen(const char *name, const char* mode)
       }
       if (*c != 0) {
          mtxAbort(MTX_HERE,"Invalid file mode %s", mode);
-         return NULL;
       }
    } else {
-      snprintf(sysMode, sizeof(sysMode), "%s", mode);
+      snprintf(sysMode, sysModeSize, "%s", mode);
    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Opens a file. 
+/// This function works like fopen() with the following differences:
+/// * If the operation fails an error is raised, which normally aborts the program. If the
+///   application has defined an error handler that doe snot abort, sysFopen() returns NULL on
+///   error.
+/// * The @p mode string can be extended by appending "::FLAGS", where FLAGS is
+///   a colon-separated list of any of the following items:
+///   * "lib" - Try to open the file in the library directory (see @ref mtxLibraryDirectory),
+///     unless @p name starts with '/'. It this fails, try again using the file name as it is.
+///     No errors are reported if the first attempt fails and the second attempt succeeds.
+///   * "noerror" - Do not raise an error if the file cannot be opened, just return NULL.
+///   For example: sysFopen("coeff7.txt", "r::lib:noerror")
+///
+/// @return A pointer to the open file or NULL on error.
+
+FILE *sysFopen(const char *name, const char* mode)
+{
+   char sysMode[20];
+   int useLibDir, raiseError;
+   parseMode(mode, sysMode, sizeof(sysMode), &useLibDir, &raiseError);
 
    FILE *f = NULL;
    if (useLibDir && *name != '/') {
@@ -276,6 +410,170 @@ FILE *sysFopen(const char *name, const char* mode)
    return f;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Opens a temporary file for atomic file creation.
+/// This function creates a new file with a unique name in the directory where
+/// sysFopen(@p name, @p mode) would create @p name. After writing the data, call sysCommitFile()
+/// to rename the file to @p name. Since renaming is atomic, other processes see either no file
+/// (or the old one) or the complete new file, but never a partially written file. If several
+/// processes create the same file concurrently, each one writes its own temporary file, and the
+/// last rename wins.
+/// @param name Final name of the file.
+/// @param mode File mode, see sysFopen(). The "noerror" flag is ignored.
+/// @param tempName Receives the name of the temporary file, which must be passed to
+///    sysCommitFile().
+/// @return The open file.
+
+FILE* sysFopenTemp(const char* name, const char* mode, char** tempName)
+{
+   static unsigned counter = 0;
+   char sysMode[20];
+   int useLibDir, raiseError;
+   parseMode(mode, sysMode, sizeof(sysMode), &useLibDir, &raiseError);
+   const unsigned n = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+
+   FILE* f = NULL;
+   char* tmp = NULL;
+   if (useLibDir && *name != '/') {
+      tmp = strMprintf("%s/%s.%d.%u.tmp", mtxLibraryDirectory(), name, sysGetPid(), n);
+      f = fopen(tmp, sysMode);
+   }
+   if (f == NULL) {
+      sysFree(tmp);
+      tmp = strMprintf("%s.%d.%u.tmp", name, sysGetPid(), n);
+      f = fopen(tmp, sysMode);
+   }
+   if (f == NULL) {
+      mtxAbort(MTX_HERE, "Cannot create %s: %s", tmp, strerror(errno));
+      sysFree(tmp);
+      return NULL;
+   }
+   *tempName = tmp;
+   return f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Finishes atomic file creation.
+/// This function closes a file that was opened with sysFopenTemp() and renames it to its final
+/// name, replacing any existing file. @p tempName is freed.
+/// @return 0 on success, -1 on error.
+
+int sysCommitFile(FILE* f, char* tempName)
+{
+   int rc = (fclose(f) == 0) ? 0 : -1;
+
+   // Remove the ".<pid>.<n>.tmp" suffix.
+   char* name = strMprintf("%s", tempName);
+   for (int i = 0; i < 3; ++i) {
+      *strrchr(name, '.') = 0;
+   }
+   if (rc == 0) {
+#ifdef _WIN32
+      rc = MoveFileExA(tempName, name, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+      rc = rename(tempName, name);
+#endif
+   }
+   if (rc != 0) {
+      remove(tempName);
+      mtxAbort(MTX_HERE, "Cannot create %s: %s", name, strerror(errno));
+   }
+   sysFree(name);
+   sysFree(tempName);
+   return rc;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @private
+typedef struct MappedFile {
+   char* name;
+   const void* data;
+   size_t size;
+   struct MappedFile* next;
+} MappedFile_t;
+
+static MappedFile_t* mappedFiles = NULL;
+#if defined(MTX_DEFAULT_THREADS)
+static pthread_mutex_t mappedFilesMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static const void* mapFile(const char* name, const char* mode, size_t* size)
+{
+   for (const MappedFile_t* m = mappedFiles; m != NULL; m = m->next) {
+      if (strcmp(m->name, name) == 0) {
+         *size = m->size;
+         return m->data;
+      }
+   }
+
+   FILE* f = sysFopen(name, mode);
+   if (f == NULL) {
+      return NULL;
+   }
+   if (sysFseek(f, -1) != 0) {
+      mtxAbort(MTX_HERE, "%s: seek failed: %s", name, strerror(errno));
+   }
+   const size_t fileSize = (size_t) ftell(f);
+
+   const void* data = NULL;
+#ifndef _WIN32
+   if (fileSize > 0) {
+      void* p = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fileno(f), 0);
+      if (p != MAP_FAILED) {
+         data = p;
+      }
+   }
+#endif
+   if (data == NULL) {
+      void* buf = sysMalloc(fileSize + 1);
+      if (sysFseek(f, 0) != 0 || fread(buf, 1, fileSize, f) != fileSize) {
+         mtxAbort(MTX_HERE, "%s: read error: %s", name, strerror(errno));
+      }
+      data = buf;
+   }
+   fclose(f);
+
+   MappedFile_t* m = ALLOC(MappedFile_t);
+   m->name = strMprintf("%s", name);
+   m->data = data;
+   m->size = fileSize;
+   m->next = mappedFiles;
+   mappedFiles = m;
+   *size = fileSize;
+   return data;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Maps a file into memory.
+/// This function locates and opens a file like sysFopen() and makes its contents available
+/// read-only. Where possible, the file is mapped with mmap(), so the pages are shared through
+/// the page cache with other processes using the same file. Otherwise, the contents are read
+/// into a buffer.
+///
+/// Mappings are cached by file name and remain valid until the process terminates, so mapping
+/// the same file again is cheap. This function is intended for files that do not change, like
+/// arithmetic tables. This function is thread-safe.
+/// @param name File name.
+/// @param mode File mode, see sysFopen(). This must be a read mode, for example "rb::lib".
+/// @param size Receives the file size in bytes.
+/// @return Pointer to the file contents, or NULL if the file cannot be opened.
+
+const void* sysMapFile(const char* name, const char* mode, size_t* size)
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_lock(&mappedFilesMutex);
+#endif
+   const void* data = mapFile(name, mode, size);
+#if defined(MTX_DEFAULT_THREADS)
+   pthread_mutex_unlock(&mappedFilesMutex);
+#endif
+   return data;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
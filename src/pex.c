@@ -2,8 +2,17 @@
 // C MeatAxe - Parallel execution (threads) support
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE             // pthread_setaffinity_np()
+#endif
+
 #include "meataxe.h"
 
+#if defined(MTX_DEFAULT_THREADS) && defined(__linux__)
+#include <sched.h>
+#define PEX_HAVE_AFFINITY
+#endif
+
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
@@ -25,6 +34,7 @@ struct PexGroup {
    #endif
    size_t nPending;             // number of tasks waiting or being executed
    int isDeleting;
+   int isCancelled;             // set by pexCancel() (atomic)
 };
 
 #if defined(MTX_DEFAULT_THREADS)
@@ -35,13 +45,14 @@ static PexGroup_t** groupsTail = &groupsHead;
 
 /// @private
 typedef struct Task {
-   struct Task* next;
+   struct Task* next;           // link in the task pool
    struct PexGroup* group;
    void (*f)(void* userData);
    void (*fr)(void* userData, size_t begin, size_t end);
    void* userData;
    size_t begin;
    size_t end;
+   const FfContext_t* field;    // current field of the creating thread
 } Task_t;
 
 
@@ -58,6 +69,11 @@ struct ThreadInfo {
 
 static int tidWidth = 0;
 static int isInitialized = 0;
+static int pinThreads = 0;            // see pexPinThreads()
+#if defined(PEX_HAVE_AFFINITY)
+static cpu_set_t mainAffinity;        // affinity of the main thread before pinning
+static int isPinned = 0;
+#endif
 
 #if defined(MTX_DEFAULT_THREADS)
 
@@ -75,20 +91,62 @@ static const int threadPoolSize = 0;
 static pthread_once_t createTidKeyOnce = PTHREAD_ONCE_INIT;
 #endif
 
-// Data protected by tqMutex
+// Scheduler data
+// Each worker thread owns a task deque. The owner adds and removes tasks at the bottom (LIFO),
+// which keeps the data of recently created tasks in the cache. Idle workers steal the oldest
+// tasks from the top of other deques. Tasks created outside the thread pool are distributed
+// round-robin over all deques. Idle workers sleep on their own condition variable and are woken
+// up one at a time when new tasks arrive.
 #if defined(MTX_DEFAULT_THREADS)
-static pthread_mutex_t tqMutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t tqWakeup = PTHREAD_COND_INITIALIZER;   // task added or shutdown started
-static pthread_cond_t tqIdle = PTHREAD_COND_INITIALIZER;     // task finished
-static int nThreads = 0;           // Number of created threads
-static int nBusyThreads = 0;       // Number of threads executing a task
-static int nQueuedTasks = 0;
+
+/// @private
+struct TaskDeque {
+   pthread_mutex_t mutex;
+   Task_t** items;              // ring buffer
+   size_t capacity;             // always a power of 2
+   size_t top;                  // position of the oldest task
+   size_t size;                 // number of tasks
+};
+
+/// @private
+struct Worker {
+   struct TaskDeque deque;
+   pthread_cond_t wakeup;
+   int wakeupPending;           // protected by sleepMutex
+};
+
+static struct Worker* workers = NULL;
+static int nThreads = 0;                // Number of created threads
+static unsigned nextWorker = 0;         // for round-robin distribution
+static size_t nQueuedTasks = 0;         // tasks waiting in any deque
+static size_t nUnfinishedTasks = 0;     // tasks waiting or being executed
+static int nIdleThreads = 0;
+
+// Data protected by sleepMutex
+static pthread_mutex_t sleepMutex = PTHREAD_MUTEX_INITIALIZER;
+static int* idleThreads = NULL;         // stack of sleeping workers
 static int tqShutdown = 0;
-static struct Task* tqHead = NULL;
-static struct Task** tqTail = &tqHead;
+
+// Used by pexWaitAll()
+static pthread_mutex_t idleMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tqIdle = PTHREAD_COND_INITIALIZER;     // all tasks finished
+
+// Task objects are recycled. Each thread keeps a small pool of unused tasks and exchanges them
+// in batches with the global pool.
+#define TASK_POOL_BATCH 32
+static pthread_mutex_t taskPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static Task_t* taskPool = NULL;
+static MTX_THREAD_LOCAL Task_t* localTaskPool = NULL;
+static MTX_THREAD_LOCAL int localTaskPoolSize = 0;
+
 #endif
 static int groupId = 0;
 
+// Cancellation state of the calling thread, see pexIsCancelled().
+static MTX_THREAD_LOCAL PexGroup_t* currentGroup = NULL;      // group of the current task
+static MTX_THREAD_LOCAL struct ParallelLoop* currentLoop = NULL;
+static MTX_THREAD_LOCAL size_t currentIndex = 0;              // see pexParallelFindFirst()
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 static void deleteGroup(PexGroup_t* group)
@@ -112,6 +170,13 @@ static void deleteGroup(PexGroup_t* group)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+static int isCancelled(const PexGroup_t* group)
+{
+   return group != NULL && __atomic_load_n(&group->isCancelled, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 static void setThreadName(struct ThreadInfo* ti, const char* name)
 {
    snprintf(ti->name, sizeof(ti->name), "%s", name);
@@ -192,6 +257,7 @@ void pexWait(PexGroup_t *group)
    }
    group->isDeleting = 1;
    MTX_LOG2("%s: deleting grp=%p", __func__, group);
+   pthread_mutex_unlock(&group->mutex);
 #endif
 
    deleteGroup(group);
@@ -199,13 +265,38 @@ void pexWait(PexGroup_t *group)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Cancels all tasks in a group.
+/// Tasks of the group which have not yet started are dropped without being executed, and so are
+/// tasks which are added to the group later. Running tasks are not interrupted, but they can
+/// poll @ref pexIsCancelled and return early. Cancellation cannot be undone. The group must still
+/// be destroyed with @ref pexWait, which returns as soon as the running tasks have finished.
+///
+/// pexCancel() may be called from any thread, including the tasks of the group.
+
+void pexCancel(PexGroup_t* group)
+{
+   MTX_ASSERT(group != NULL);
+   MTX_LOG2("%s: grp=%p", __func__, group);
+   __atomic_store_n(&group->isCancelled, 1, __ATOMIC_RELAXED);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 #if defined(MTX_DEFAULT_THREADS)
 
 static void executeTask(Task_t* task)
 {
    const int context = mtxBegin(MTX_HERE, "executing task");
    const unsigned long groupId = (task->group != NULL) ? task->group->groupId : 0;
-   if (task->fr != NULL) {
+   if (task->field != NULL) {
+      ffBindContext(task->field);
+   }
+   PexGroup_t* const savedGroup = currentGroup;
+   currentGroup = task->group;
+   if (isCancelled(task->group)) {
+      MTX_LOG2("drop task %lx.%p (cancelled)", groupId, task->userData);
+   }
+   else if (task->fr != NULL) {
       MTX_LOG2("begin task %lx.%p.%p [%lu,%lu)",
          groupId, task->userData, task->fr, (unsigned long) task->begin, (unsigned long) task->end);
       task->fr(task->userData, task->begin, task->end);
@@ -215,6 +306,7 @@ static void executeTask(Task_t* task)
       task->f(task->userData);
    }
    MTX_LOG2("end task %p.%p", task->userData, task->fr ? (void*)task->fr : (void*)task->f);
+   currentGroup = savedGroup;
    if (task->group) {
       removeTaskFromGroup(task->group);
    }
@@ -227,6 +319,208 @@ static void executeTask(Task_t* task)
 
 #if defined(MTX_DEFAULT_THREADS)
 
+static Task_t* allocTask()
+{
+   if (localTaskPool == NULL) {
+      pthread_mutex_lock(&taskPoolMutex);
+      while (taskPool != NULL && localTaskPoolSize < TASK_POOL_BATCH) {
+         Task_t* task = taskPool;
+         taskPool = task->next;
+         task->next = localTaskPool;
+         localTaskPool = task;
+         ++localTaskPoolSize;
+      }
+      pthread_mutex_unlock(&taskPoolMutex);
+   }
+   if (localTaskPool == NULL) {
+      return ALLOC(Task_t);
+   }
+   Task_t* task = localTaskPool;
+   localTaskPool = task->next;
+   --localTaskPoolSize;
+   return task;
+}
+
+// Moves «n» tasks from the local pool to the global pool.
+
+static void releaseLocalTasks(int n)
+{
+   pthread_mutex_lock(&taskPoolMutex);
+   while (n-- > 0 && localTaskPool != NULL) {
+      Task_t* task = localTaskPool;
+      localTaskPool = task->next;
+      --localTaskPoolSize;
+      task->next = taskPool;
+      taskPool = task;
+   }
+   pthread_mutex_unlock(&taskPoolMutex);
+}
+
+static void freeTask(Task_t* task)
+{
+   task->next = localTaskPool;
+   localTaskPool = task;
+   if (++localTaskPoolSize > 2 * TASK_POOL_BATCH) {
+      releaseLocalTasks(TASK_POOL_BATCH);
+   }
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(MTX_DEFAULT_THREADS)
+
+static void dequeInit(struct TaskDeque* d)
+{
+   pthread_mutex_init(&d->mutex, NULL);
+   d->capacity = 64;
+   d->items = NALLOC(Task_t*, d->capacity);
+   d->top = 0;
+   d->size = 0;
+}
+
+static void dequeDestroy(struct TaskDeque* d)
+{
+   MTX_ASSERT(d->size == 0);
+   sysFree(d->items);
+   pthread_mutex_destroy(&d->mutex);
+}
+
+static void dequePush(struct TaskDeque* d, Task_t* task)
+{
+   pthread_mutex_lock(&d->mutex);
+   if (d->size == d->capacity) {
+      Task_t** items = NALLOC(Task_t*, 2 * d->capacity);
+      for (size_t i = 0; i < d->size; ++i) {
+         items[i] = d->items[(d->top + i) & (d->capacity - 1)];
+      }
+      sysFree(d->items);
+      d->items = items;
+      d->capacity *= 2;
+      d->top = 0;
+   }
+   d->items[(d->top + d->size) & (d->capacity - 1)] = task;
+   __atomic_store_n(&d->size, d->size + 1, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&d->mutex);
+}
+
+// Removes the newest task (bottom) or, if «steal» is set, the oldest task (top) from the deque.
+// Returns NULL if the deque is empty.
+
+static Task_t* dequePop(struct TaskDeque* d, int steal)
+{
+   if (__atomic_load_n(&d->size, __ATOMIC_RELAXED) == 0) {
+      return NULL;
+   }
+   Task_t* task = NULL;
+   pthread_mutex_lock(&d->mutex);
+   if (d->size > 0) {
+      if (steal) {
+         task = d->items[d->top];
+         d->top = (d->top + 1) & (d->capacity - 1);
+      } else {
+         task = d->items[(d->top + d->size - 1) & (d->capacity - 1)];
+      }
+      __atomic_store_n(&d->size, d->size - 1, __ATOMIC_RELAXED);
+   }
+   pthread_mutex_unlock(&d->mutex);
+   return task;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(MTX_DEFAULT_THREADS)
+
+// Wakes up one sleeping worker, if there is any.
+
+static void wakeOneWorker()
+{
+   if (__atomic_load_n(&nIdleThreads, __ATOMIC_SEQ_CST) == 0) {
+      return;
+   }
+   pthread_mutex_lock(&sleepMutex);
+   if (nIdleThreads > 0) {
+      const int k = idleThreads[__atomic_sub_fetch(&nIdleThreads, 1, __ATOMIC_SEQ_CST)];
+      workers[k].wakeupPending = 1;
+      pthread_cond_signal(&workers[k].wakeup);
+   }
+   pthread_mutex_unlock(&sleepMutex);
+}
+
+// Adds a task to the deque of the calling worker thread, or to some worker's deque if the
+// calling thread does not belong to the thread pool.
+
+static void scheduleTask(Task_t* task, int threadNumber)
+{
+   __atomic_add_fetch(&nUnfinishedTasks, 1, __ATOMIC_SEQ_CST);
+   const int k = (threadNumber > 0)
+      ? threadNumber - 1
+      : (int) (__atomic_fetch_add(&nextWorker, 1, __ATOMIC_RELAXED) % (unsigned) nThreads);
+   dequePush(&workers[k].deque, task);
+   __atomic_add_fetch(&nQueuedTasks, 1, __ATOMIC_SEQ_CST);
+   wakeOneWorker();
+}
+
+// Returns the next task for worker «k»: the newest task from its own deque or, if that is empty,
+// the oldest task from another worker's deque. Returns NULL if all deques are empty.
+
+static Task_t* findTask(int k)
+{
+   Task_t* task = dequePop(&workers[k].deque, 0);
+   for (int i = 1; task == NULL && i < nThreads; ++i) {
+      task = dequePop(&workers[(k + i) % nThreads].deque, 1);
+   }
+   if (task != NULL) {
+      __atomic_sub_fetch(&nQueuedTasks, 1, __ATOMIC_SEQ_CST);
+   }
+   return task;
+}
+
+static void finishTask(Task_t* task)
+{
+   freeTask(task);
+   if (__atomic_sub_fetch(&nUnfinishedTasks, 1, __ATOMIC_SEQ_CST) == 0) {
+      pthread_mutex_lock(&idleMutex);
+      pthread_cond_broadcast(&tqIdle);
+      pthread_mutex_unlock(&idleMutex);
+   }
+}
+
+// Puts worker «k» to sleep until a task is available. Returns 0 if the thread pool is being
+// shut down.
+
+static int sleepUntilWork(int k)
+{
+   int result = 1;
+   pthread_mutex_lock(&sleepMutex);
+   idleThreads[nIdleThreads] = k;
+   __atomic_add_fetch(&nIdleThreads, 1, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&nQueuedTasks, __ATOMIC_SEQ_CST) > 0) {
+      // A task was added after findTask() had failed.
+      __atomic_sub_fetch(&nIdleThreads, 1, __ATOMIC_SEQ_CST);
+   } else {
+      while (!workers[k].wakeupPending && !tqShutdown) {
+         pthread_cond_wait(&workers[k].wakeup, &sleepMutex);
+      }
+      if (workers[k].wakeupPending) {
+         workers[k].wakeupPending = 0;     // already removed from idleThreads
+      } else {
+         result = 0;
+      }
+   }
+   pthread_mutex_unlock(&sleepMutex);
+   return result;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(MTX_DEFAULT_THREADS)
+
 static void createTidKey()
 {
     pthread_key_create(&tidKey, NULL);
@@ -288,6 +582,7 @@ static void destroyThreadInfo(struct ThreadInfo* ti)
 
 static void threadCleanup()
 {
+   ffFlushRowCache();
    struct ThreadInfo *ti = getThreadInfo();
    destroyThreadInfo(ti);
 }
@@ -315,34 +610,22 @@ static void threadInit(void* arg)
 
 static void* threadMain(void* arg)
 {
-   pthread_mutex_lock(&tqMutex);
    threadInit(arg);
+   const int k = getThreadInfo()->threadNumber - 1;
    MTX_LOG2("worker thread ready");
    while (1) {
-       if (tqShutdown)
-	   break;
-       else if (tqHead != NULL) {
-	   struct Task* task = tqHead;
-	   if ((tqHead = tqHead->next) == NULL) {
-	       tqTail = &tqHead;
-	   }
-           --nQueuedTasks;
-           ++nBusyThreads;
-           pthread_mutex_unlock(&tqMutex);
-	   task->next = NULL;
-           setThreadName(getThreadInfo(), "");
-	   executeTask(task);
-           pthread_mutex_lock(&tqMutex);
-           --nBusyThreads;
-           pthread_cond_broadcast(&tqIdle);
-	   sysFree(task);
-       } else {
-          pthread_cond_wait(&tqWakeup, &tqMutex);
-       }
+      Task_t* task = findTask(k);
+      if (task != NULL) {
+         setThreadName(getThreadInfo(), "");
+         executeTask(task);
+         finishTask(task);
+      } else if (!sleepUntilWork(k)) {
+         break;
+      }
    }
    MTX_LOG2("worker thread exiting");
+   releaseLocalTasks(localTaskPoolSize);
    threadCleanup();
-   pthread_mutex_unlock(&tqMutex);
    return NULL;
 }
 
@@ -414,22 +697,71 @@ void pexSetThreadName(const char* name, ...)
 void pexWaitAll()
 {
 #if defined(MTX_DEFAULT_THREADS)
-   pthread_mutex_lock(&tqMutex);
-   while (1) {
-      if (tqHead == NULL && nBusyThreads == 0)
-         break;
+   pthread_mutex_lock(&idleMutex);
+   while (__atomic_load_n(&nUnfinishedTasks, __ATOMIC_SEQ_CST) > 0) {
       MTX_LOG2("Waiting for pending tasks");
-      pthread_cond_wait(&tqIdle, &tqMutex);
+      pthread_cond_wait(&tqIdle, &idleMutex);
    }
-   pthread_mutex_unlock(&tqMutex);
+   pthread_mutex_unlock(&idleMutex);
 #endif
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Enables or disables CPU pinning.
+/// If enabled, the next @ref pexInit call pins the main thread and each worker thread to a
+/// separate CPU, which keeps the threads' data in the local caches and memory of that CPU.
+/// Threads are assigned to the CPUs in the affinity mask of the main thread in ascending order,
+/// starting over if there are more threads than CPUs. @ref pexShutdown restores the original
+/// affinity of the main thread.
+///
+/// Pinning is supported only on Linux. On other systems, this function has no effect.
+
+void pexPinThreads(int enable)
+{
+   pinThreads = enable;
+}
+
+#if defined(PEX_HAVE_AFFINITY)
+
+// Pins the main thread and the worker threads to CPUs, see pexPinThreads().
+
+static void pinPool()
+{
+   if (pthread_getaffinity_np(pthread_self(), sizeof(mainAffinity), &mainAffinity) != 0) {
+      MTX_LOGD("Cannot get CPU affinity, threads are not pinned");
+      return;
+   }
+   int cpus[CPU_SETSIZE];
+   int nCpus = 0;
+   for (int c = 0; c < CPU_SETSIZE; ++c) {
+      if (CPU_ISSET(c, &mainAffinity))
+         cpus[nCpus++] = c;
+   }
+   if (nCpus == 0)
+      return;
+   isPinned = 1;
+   for (int i = 0; i <= nThreads; ++i) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[i % nCpus], &set);
+      const pthread_t thread = (i == 0) ? pthread_self() : threadId[i - 1];
+      if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0) {
+         MTX_LOGD("Cannot pin thread %d to CPU %d", i, cpus[i % nCpus]);
+      }
+   }
+   MTX_LOGD("Pinned %d threads to %d CPUs", nThreads + 1, nCpus);
+}
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Stops worker threads and releases internal resources.
-/// This function fails if it is called while tasks are pending or being executed.
+/// This function fails if it is called while tasks are pending. Tasks which are still being
+/// executed (for example, the last tasks of a group after @ref pexWait returned) are allowed to
+/// finish.
 /// Calling pexShutdown() multiple times or without a prior pexInit() call is allowed and has no
 /// effect.
 
@@ -442,22 +774,44 @@ void pexShutdown()
 #if defined(MTX_DEFAULT_THREADS)
    MTX_LOG2("PEX shutting down");
 
-   pthread_mutex_lock(&tqMutex);
-   MTX_ASSERT(tqHead == NULL);
-   MTX_ASSERT(tqTail == &tqHead);
-   MTX_ASSERT(nBusyThreads == 0);
+   MTX_ASSERT(__atomic_load_n(&nQueuedTasks, __ATOMIC_SEQ_CST) == 0);
+   pexWaitAll();
+   pthread_mutex_lock(&sleepMutex);
    tqShutdown = 1;
-   pthread_cond_broadcast(&tqWakeup);
-   pthread_mutex_unlock(&tqMutex);
+   for (int i = 0; i < nThreads; ++i) {
+      pthread_cond_signal(&workers[i].wakeup);
+   }
+   pthread_mutex_unlock(&sleepMutex);
    for (int i = 0; i < nThreads; ++i) {
       pthread_join(threadId[i], NULL);
    }
-   pthread_mutex_unlock(&tqMutex);
    // TODO: REALLOC(threadInfo, struct ThreadInfo, 1);
+   for (int i = 0; i < nThreads; ++i) {
+      dequeDestroy(&workers[i].deque);
+      pthread_cond_destroy(&workers[i].wakeup);
+   }
+   sysFree(workers);
+   workers = NULL;
+   sysFree(idleThreads);
+   idleThreads = NULL;
+   nIdleThreads = 0;
    sysFree(threadId);
    threadId = NULL;
    threadPoolSize = 0;
    nThreads = 0;
+#if defined(PEX_HAVE_AFFINITY)
+   if (isPinned) {
+      pthread_setaffinity_np(pthread_self(), sizeof(mainAffinity), &mainAffinity);
+      isPinned = 0;
+   }
+#endif
+
+   releaseLocalTasks(localTaskPoolSize);
+   while (taskPool != NULL) {
+      Task_t* task = taskPool;
+      taskPool = task->next;
+      sysFree(task);
+   }
 
    pthread_mutex_lock(&groupsMutex);
    MTX_ASSERT(groupsHead == NULL);
@@ -495,12 +849,35 @@ void pexInit(int poolSize)
    MTX_LOG2("PEX initializing, poolSize=%d", poolSize);
    threadPoolSize = poolSize;
    tqShutdown = 0;
-   nThreads = 0;
-   nBusyThreads = 0;
+   nQueuedTasks = 0;
+   nUnfinishedTasks = 0;
+   nIdleThreads = 0;
    threadId = NALLOC(pthread_t, threadPoolSize);
+   workers = NALLOC(struct Worker, threadPoolSize);
+   idleThreads = NALLOC(int, threadPoolSize);
+   for (int i = 0; i < threadPoolSize; ++i) {
+      dequeInit(&workers[i].deque);
+      pthread_cond_init(&workers[i].wakeup, NULL);
+      workers[i].wakeupPending = 0;
+   }
    #endif
    tidWidth = threadPoolSize < 10 ? 1 : (threadPoolSize < 100 ? 2 : (threadPoolSize < 1000 ? 3 : 4));
    setThreadName(getThreadInfo(), "");
+
+   #if defined(MTX_DEFAULT_THREADS)
+   nThreads = threadPoolSize;
+   for (int i = 0; i < nThreads; ++i) {
+      int* threadNumber = ALLOC(int); // memory is released in worker thread
+      *threadNumber = i + 1;
+      int threadCreateResult = pthread_create(threadId + i, NULL, threadMain, threadNumber);
+      MTX_ASSERT(threadCreateResult == 0);
+   }
+   #endif
+   #if defined(PEX_HAVE_AFFINITY)
+   if (pinThreads) {
+      pinPool();
+   }
+   #endif
 }
 
 
@@ -537,7 +914,12 @@ static void createTask(
 {
    if (threadPoolSize == 0) {
       // Execute immediately.
-      f ? f(userData) : fr(userData, begin, end);
+      if (!isCancelled(group)) {
+         PexGroup_t* const savedGroup = currentGroup;
+         currentGroup = group;
+         f ? f(userData) : fr(userData, begin, end);
+         currentGroup = savedGroup;
+      }
       return;
    }
 
@@ -545,13 +927,14 @@ static void createTask(
    if (group != NULL) {
       addTaskToGroup(group);
    }
-   Task_t* task = ALLOC(Task_t);
+   Task_t* task = allocTask();
    task->group = group;
    task->f = f;
    task->fr = fr;
    task->userData = userData;
    task->begin = begin;
    task->end = end;
+   task->field = ffCurrentContext();
    const unsigned long gid = (group != NULL) ? group->groupId : 0;
    if (fr == NULL) {
       MTX_LOG2("create task %lu.%p.%p", gid, userData, fr ? (void*)fr : (void*)f);
@@ -562,23 +945,7 @@ static void createTask(
          (unsigned long) begin, (unsigned long) end);
    }
 
-   pthread_mutex_lock(&tqMutex);
-   *tqTail = task;
-   task->next = NULL;
-   tqTail = &task->next;
-   ++nQueuedTasks;
-
-   // Create additional worker threads if necessary and possible.
-   if (nThreads < threadPoolSize && nQueuedTasks + nBusyThreads > nThreads) {
-      int* threadNumber = ALLOC(int); // memory is released in worker thread
-      *threadNumber = nThreads + 1;
-      int threadCreateResult = pthread_create(threadId + nThreads, NULL, threadMain, threadNumber);
-      MTX_ASSERT(threadCreateResult == 0);
-      ++nThreads;
-   }
-
-   pthread_mutex_unlock(&tqMutex);
-   pthread_cond_broadcast(&tqWakeup);
+   scheduleTask(task, getThreadInfo()->threadNumber);
 #endif
 }
 
@@ -597,6 +964,9 @@ static void createTask(
 /// If @p group is not NULL, it must be a pointer to a task group created by @ref pexCreateGroup.
 /// The task becomes a member of this group, i.e., @ref pexWait will not return before this task
 /// is finished.
+///
+/// The task starts with the current field of the calling thread (see @ref ffSetField). It may
+/// select a different field without affecting other tasks.
 
 void pexExecute(PexGroup_t* group, void (*f)(void *userData), void* userData)
 {
@@ -621,6 +991,239 @@ void pexExecuteRange(
    createTask(group, NULL, f, userData, begin, end);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parallel loops
+
+/// @private
+struct ParallelLoop {
+   size_t next;                 // first index not yet claimed (atomic)
+   size_t end;
+   size_t grain;
+   size_t nParts;               // number of participating threads
+   int guided;                  // 1: chunk size decreases with the remaining range
+   void (*body)(void* userData, size_t begin, size_t end);
+   int (*predicate)(void* userData, size_t i);
+   uint64_t (*minBody)(void* userData, size_t begin, size_t end);
+   void* userData;
+   PexGroup_t* group;           // group of the calling task, see pexCancel()
+   size_t first;                // pexParallelFindFirst(): smallest index found (atomic)
+   uint64_t min;                // pexParallelMin(): smallest value found (atomic)
+};
+
+// Claims the next chunk of a parallel loop. Returns 0 if there is nothing left to do.
+
+static int claimChunk(struct ParallelLoop* loop, size_t* begin, size_t* end)
+{
+   size_t cur = __atomic_load_n(&loop->next, __ATOMIC_RELAXED);
+   while (!isCancelled(loop->group)) {
+      const size_t limit = (loop->predicate != NULL)
+         ? __atomic_load_n(&loop->first, __ATOMIC_RELAXED) : loop->end;
+      if (cur >= limit) {
+         return 0;
+      }
+      size_t size = loop->grain;
+      if (loop->guided && (loop->end - cur) / (2 * loop->nParts) > size) {
+         size = (loop->end - cur) / (2 * loop->nParts);
+      }
+      const size_t e = (loop->end - cur > size) ? cur + size : loop->end;
+      if (__atomic_compare_exchange_n(&loop->next, &cur, e, 0, __ATOMIC_RELAXED,
+               __ATOMIC_RELAXED)) {
+         *begin = cur;
+         *end = e;
+         return 1;
+      }
+   }
+   return 0;
+}
+
+static void atomicMinSize(size_t* x, size_t value)
+{
+   size_t cur = __atomic_load_n(x, __ATOMIC_RELAXED);
+   while (value < cur
+         && !__atomic_compare_exchange_n(x, &cur, value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+   }
+}
+
+static void atomicMinU64(uint64_t* x, uint64_t value)
+{
+   uint64_t cur = __atomic_load_n(x, __ATOMIC_RELAXED);
+   while (value < cur
+         && !__atomic_compare_exchange_n(x, &cur, value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+   }
+}
+
+// Task function for parallel loops. Each participating thread claims and processes chunks until
+// the loop is finished.
+
+static void loopTask(void* userData, size_t unused1, size_t unused2)
+{
+   struct ParallelLoop* loop = (struct ParallelLoop*) userData;
+   PexGroup_t* const savedGroup = currentGroup;
+   struct ParallelLoop* const savedLoop = currentLoop;
+   const size_t savedIndex = currentIndex;
+   currentGroup = loop->group;
+   currentLoop = loop;
+   size_t begin, end;
+   while (claimChunk(loop, &begin, &end)) {
+      if (loop->body != NULL) {
+         loop->body(loop->userData, begin, end);
+      } else if (loop->minBody != NULL) {
+         atomicMinU64(&loop->min, loop->minBody(loop->userData, begin, end));
+      } else {
+         for (size_t i = begin; i < end && i < __atomic_load_n(&loop->first, __ATOMIC_RELAXED);
+               ++i) {
+            currentIndex = i;
+            if (loop->predicate(loop->userData, i)) {
+               atomicMinSize(&loop->first, i);
+               break;
+            }
+         }
+      }
+   }
+   currentGroup = savedGroup;
+   currentLoop = savedLoop;
+   currentIndex = savedIndex;
+}
+
+// Runs a parallel loop. The calling thread takes part in the loop. Inside worker threads and if
+// there is no thread pool, the whole loop is executed by the calling thread.
+
+static void runLoop(struct ParallelLoop* loop, size_t begin)
+{
+   loop->next = begin;
+   loop->first = loop->end;
+   loop->min = UINT64_MAX;
+   loop->group = currentGroup;
+   if (loop->grain == 0) {
+      loop->grain = 1;
+   }
+   const size_t nChunks = (loop->end - begin + loop->grain - 1) / loop->grain;
+   size_t nTasks = (size_t) threadPoolSize;
+   if (nTasks + 1 > nChunks) {
+      nTasks = nChunks > 0 ? nChunks - 1 : 0;
+   }
+   if (nTasks == 0 || getThreadInfo()->threadNumber != 0) {
+      // Inline loop: one chunk, except for searches, which must stop at the first match.
+      loop->nParts = 1;
+      loop->guided = 0;
+      if (loop->predicate == NULL) {
+         loop->grain = loop->end - begin;
+      }
+      loopTask(loop, 0, 0);
+      return;
+   }
+
+   loop->nParts = nTasks + 1;
+   PexGroup_t* group = pexCreateGroup();
+   for (size_t k = 0; k < nTasks; ++k) {
+      pexExecuteRange(group, loopTask, loop, 0, 0);
+   }
+   loopTask(loop, 0, 0);
+   pexWait(group);
+}
+
+/// Executes a loop in parallel.
+///
+/// The index range [@p begin, @p end) is split into chunks, and @p body is called once for each
+/// chunk with the chunk boundaries as arguments. Chunks contain at least @p grain indexes (except
+/// for the last one). They are claimed dynamically by the calling thread and by worker threads,
+/// starting with large chunks and getting smaller towards the end of the range, so the load is
+/// balanced even if the cost per index varies. The function returns when all chunks have been
+/// processed.
+///
+/// Chunks are processed in no particular order, and @p body may be called concurrently from
+/// multiple threads. If PEX is not initialized, or if the function is called from a worker thread,
+/// @p body is called only once with the whole range.
+///
+/// If the loop is executed by a task whose group is cancelled (see @ref pexCancel), no further
+/// chunks are started, and the function returns when the running chunks are finished.
+///
+/// @param begin First index.
+/// @param end Last index plus one.
+/// @param grain Minimum chunk size. Use 1 unless the cost per index is very small.
+/// @param body Loop body.
+/// @param userData Passed unchanged to @p body.
+
+void pexParallelFor(size_t begin, size_t end, size_t grain,
+      void (*body)(void* userData, size_t begin, size_t end), void* userData)
+{
+   MTX_ASSERT(body != NULL);
+   if (begin >= end) {
+      return;
+   }
+   struct ParallelLoop loop = {
+      .end = end, .grain = grain, .guided = 1, .body = body, .userData = userData};
+   runLoop(&loop, begin);
+}
+
+/// Parallel search for the smallest index with a given property.
+///
+/// This function returns the smallest i in [@p begin, @p end) for which @p predicate returns a
+/// nonzero value, or @p end if there is no such index. @p predicate is called for all indexes
+/// below the returned value, but not necessarily for larger indexes: chunks of @p grain indexes
+/// are claimed in ascending order, and the search stops as soon as all indexes below the current
+/// candidate have been tested. Use "pexParallelFindFirst(...) != end" to check if any index has
+/// the property.
+///
+/// @p predicate may be called concurrently from multiple threads, see pexParallelFor(). Once a
+/// matching index has been found, the predicate calls for larger indexes are useless. Long running
+/// predicates should poll @ref pexIsCancelled, which returns 1 in this case, and return early. The
+/// return value of a predicate call is ignored when pexIsCancelled() was 1.
+
+size_t pexParallelFindFirst(size_t begin, size_t end, size_t grain,
+      int (*predicate)(void* userData, size_t i), void* userData)
+{
+   MTX_ASSERT(predicate != NULL);
+   if (begin >= end) {
+      return end;
+   }
+   struct ParallelLoop loop = {
+      .end = end, .grain = grain, .guided = 0, .predicate = predicate, .userData = userData};
+   runLoop(&loop, begin);
+   return loop.first;
+}
+
+/// Parallel minimum.
+///
+/// This function splits the index range [@p begin, @p end) into chunks like pexParallelFor(),
+/// calls @p body for each chunk and returns the smallest value returned by @p body. If the range
+/// is empty, the return value is UINT64_MAX.
+
+uint64_t pexParallelMin(size_t begin, size_t end, size_t grain,
+      uint64_t (*body)(void* userData, size_t begin, size_t end), void* userData)
+{
+   MTX_ASSERT(body != NULL);
+   if (begin >= end) {
+      return UINT64_MAX;
+   }
+   struct ParallelLoop loop = {
+      .end = end, .grain = grain, .guided = 1, .minBody = body, .userData = userData};
+   runLoop(&loop, begin);
+   return loop.min;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Checks if the current task has been cancelled.
+///
+/// This function returns 1 if the calling thread is executing a task whose group has been
+/// cancelled with @ref pexCancel, or a predicate call of @ref pexParallelFindFirst for an index
+/// that is larger than an already found match. Otherwise, in particular outside of tasks, the
+/// return value is 0.
+///
+/// The function is cheap enough to be called in inner loops. Long running tasks should call it
+/// regularly and return as soon as possible when the result is 1.
+
+int pexIsCancelled()
+{
+   if (isCancelled(currentGroup)) {
+      return 1;
+   }
+   const struct ParallelLoop* loop = currentLoop;
+   return loop != NULL && loop->predicate != NULL
+      && __atomic_load_n(&loop->first, __ATOMIC_RELAXED) < currentIndex;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Keeps the number of pending tasks for a group in defined limits.
@@ -0,0 +1,438 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// C MeatAxe - Blocked PLE decomposition (Gaussian elimination)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "meataxe.h"
+
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Local data
+
+// Number of rows per panel. Within a panel, rows are reduced one by one. All rows below the panel
+// are then cleaned with a single matrix multiplication.
+#define PLE_PANEL 128
+
+// Maximal number of rows cleaned with one matrix multiplication. This limits the size of the
+// temporary buffers.
+#define PLE_UPDATE_ROWS 1024
+
+// Trailing updates are distributed over the thread pool if the number of rows times the number of
+// columns times the number of pivots is at least this value.
+#define PLE_PARALLEL_MIN_WORK ((uint64_t) 1 << 24)
+
+/// @private
+typedef struct {
+   PTR a;                  // matrix
+   uint32_t noc;
+   PTR t;                  // companion matrix or NULL
+   uint32_t noct;
+   uint32_t* rowPiv;       // pivot column for each row or MTX_NVAL
+   PTR e;                  // reduced panel rows (PLE_PANEL rows of a)
+   PTR et;                 // reduced panel rows (PLE_PANEL rows of t)
+   uint32_t ePiv[PLE_PANEL];
+   PTR x;                  // negated pivot entries of the rows being updated
+   PTR y;                  // product (part of a)
+   PTR yt;                 // product (part of t)
+} Ple_t;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static PTR rowA(const Ple_t* s, uint32_t i)
+{
+   return ffGetPtr(s->a, i, s->noc);
+}
+
+static PTR rowT(const Ple_t* s, uint32_t i)
+{
+   return ffGetPtr(s->t, i, s->noct);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Reduces rows «i0»,...,«i0»+«n»-1 one by one. Each row is cleaned with the preceding independent
+// rows of the same panel, which makes the panel semi-echelon. All rows must already be clean with
+// respect to the pivots of previous panels. Returns the number of independent rows.
+// If «maxRank» independent rows have been found, the remaining rows are not processed.
+
+static uint32_t factorPanel(Ple_t* s, uint32_t i0, uint32_t n, uint32_t maxRank)
+{
+   uint32_t rank = 0;
+   for (uint32_t i = i0; i < i0 + n; ++i) {
+      if (rank >= maxRank) {
+         s->rowPiv[i] = MTX_NVAL;
+         continue;
+      }
+      PTR x = rowA(s, i);
+      for (uint32_t k = i0; k < i; ++k) {
+         const uint32_t p = s->rowPiv[k];
+         FEL f;
+         if (p != MTX_NVAL && (f = ffExtract(x, p)) != FF_ZERO) {
+            PTR xk = rowA(s, k);
+            f = ffNeg(ffDiv(f, ffExtract(xk, p)));
+            ffAddMulRowPartial(x, xk, f, p, s->noc);
+            if (s->t != NULL) {
+               ffAddMulRow(rowT(s, i), rowT(s, k), f, s->noct);
+            }
+         }
+      }
+      FEL f;
+      s->rowPiv[i] = ffFindPivot(x, &f, s->noc);
+      if (s->rowPiv[i] != MTX_NVAL) {
+         ++rank;
+      }
+   }
+   return rank;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Copies the independent rows of a panel into s->e (and s->et) and reduces them: each row gets
+// the pivot value 1, and all other rows are zero in its pivot column. Returns the number of rows.
+
+static uint32_t reducePanel(Ple_t* s, uint32_t i0, uint32_t n)
+{
+   uint32_t m = 0;
+   for (uint32_t i = i0; i < i0 + n; ++i) {
+      if (s->rowPiv[i] != MTX_NVAL) {
+         ffCopyRow(ffGetPtr(s->e, m, s->noc), rowA(s, i), s->noc);
+         if (s->t != NULL) {
+            ffCopyRow(ffGetPtr(s->et, m, s->noct), rowT(s, i), s->noct);
+         }
+         s->ePiv[m++] = s->rowPiv[i];
+      }
+   }
+
+   for (uint32_t k = m; k-- > 0; ) {
+      PTR ek = ffGetPtr(s->e, k, s->noc);
+      PTR etk = (s->t != NULL) ? ffGetPtr(s->et, k, s->noct) : NULL;
+      const uint32_t p = s->ePiv[k];
+      const FEL inv = ffInv(ffExtract(ek, p));
+      if (inv != FF_ONE) {
+         ffMulRow(ek, inv, s->noc);
+         if (etk != NULL) {
+            ffMulRow(etk, inv, s->noct);
+         }
+      }
+      for (uint32_t j = 0; j < k; ++j) {
+         PTR ej = ffGetPtr(s->e, j, s->noc);
+         const FEL f = ffExtract(ej, p);
+         if (f != FF_ZERO) {
+            ffAddMulRow(ej, ek, ffNeg(f), s->noc);
+            if (etk != NULL) {
+               ffAddMulRow(ffGetPtr(s->et, j, s->noct), etk, ffNeg(f), s->noct);
+            }
+         }
+      }
+   }
+   return m;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Cleans rows «r0»,...,«r1»-1 with the «m» reduced rows in s->e: for each row r, the product
+// (-r[ePiv]) · e is added to r. After this, the rows are zero in all pivot columns of s->e.
+// «x», «y», and «yt» are work buffers for PLE_UPDATE_ROWS rows (see Ple_t).
+
+static void cleanRowsSerial(const Ple_t* s, uint32_t m, uint32_t r0, uint32_t r1,
+      PTR x, PTR y, PTR yt)
+{
+   uint8_t nonZero[PLE_UPDATE_ROWS];
+
+   for (uint32_t c0 = r0; c0 < r1; c0 += PLE_UPDATE_ROWS) {
+      const uint32_t nr = (r1 - c0 < PLE_UPDATE_ROWS) ? r1 - c0 : PLE_UPDATE_ROWS;
+      int any = 0;
+      for (uint32_t i = 0; i < nr; ++i) {
+         PTR r = rowA(s, c0 + i);
+         PTR xi = ffGetPtr(x, i, m);
+         ffMulRow(xi, FF_ZERO, m);
+         nonZero[i] = 0;
+         for (uint32_t j = 0; j < m; ++j) {
+            const FEL f = ffExtract(r, s->ePiv[j]);
+            ffInsert(xi, j, ffNeg(f));
+            if (f != FF_ZERO) {
+               nonZero[i] = 1;
+            }
+         }
+         any |= nonZero[i];
+      }
+      if (!any) {
+         continue;
+      }
+
+      ffMulMatrix(y, x, s->e, nr, m, s->noc);
+      for (uint32_t i = 0; i < nr; ++i) {
+         if (nonZero[i]) {
+            ffAddRow(rowA(s, c0 + i), ffGetPtr(y, i, s->noc), s->noc);
+         }
+      }
+      if (s->t != NULL) {
+         ffMulMatrix(yt, x, s->et, nr, m, s->noct);
+         for (uint32_t i = 0; i < nr; ++i) {
+            if (nonZero[i]) {
+               ffAddRow(rowT(s, c0 + i), ffGetPtr(yt, i, s->noct), s->noct);
+            }
+         }
+      }
+   }
+}
+
+/// @private
+typedef struct {
+   const Ple_t* s;
+   uint32_t m;
+} PleUpdate_t;
+
+// Task function for the parallel update, see cleanRows().
+
+static void cleanRowsTask(void* userData, size_t r0, size_t r1)
+{
+   const PleUpdate_t* u = (const PleUpdate_t*) userData;
+   const Ple_t* s = u->s;
+   const uint32_t nr = (r1 - r0 < PLE_UPDATE_ROWS) ? (uint32_t) (r1 - r0) : PLE_UPDATE_ROWS;
+   PTR x = ffAlloc(nr, PLE_PANEL);
+   PTR y = ffAlloc(nr, s->noc);
+   PTR yt = (s->t != NULL) ? ffAlloc(nr, s->noct) : NULL;
+   cleanRowsSerial(s, u->m, (uint32_t) r0, (uint32_t) r1, x, y, yt);
+   ffFreeRows(x, nr, PLE_PANEL);
+   ffFreeRows(y, nr, s->noc);
+   ffFreeRows(yt, nr, s->noct);
+}
+
+// Cleans rows «r0»,...,«r1»-1, see cleanRowsSerial(). Large updates are split into row ranges
+// which are processed in parallel by the thread pool (see pexExecuteRange()). The calling thread
+// works on the last range. Inside worker threads, the update always runs serially because
+// waiting for nested tasks could block all workers.
+
+static void cleanRows(Ple_t* s, uint32_t m, uint32_t r0, uint32_t r1)
+{
+   const uint32_t nRows = r1 - r0;
+   const int nThreads = pexPoolSize();
+   const uint64_t work = (uint64_t) nRows * (s->noc + s->noct) * m;
+   if (nThreads == 0 || work < PLE_PARALLEL_MIN_WORK || pexThreadNumber() != 0) {
+      cleanRowsSerial(s, m, r0, r1, s->x, s->y, s->yt);
+      return;
+   }
+
+   uint32_t nParts = (uint32_t) nThreads + 1;
+   if (nParts > nRows / 64) {
+      nParts = nRows / 64;
+   }
+   PleUpdate_t u = {.s = s, .m = m};
+   PexGroup_t* group = pexCreateGroup();
+   uint32_t begin = r0;
+   for (uint32_t k = 1; k < nParts; ++k) {
+      const uint32_t end = r0 + (uint32_t) ((uint64_t) nRows * k / nParts);
+      pexExecuteRange(group, cleanRowsTask, &u, begin, end);
+      begin = end;
+   }
+   cleanRowsSerial(s, m, begin, r1, s->x, s->y, s->yt);
+   pexWait(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @addtogroup ff
+/// @{
+
+/// PLE decomposition.
+///
+/// This function performs a Gaussian elimination on the @p nor by @p noc matrix @p a, working
+/// on the rows in their original order. It is the common engine behind matEchelonize(),
+/// matNullSpace() and matInverse().
+///
+/// Each row of @p a is cleaned with the independent rows above it, and the first nonzero column
+/// of the cleaned row becomes its pivot column. Rows which are linear combinations of the rows
+/// above them become zero. On return, @p rowPiv[i] contains the pivot column of row i, or
+/// MTX_NVAL if the row is zero. The nonzero rows, taken in their original order, form a basis in
+/// semi-echelon form of the row space of @p a. This basis is the same as that obtained by
+/// cleaning the rows one by one with ffCleanRow(), but the computation is organized in panels:
+/// after a panel of rows has been reduced, all rows below it are cleaned at once with a single
+/// matrix multiplication (see ffMulMatrix()), which is much faster for large matrices.
+///
+/// If @p t is not NULL, it must be a matrix with @p nor rows and @p noct columns, and the same
+/// row operations are applied to @p t. For example, if @p t is the identity matrix, the rows of
+/// @p t which correspond to zero rows of @p a form a basis of the null space.
+/// If @p t is NULL, the elimination stops as soon as @p noc independent rows have been found,
+/// and all remaining rows are marked as zero without being processed.
+///
+/// If @p flags contains FF_PLE_REDUCE, the nonzero rows are additionally reduced: each of them
+/// has the value 1 in its pivot column, and all other rows are zero in this column.
+///
+/// If the thread pool is active (see pexInit()), large updates are distributed over the worker
+/// threads. The result does not depend on the number of threads.
+///
+/// The field must have been selected with ffSetField() before calling this function.
+///
+/// @return The rank of @p a, i.e., the number of nonzero rows.
+
+uint32_t ffPleDecompose(
+      PTR a, uint32_t nor, uint32_t noc, PTR t, uint32_t noct, uint32_t* rowPiv, int flags)
+{
+   Ple_t s;
+   memset(&s, 0, sizeof(s));
+   s.a = a;
+   s.noc = noc;
+   s.t = t;
+   s.noct = noct;
+   s.rowPiv = rowPiv;
+
+   const uint32_t maxRank = (t == NULL) ? noc : MTX_NVAL;
+   if (nor > PLE_PANEL || (flags & FF_PLE_REDUCE)) {
+      s.e = ffAlloc(PLE_PANEL, noc);
+      if (t != NULL) {
+         s.et = ffAlloc(PLE_PANEL, noct);
+      }
+   }
+   if (nor > PLE_PANEL) {
+      s.x = ffAlloc(PLE_UPDATE_ROWS, PLE_PANEL);
+      s.y = ffAlloc(PLE_UPDATE_ROWS, noc);
+      if (t != NULL) {
+         s.yt = ffAlloc(PLE_UPDATE_ROWS, noct);
+      }
+   }
+
+   // Forward elimination
+   uint32_t rank = 0;
+   for (uint32_t i0 = 0; i0 < nor; i0 += PLE_PANEL) {
+      const uint32_t n = (nor - i0 < PLE_PANEL) ? nor - i0 : PLE_PANEL;
+      const uint32_t m = factorPanel(&s, i0, n, maxRank - rank);
+      rank += m;
+      if (rank >= maxRank) {
+         for (uint32_t i = i0 + n; i < nor; ++i) {
+            rowPiv[i] = MTX_NVAL;
+         }
+         break;
+      }
+      if (m > 0 && i0 + n < nor) {
+         reducePanel(&s, i0, n);
+         cleanRows(&s, m, i0 + n, nor);
+      }
+   }
+
+   // Back substitution
+   if ((flags & FF_PLE_REDUCE) && nor > 0) {
+      for (uint32_t i0 = (nor - 1) / PLE_PANEL * PLE_PANEL; ; i0 -= PLE_PANEL) {
+         const uint32_t n = (nor - i0 < PLE_PANEL) ? nor - i0 : PLE_PANEL;
+         const uint32_t m = reducePanel(&s, i0, n);
+         for (uint32_t i = i0, k = 0; k < m; ++i) {
+            if (rowPiv[i] != MTX_NVAL) {
+               ffCopyRow(rowA(&s, i), ffGetPtr(s.e, k, noc), noc);
+               if (t != NULL) {
+                  ffCopyRow(rowT(&s, i), ffGetPtr(s.et, k, noct), noct);
+               }
+               ++k;
+            }
+         }
+         if (i0 == 0) {
+            break;
+         }
+         if (m > 0) {
+            cleanRows(&s, m, 0, i0);
+         }
+      }
+   }
+
+   ffFreeRows(s.e, PLE_PANEL, noc);
+   ffFreeRows(s.et, PLE_PANEL, noct);
+   ffFreeRows(s.x, PLE_UPDATE_ROWS, PLE_PANEL);
+   ffFreeRows(s.y, PLE_UPDATE_ROWS, noc);
+   ffFreeRows(s.yt, PLE_UPDATE_ROWS, noct);
+   return rank;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Rank with early exit.
+///
+/// This function calculates the rank of the @p nor by @p noc matrix @p a with the same panel
+/// algorithm as ffPleDecompose(), but it stops as soon as more than @p maxDependent rows have
+/// turned out to be linear combinations of the rows above them. It also stops when @p noc
+/// independent rows have been found.
+///
+/// Unlike ffPleDecompose(), this function does not modify @p a. Rows are copied into a work
+/// buffer block by block, and each block is cleaned with the reduced panels found so far before
+/// its panels are factored. The block size grows with the rank, from one panel up to
+/// PLE_UPDATE_ROWS rows, so that an early exit wastes little work while large matrices are still
+/// cleaned with large matrix multiplications. Rows after the block where the computation stops
+/// are never touched.
+/// Large updates are distributed over the thread pool, see ffPleDecompose().
+///
+/// The field must have been selected with ffSetField() before calling this function.
+///
+/// @return The rank of @p a, or MTX_NVAL if @p a has more than @p maxDependent dependent rows.
+
+uint32_t ffPleRank(PTR a, uint32_t nor, uint32_t noc, uint32_t maxDependent)
+{
+   uint32_t rowPiv[PLE_UPDATE_ROWS];
+   Ple_t s;
+   memset(&s, 0, sizeof(s));
+   s.a = ffAlloc(PLE_UPDATE_ROWS, noc);
+   s.noc = noc;
+   s.rowPiv = rowPiv;
+   s.x = ffAlloc(PLE_UPDATE_ROWS, PLE_PANEL);
+   s.y = ffAlloc(PLE_UPDATE_ROWS, noc);
+
+   // Reduced panels (see reducePanel()), their pivot columns, and the number of rows per panel
+   PTR basis = NULL;
+   uint32_t* basisPiv = NALLOC(uint32_t, noc);
+   uint32_t* panelRank = NALLOC(uint32_t, nor / PLE_PANEL + 1);
+   uint32_t nPanels = 0;
+
+   uint32_t rank = 0;
+   uint32_t dependent = 0;
+   int done = 0;
+   for (uint32_t b0 = 0; b0 < nor && !done; ) {
+      uint32_t nb = (rank < PLE_PANEL) ? PLE_PANEL : rank / PLE_PANEL * PLE_PANEL;
+      if (nb > PLE_UPDATE_ROWS) {
+         nb = PLE_UPDATE_ROWS;
+      }
+      if (nb > nor - b0) {
+         nb = nor - b0;
+      }
+      memcpy(s.a, ffGetPtr(a, b0, noc), ffSize(nb, noc));
+      for (uint32_t k = 0, r0 = 0; k < nPanels; r0 += panelRank[k], ++k) {
+         s.e = ffGetPtr(basis, r0, noc);
+         memcpy(s.ePiv, basisPiv + r0, panelRank[k] * sizeof(uint32_t));
+         cleanRows(&s, panelRank[k], 0, nb);
+      }
+
+      for (uint32_t i0 = 0; i0 < nb; i0 += PLE_PANEL) {
+         const uint32_t n = (nb - i0 < PLE_PANEL) ? nb - i0 : PLE_PANEL;
+         const uint32_t m = factorPanel(&s, i0, n, noc - rank);
+         dependent += n - m;
+         if (rank + m >= noc) {
+            rank += m;
+            done = 1;
+            break;
+         }
+         if (dependent > maxDependent) {
+            rank = MTX_NVAL;
+            done = 1;
+            break;
+         }
+         if (m > 0 && b0 + i0 + n < nor) {
+            basis = (PTR) sysRealloc(basis, ffSize(rank + m, noc));
+            s.e = ffGetPtr(basis, rank, noc);
+            reducePanel(&s, i0, n);
+            memcpy(basisPiv + rank, s.ePiv, m * sizeof(uint32_t));
+            panelRank[nPanels++] = m;
+            cleanRows(&s, m, i0 + n, nb);
+         }
+         rank += m;
+      }
+      b0 += nb;
+   }
+
+   sysFree(panelRank);
+   sysFree(basisPiv);
+   sysFree(basis);
+   ffFreeRows(s.y, PLE_UPDATE_ROWS, noc);
+   ffFreeRows(s.x, PLE_UPDATE_ROWS, PLE_PANEL);
+   ffFreeRows(s.a, PLE_UPDATE_ROWS, noc);
+   return rank;
+}
+
+/// @}
+
+// vim:fileencoding=utf8:sw=3:ts=8:et:cin
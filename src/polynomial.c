@@ -71,10 +71,10 @@ Poly_t *polAdd(Poly_t *dest, const Poly_t *src)
    return dest;
 }
 
-// Gives identical results for ZZZ=0 and ZZZ=1.
+// Gives identical results for all kernels.
 static inline int ffCompare(FEL a, FEL b)
 {
-#if MTX_ZZZ == 0
+#if MTX_ZZZ == 0 || MTX_ZZZ == 2
    return a > b ? 1 : ((a == b) ?  0 : -1);
 #elif MTX_ZZZ == 1
    int d = ffToInt(a) - ffToInt(b);
@@ -274,6 +274,256 @@ Poly_t *polDerive(Poly_t *pol)
    return pol;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fast arithmetic
+//
+// The functions in this section work on arrays of coefficients. An array «a» with «na» elements
+// represents a polynomial of degree less than «na». The field must have been selected by the
+// caller.
+
+/// Cutoff for Karatsuba multiplication.
+/// polMul() uses the Karatsuba algorithm if both factors have at least this number of
+/// coefficients. Smaller products, and the base case of the recursion, use the schoolbook method.
+/// The value may be changed at any time; 0 disables the Karatsuba algorithm.
+
+uint32_t polKaratsubaCutoff = 32;
+
+/// Cutoff for Newton division.
+/// polDivMod() and polMod() calculate the quotient by Newton iteration if both the divisor and the
+/// quotient have at least this degree. Otherwise, the schoolbook method is used.
+/// The value may be changed at any time; 0 disables Newton division.
+
+uint32_t polNewtonCutoff = 128;
+
+/// Cutoff for the half-GCD algorithm.
+/// polGcd() uses the half-GCD algorithm while the larger polynomial has at least this degree, and
+/// the Euclidean algorithm for the remaining steps. The value may be changed at any time; 0
+/// disables the half-GCD algorithm.
+///
+/// With Karatsuba multiplication, the half-GCD algorithm pays off only for rather large degrees.
+
+uint32_t polHalfGcdCutoff = 8192;
+
+// Inside the half-GCD recursion, polynomials below this degree (or below polHalfGcdCutoff,
+// whichever is smaller) are handled by the Euclidean algorithm.
+#define HALF_GCD_BASE_CASE 256
+
+static int useKaratsuba(int n)
+{
+   return polKaratsubaCutoff > 0 && n >= 4 && (uint32_t) n >= polKaratsubaCutoff;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Stores «a»·«b» in «r», which must have room for «na»+«nb»-1 coefficients and must not overlap
+// with the factors.
+
+static void mulSchool(FEL* r, const FEL* a, int na, const FEL* b, int nb)
+{
+   for (int i = 0; i < na + nb - 1; ++i) {
+      r[i] = FF_ZERO;
+   }
+   for (int i = 0; i < na; ++i) {
+      const FEL f = a[i];
+      if (f == FF_ZERO) {
+         continue;
+      }
+      FEL* x = r + i;
+      for (int k = 0; k < nb; ++k) {
+         x[k] = ffAdd(x[k], ffMul(f, b[k]));
+      }
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the size of the workspace needed by mulKaratsuba() for factors of size «n».
+
+static size_t karatsubaWorkSize(int n)
+{
+   size_t size = 0;
+   while (useKaratsuba(n)) {
+      const int n1 = n - n / 2;
+      size += 4 * (size_t) n1;
+      n = n1;
+   }
+   return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Karatsuba multiplication of two arrays of size «n». The product (2«n»-1 coefficients) is stored
+// in «r», which must not overlap with the factors. «work» must have room for
+// karatsubaWorkSize(«n») coefficients.
+
+static void mulKaratsuba(FEL* r, const FEL* a, const FEL* b, int n, FEL* work)
+{
+   if (!useKaratsuba(n)) {
+      mulSchool(r, a, n, b, n);
+      return;
+   }
+
+   // a = a₀ + xʰa₁, b = b₀ + xʰb₁, where a₁ and b₁ have n₁ ≥ h coefficients.
+   const int h = n / 2;
+   const int n1 = n - h;
+   FEL* const sa = work;
+   FEL* const sb = work + n1;
+   FEL* const z1 = work + 2 * n1;
+   FEL* const next = work + 4 * n1;
+
+   // a₀b₀ and a₁b₁ go directly into the result.
+   mulKaratsuba(r, a, b, h, next);
+   r[2 * h - 1] = FF_ZERO;
+   mulKaratsuba(r + 2 * h, a + h, b + h, n1, next);
+
+   // Middle term (a₀+a₁)(b₀+b₁) - a₀b₀ - a₁b₁
+   for (int i = 0; i < n1; ++i) {
+      sa[i] = i < h ? ffAdd(a[i], a[h + i]) : a[h + i];
+      sb[i] = i < h ? ffAdd(b[i], b[h + i]) : b[h + i];
+   }
+   mulKaratsuba(z1, sa, sb, n1, next);
+   for (int i = 0; i < 2 * h - 1; ++i) {
+      z1[i] = ffSub(z1[i], r[i]);
+   }
+   for (int i = 0; i < 2 * n1 - 1; ++i) {
+      z1[i] = ffSub(z1[i], r[2 * h + i]);
+   }
+   for (int i = 0; i < 2 * n1 - 1; ++i) {
+      r[h + i] = ffAdd(r[h + i], z1[i]);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Stores «a»·«b» in «r», which must have room for «na»+«nb»-1 coefficients and must not overlap
+// with the factors. If the shorter factor is large enough, the longer one is split into blocks of
+// the same size, and the blocks are multiplied with the Karatsuba algorithm.
+
+static void mulArrays(FEL* r, const FEL* a, int na, const FEL* b, int nb)
+{
+   if (na < nb) {
+      const FEL* t = a; a = b; b = t;
+      const int nt = na; na = nb; nb = nt;
+   }
+   if (!useKaratsuba(nb)) {
+      mulSchool(r, a, na, b, nb);
+      return;
+   }
+
+   FEL* const blk = NALLOC(FEL, 3 * (size_t) nb + karatsubaWorkSize(nb));
+   FEL* const prod = blk + nb;
+   FEL* const work = blk + 3 * nb;
+   for (int i = 0; i < na + nb - 1; ++i) {
+      r[i] = FF_ZERO;
+   }
+   for (int i0 = 0; i0 < na; i0 += nb) {
+      const int len = (na - i0 < nb) ? na - i0 : nb;
+      memcpy(blk, a + i0, len * sizeof(FEL));
+      for (int i = len; i < nb; ++i) {
+         blk[i] = FF_ZERO;
+      }
+      mulKaratsuba(prod, blk, b, nb, work);
+      for (int i = 0; i < len + nb - 1; ++i) {
+         r[i0 + i] = ffAdd(r[i0 + i], prod[i]);
+      }
+   }
+   sysFree(blk);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Calculates the first «n» coefficients of 1/f by Newton iteration. The power series f is given by
+// its first «nf» coefficients, and f[0] must be nonzero. The result is stored in «g».
+
+static void invertSeries(FEL* g, const FEL* f, int nf, int n)
+{
+   FEL* const t = NALLOC(FEL, 4 * (size_t) n);
+   FEL* const e = t + 2 * n;
+   FEL* const u = e + n;
+
+   g[0] = ffInv(f[0]);
+   int len = 1;
+   while (len < n) {
+      // g ← g - g·(f·g - 1) mod x^len2. Since f·g ≡ 1 (mod x^len), only the coefficients
+      // len,...,len2-1 of f·g are needed.
+      const int len2 = (2 * len < n) ? 2 * len : n;
+      const int ne = len2 - len;
+      const int nf2 = (nf < len2) ? nf : len2;
+      mulArrays(t, f, nf2, g, len);
+      for (int i = 0; i < ne; ++i) {
+         e[i] = (len + i < nf2 + len - 1) ? t[len + i] : FF_ZERO;
+      }
+      mulArrays(u, g, ne, e, ne);
+      for (int i = 0; i < ne; ++i) {
+         g[len + i] = ffNeg(u[i]);
+      }
+      len = len2;
+   }
+   sysFree(t);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static int useNewton(const Poly_t* a, const Poly_t* b)
+{
+   const uint32_t cutoff = polNewtonCutoff;
+   return cutoff > 0 && b->degree >= (int32_t) cutoff
+      && a->degree - b->degree >= (int32_t) cutoff;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Division with remainder using Newton iteration. Requires deg(«a») ≥ deg(«b») ≥ 0.
+// Replaces «a» with the remainder and returns the quotient q. With rev(p) = xᵈᵉᵍ⁽ᵖ⁾p(1/x), the
+// quotient satisfies rev(q) ≡ rev(a)/rev(b) (mod xᵐ⁺¹), where m = deg(a) - deg(b).
+// If m > deg(b), the quotient is calculated in blocks of deg(b)+1 coefficients, starting with the
+// highest powers. This needs only the inverse of rev(b) modulo x^(deg(b)+1), and the cost grows
+// linearly with m.
+
+static Poly_t* divModNewton(Poly_t* a, const Poly_t* b)
+{
+   const int db = b->degree;
+   const int m = a->degree - db;
+   const int blockSize = (m < db) ? m + 1 : db + 1;
+
+   FEL* const buf = NALLOC(FEL, 4 * (size_t) blockSize + db);
+   FEL* const rev = buf;                      // blockSize coefficients
+   FEL* const inv = rev + blockSize;          // blockSize coefficients
+   FEL* const prod = inv + blockSize;         // 2·blockSize+db-1 coefficients
+
+   for (int i = 0; i < blockSize; ++i) {
+      rev[i] = b->data[db - i];
+   }
+   invertSeries(inv, rev, blockSize, blockSize);
+
+   Poly_t* q = polAlloc(a->field, m);
+   FEL* const x = a->data;
+   for (int top = a->degree; top >= db; ) {
+      // Quotient coefficients k0,...,k0+k-1 from the top k coefficients of the current remainder.
+      const int k = (top - db + 1 < blockSize) ? top - db + 1 : blockSize;
+      const int k0 = top - db - k + 1;
+      for (int i = 0; i < k; ++i) {
+         rev[i] = x[top - i];
+      }
+      mulArrays(prod, rev, k, inv, k);
+      FEL* const qk = q->data + k0;
+      for (int i = 0; i < k; ++i) {
+         qk[i] = prod[k - 1 - i];
+      }
+
+      // Subtract xᵏ⁰·(q block)·b. This clears the coefficients k0+db,...,top.
+      mulArrays(prod, qk, k, b->data, db + 1);
+      for (int i = 0; i < k + db; ++i) {
+         x[k0 + i] = ffSub(x[k0 + i], prod[i]);
+      }
+      top -= k;
+   }
+   a->degree = db - 1;
+   polNormalize(a);
+   sysFree(buf);
+   return q;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Polynomial division.
@@ -289,6 +539,9 @@ Poly_t *polDerive(Poly_t *pol)
 /// The remainder r, is stored in @em a and replaces the original value. If you
 /// need to preserve the value of @em a you must make a copy using polDup() before
 /// calling %polDivMod(). @em b is not changed.
+///
+/// If both the quotient and @em b have large degree, the quotient is calculated by Newton
+/// iteration, see @ref polNewtonCutoff.
 /// @param a First polynomial (numerator) on call, remainder on return.
 /// @param b Second polynomial (denominator).
 /// @return The quotient or 0 on error.
@@ -319,6 +572,9 @@ Poly_t *polDivMod(Poly_t *a, const Poly_t *b)
          mtxAbort(MTX_HERE,"%s",MTX_ERR_DIV0);
          return NULL;
       }
+      if (useNewton(a, b)) {
+         return divModNewton(a, b);
+      }
       q = polAlloc(ffOrder,a->degree - b->degree);
       for (i = a->degree; i >= b->degree; --i) {
          FEL qq = ffNeg(ffDiv(a->data[i],lead));
@@ -365,6 +621,10 @@ Poly_t *polMod(Poly_t *a, const Poly_t *b)
          mtxAbort(MTX_HERE,"%s",MTX_ERR_DIV0);
          return NULL;
       }
+      if (useNewton(a, b)) {
+         polFree(divModNewton(a, b));
+         return a;
+      }
       for (i = a->degree; i >= b->degree; --i) {
          FEL qq = ffNeg(ffDiv(a->data[i],lead));
          for (k = 0; k <= b->degree; ++k) {
@@ -406,6 +666,171 @@ static void normalize(Poly_t *p, FEL f)
    }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Half-GCD
+
+// A 2×2 matrix (a b; c d) of polynomials, acting on pairs (x,y) ↦ (ax+by, cx+dy). All transforms
+// used below are products of Euclidean steps (0 1; 1 -q), so the g.c.d. is preserved.
+struct PolTransform {
+   Poly_t *a, *b, *c, *d;
+};
+
+static void trIdentity(struct PolTransform* t, int field)
+{
+   t->a = polAlloc(field, 0);
+   t->b = polAlloc(field, -1);
+   t->c = polAlloc(field, -1);
+   t->d = polAlloc(field, 0);
+}
+
+static void trFree(struct PolTransform* t)
+{
+   polFree(t->a);
+   polFree(t->b);
+   polFree(t->c);
+   polFree(t->d);
+}
+
+// Returns p·q + r·s.
+
+static Poly_t* mulAdd2(const Poly_t* p, const Poly_t* q, const Poly_t* r, const Poly_t* s)
+{
+   Poly_t* x = polMul(polDup(p), q);
+   Poly_t* y = polMul(polDup(r), s);
+   polAdd(x, y);
+   polFree(y);
+   return x;
+}
+
+// Returns «x» - «q»·«y».
+
+static Poly_t* subMul(const Poly_t* x, const Poly_t* q, const Poly_t* y)
+{
+   Poly_t* t = polMul(polDup(q), y);
+   for (int32_t i = 0; i <= t->degree; ++i) {
+      t->data[i] = ffNeg(t->data[i]);
+   }
+   return polAdd(t, x);
+}
+
+// Replaces («x»,«y») by t·(«x»,«y»).
+
+static void trApply(const struct PolTransform* t, Poly_t** x, Poly_t** y)
+{
+   Poly_t* x1 = mulAdd2(t->a, *x, t->b, *y);
+   Poly_t* y1 = mulAdd2(t->c, *x, t->d, *y);
+   polFree(*x);
+   polFree(*y);
+   *x = x1;
+   *y = y1;
+}
+
+// Replaces «t» by (0 1; 1 -q)·«t».
+
+static void trStep(struct PolTransform* t, const Poly_t* q)
+{
+   Poly_t* c = subMul(t->a, q, t->c);
+   Poly_t* d = subMul(t->b, q, t->d);
+   polFree(t->a);
+   polFree(t->b);
+   t->a = t->c;
+   t->b = t->d;
+   t->c = c;
+   t->d = d;
+}
+
+// Replaces «t» by «s»·«t».
+
+static void trCompose(const struct PolTransform* s, struct PolTransform* t)
+{
+   Poly_t* a = mulAdd2(s->a, t->a, s->b, t->c);
+   Poly_t* b = mulAdd2(s->a, t->b, s->b, t->d);
+   Poly_t* c = mulAdd2(s->c, t->a, s->d, t->c);
+   Poly_t* d = mulAdd2(s->c, t->b, s->d, t->d);
+   trFree(t);
+   t->a = a;
+   t->b = b;
+   t->c = c;
+   t->d = d;
+}
+
+// Returns «p» div xᵏ.
+
+static Poly_t* shiftDown(const Poly_t* p, int k)
+{
+   Poly_t* x = polAlloc(p->field, p->degree - k);
+   if (x->degree >= 0) {
+      memcpy(x->data, p->data + k, (x->degree + 1) * sizeof(FEL));
+   }
+   return x;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Half-GCD. Given «a» and «b» with deg(a) ≥ deg(b), calculates the transform «t» which maps (a,b)
+// to the pair (rⱼ,rⱼ₊₁) of consecutive remainders in the Euclidean algorithm with
+// deg(rⱼ) ≥ m > deg(rⱼ₊₁), where m = ⌈deg(a)/2⌉. Only the upper half of the coefficients is used
+// in each recursion step, which reduces the cost to O(M(n) log n) for M(n) the cost of
+// multiplication.
+
+static void halfGcd(struct PolTransform* t, const Poly_t* a, const Poly_t* b)
+{
+   const int m = (a->degree + 1) / 2;
+   trIdentity(t, a->field);
+   if (b->degree < m) {
+      return;
+   }
+
+   // Base case: Euclidean algorithm
+   const uint32_t baseCase =
+      polHalfGcdCutoff < HALF_GCD_BASE_CASE ? polHalfGcdCutoff : HALF_GCD_BASE_CASE;
+   if (a->degree < (int32_t) baseCase) {
+      Poly_t* x = polDup(a);
+      Poly_t* y = polDup(b);
+      while (y->degree >= m) {
+         Poly_t* q = polDivMod(x, y);
+         Poly_t* tmp = x; x = y; y = tmp;
+         trStep(t, q);
+         polFree(q);
+      }
+      polFree(x);
+      polFree(y);
+      return;
+   }
+
+   // First recursive step on the upper halves of «a» and «b».
+   Poly_t* x = shiftDown(a, m);
+   Poly_t* y = shiftDown(b, m);
+   struct PolTransform r;
+   halfGcd(&r, x, y);
+   polFree(x);
+   polFree(y);
+   trFree(t);
+   *t = r;
+   x = polDup(a);
+   y = polDup(b);
+   trApply(t, &x, &y);
+
+   if (y->degree >= m) {
+      // One Euclidean step, then the second recursive step.
+      Poly_t* q = polDivMod(x, y);
+      Poly_t* tmp = x; x = y; y = tmp;
+      trStep(t, q);
+      polFree(q);
+      const int k = 2 * m - x->degree;
+      Poly_t* x0 = shiftDown(x, k);
+      Poly_t* y0 = shiftDown(y, k);
+      struct PolTransform s;
+      halfGcd(&s, x0, y0);
+      polFree(x0);
+      polFree(y0);
+      trCompose(&s, t);
+      trFree(&s);
+   }
+   polFree(x);
+   polFree(y);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// Returns the greatest common divisor of two polynomials.
@@ -413,6 +838,7 @@ static void normalize(Poly_t *p, FEL f)
 /// The polynomials must be over the same field, and at least one of them must be different from
 /// zero. Unlike most polynomial functions, polGcd() normalizes the result,
 /// i.e., the leading coefficient of the g.c.d., is always one.
+/// For large degrees, the half-GCD algorithm is used, see @ref polHalfGcdCutoff.
 /// @see polGcdEx()
 
 Poly_t *polGcd(const Poly_t *a, const Poly_t *b)
@@ -444,7 +870,23 @@ Poly_t *polGcd(const Poly_t *a, const Poly_t *b)
       p = polDup(a);
       q = polDup(b);
    }
+   const uint32_t cutoff = polHalfGcdCutoff;
    while (q->degree >= 0) {
+      if (cutoff > 0 && p->degree >= (int32_t) cutoff && 2 * q->degree > p->degree) {
+         // Reduce p and q to about 3/4 of their degree, using only the upper halves.
+         const int m = (p->degree + 1) / 2;
+         Poly_t* p0 = shiftDown(p, m);
+         Poly_t* q0 = shiftDown(q, m);
+         struct PolTransform t;
+         halfGcd(&t, p0, q0);
+         trApply(&t, &p, &q);
+         trFree(&t);
+         polFree(p0);
+         polFree(q0);
+         if (q->degree < 0) {
+            break;
+         }
+      }
       if (polMod(p,q) == NULL) {
          return NULL;
       }
@@ -558,14 +1000,14 @@ int polGcdEx(const Poly_t *a, const Poly_t *b, Poly_t **result)
 ///
 /// This function multiplies @em dest by @em src and returns @em dest.
 /// The polynomials must be over the same field.
+/// Large products are calculated with the Karatsuba algorithm, see @ref polKaratsubaCutoff.
 /// @param dest Pointer to the first polynomial.
 /// @param src Pointer to the second polynomial.
 /// @return @em dest, or 0 on error.
 
 Poly_t *polMul(Poly_t *dest, const Poly_t *src)
 {
-   FEL *x, *y, *d, *s;
-   int di, si;
+   FEL *x, *d, *s;
    size_t xdeg;
 
    // check arguments
@@ -596,16 +1038,9 @@ Poly_t *polMul(Poly_t *dest, const Poly_t *src)
       mtxAbort(MTX_HERE,"Cannot allocate result");
       return NULL;
    }
-   for (di = xdeg, y = x; di >= 0; --di) {
-      *y++ = FF_ZERO;
-   }
 
    // multiply
-   for (di = 0; di <= dest->degree; ++di) {
-      for (si = 0; si <= src->degree; ++si) {
-         x[si + di] = ffAdd(x[si + di],ffMul(s[si],d[di]));
-      }
-   }
+   mulArrays(x, d, dest->degree + 1, s, src->degree + 1);
 
    // overwrite <dest> with the result
    sysFree(dest->data);
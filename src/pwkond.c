@@ -245,8 +245,7 @@ static void gkond(
    Matrix_t* w,
    const char* name)
 {
-   Matrix_t* x1 = matDup(k);
-   matMul(x1, w);
+   Matrix_t* x1 = matMulInto(NULL, k, w);
    Matrix_t* x2 = quotientProjection(b, x1);
    matSave(x2, strEprintf("%s%s.%s", li->baseName, latCfName(li, i), name));
    matFree(x2);
@@ -614,7 +613,12 @@ static void tryLinear2(uint32_t w, FEL f)
 
       word = wgMakeWord(CfList[i].Wg,w);
       addid(word,f);
-      nul = matNullity__(matDup(word));
+
+      // Only nullities 0 and spl are of interest. If we already have a peak word for this
+      // constituent or another constituent, the nullity must be 0.
+      const uint32_t maxNul =
+         (ppos >= 0 || CfList[i].Info->peakWord > 0) ? 0 : CfList[i].Info->spl;
+      nul = matNullityAtMost(word, maxNul);
       if ((nul != 0) && (nul != CfList[i].Info->spl)) {
          matFree(word);
          return;
@@ -625,7 +629,9 @@ static void tryLinear2(uint32_t w, FEL f)
             matFree(word);
             return;
          }
-         nul = matNullity__(matMul(matDup(word),word));
+         Matrix_t *word2 = matMulInto(NULL, word, word);
+         nul = matNullityAtMost(word2, CfList[i].Info->spl);
+         matFree(word2);
          if (nul != CfList[i].Info->spl) {
             matFree(word);
             return;      // Nullity is not stable
@@ -672,24 +678,27 @@ static void tryLinear(uint32_t w)
 
 static int tryp2(uint32_t w, int cf, Poly_t *pol)
 {
-   int i;
-
-   for (i = 0; i < NumCf; ++i) {
-      Matrix_t *word, *wordp;
-      long nul;
+   Matrix_t *word = NULL;
+   Matrix_t *wp = NULL;         // p(W), reused for all constituents
+   int result = 0;
 
+   for (int i = 0; i < NumCf && result == 0; ++i) {
       if (i == cf) {
          continue;
       }
-      word = wgMakeWord(CfList[i].Wg,w);
-      wordp = matInsert(word,pol);
-      matFree(word);
-      nul = matNullity__(wordp);
-      if (nul != 0) {
-         return -1;
+      word = wgMakeWordInto(word, CfList[i].Wg, w);
+      wp = matInsertInto(wp, word, pol);
+      if (matNullityAtMost(wp, 0) != 0) {
+         result = -1;
       }
    }
-   return 0;
+   if (wp != NULL) {
+      matFree(wp);
+   }
+   if (word != NULL) {
+      matFree(word);
+   }
+   return result;
 }
 
 
@@ -712,33 +721,38 @@ static int tryPoly(uint32_t w)
       word = wgMakeWord(CfList[i].Wg,w);
       mp = minpol(word);
       MTX_LOG2("Constituent %d, minpol = %s", i, fpToEphemeralString(mp));
+      MatPowers_t *powers = matPowersAlloc(word);       // shared by all factors
+      Matrix_t *wp = NULL;
+      Matrix_t *wp2 = NULL;
       uint32_t k;
       for (k = 0; k < mp->nFactors; ++k) {
          if (mp->factor[k]->degree * mp->mult[k] == CfList[i].Info->spl) {
-            Matrix_t *wp, *wp2;
-            long nul;
-
             MTX_LOG2("%d, factor=%s",i,polToEphemeralString(mp->factor[k]));
             if (tryp2(w,i,mp->factor[k]) == -1) {
                continue;
             }
 
             // Check if the nullity is stable
-            wp = matInsert(word,mp->factor[k]);
-            wp2 = matMul(matDup(wp),wp);
-            matFree(wp);
-            nul = matNullity__(wp2);
+            wp = matInsertPowers(wp, powers, mp->factor[k]);
+            wp2 = matMulInto(wp2, wp, wp);
+            const long nul = matNullityAtMost(wp2, CfList[i].Info->spl);
             if (nul != CfList[i].Info->spl) {
                continue;
             }
             break;
          }
       }
+      if (wp != NULL) {
+         matFree(wp);
+      }
+      if (wp2 != NULL) {
+         matFree(wp2);
+      }
 
       if (k < mp->nFactors) {
          CfList[i].Info->peakWord = w;
          replacePol(&CfList[i].Info->peakPol, polDup(mp->factor[k]));
-         CfList[i].PWNullSpace = matNullSpace__(matInsert(word,mp->factor[k]));
+         CfList[i].PWNullSpace = matNullSpace__(matInsertPowers(NULL, powers, mp->factor[k]));
          --PeakWordsMissing;
          pexExecute(NULL, peakWordFound_pex, CfList + i);
          //peakWordFound(CfList + i);
@@ -746,6 +760,7 @@ static int tryPoly(uint32_t w)
          k = -1;        // Not found
       }
       fpFree(mp);
+      matPowersFree(powers);
       matFree(word);
       if (k >= 0) {
          return i;
@@ -92,7 +92,6 @@ typedef struct SpinupContext {
    uint32_t resultSeed;         // Seed vector which produced the result
 
    struct Workspace* workspaces;// Workspace pool
-   PexGroup_t* pexGroup;
 } SpinupContext_t;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -359,19 +358,34 @@ static void destroyContext(struct SpinupContext* ctx)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void spinupOneVector(void* userData, size_t begin, size_t end)
+// Returns the number of the «index»-th seed vector (counting from 0), see svgMakeNext(). Seed
+// vector numbers have the leading digit 1 in base q: 1, q,...,2q-1, q²,...,2q²-1, ...
+
+static uint32_t makeSeedNumber(uint32_t field, size_t index)
+{
+   uint64_t blockSize = 1;
+   while (index >= blockSize) {
+      index -= blockSize;
+      blockSize *= field;
+   }
+   return (uint32_t) (blockSize + index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Spins up the «index»-th seed vector (counting from 0) and stores the result in the context.
+// Returns 1 if the seed vector produced a result, 0 otherwise.
+
+static int spinupOneVector(void* userData, size_t index)
 {
    struct SpinupContext* const ctx = (struct SpinupContext*) userData;
    MTX_ASSERT((ctx->flags & SF_MODE_MASK) != SF_COMBINE);
-   const uint32_t seedVectorNumber = (uint32_t) begin;
-   MTX_ASSERT(seedVectorNumber > 0);
+   const uint32_t seedVectorNumber = ((ctx->flags & SF_SEED_MASK) == SF_MAKE)
+      ? makeSeedNumber(ctx->field, index) : (uint32_t) index + 1;
 
    // If there is already a result for an earlier seed vector, there is nothing to do.
-   MUTEX_LOCK(ctx->mutex);
-   const int haveOlderResult = (ctx->submodule != NULL && ctx->resultSeed < seedVectorNumber);
-   MUTEX_UNLOCK(ctx->mutex);
-   if (haveOlderResult)
-      return;
+   if (pexIsCancelled())
+      return 0;
 
    MTX_LOG2("Executing spinup task for seed #%"PRIu32, seedVectorNumber);
    struct Workspace* ws = provideWorkspace(ctx);
@@ -399,9 +413,9 @@ static void spinupOneVector(void* userData, size_t begin, size_t end)
       mtxAbort(MTX_HERE, "Seed vector is zero");
    }
 
-   // Spin-up loop
+   // Spin-up loop. Stops early when an earlier seed vector has produced a result.
    uint32_t srcIndex = 0;
-   while (srcIndex < ws->dim && ws->dim <= maxSubspaceDim) {
+   while (srcIndex < ws->dim && ws->dim <= maxSubspaceDim && !pexIsCancelled()) {
       mapAndAddToBasis(ws, srcIndex, ctx->rep);
       ++srcIndex;
    }
@@ -425,57 +439,39 @@ static void spinupOneVector(void* userData, size_t begin, size_t end)
       MUTEX_UNLOCK(ctx->mutex);
    }
    returnWorkspaceToPool(ctx, ws);
+   return haveResult;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Implementation of seed vector search (spinupFindXxx). Uses threads to spin up multiple seed
-// vectors in parallel.
-   
+// vectors in parallel (see pexParallelFindFirst()). The result is always the one for the smallest
+// successful seed vector number, independent of the number of threads.
+
 static void parallelSpinup(SpinupContext_t* ctx)
 {
-   ctx->pexGroup = pexCreateGroup();
-   
-   uint32_t seedVectorNumber = 0;
-   int mayAddTasks = 1;
-   while (1) {
-      // TODO(?): Always wait for the first attempt before producing more tasks?
-      // --> mayAddTasks = -1, extend logic in pexThrottle
-
-      // Throttle task creation (keep queue size below 200%)
-      pexThrottle(ctx->pexGroup, &mayAddTasks, 200);
-
-      // Get next seed vector number or stop if the seed space is exhausted.
-      int haveSeed = 0;
-      switch (ctx->flags & SF_SEED_MASK) {
-         case SF_FIRST:
-            haveSeed = (seedVectorNumber == 0);
-            ++seedVectorNumber;
-            break;
-         case SF_EACH:
-            haveSeed = (seedVectorNumber < ctx->seed->nor);
-            ++seedVectorNumber;
-            break;
-         case SF_MAKE:
-            haveSeed = svgMakeNext(NULL, &seedVectorNumber, ctx->seed) == 0;
-            break;
-      }
-      if (!haveSeed)
+   size_t nSeeds = 0;
+   switch (ctx->flags & SF_SEED_MASK) {
+      case SF_FIRST:
+         nSeeds = 1;
          break;
-
-      // Stop if we have a result
-      MUTEX_LOCK(ctx->mutex);
-      int hasResult = ctx->submodule != NULL;
-      MUTEX_UNLOCK(ctx->mutex);
-      if (hasResult) break;
-
-      pexExecuteRange(ctx->pexGroup, spinupOneVector, ctx, seedVectorNumber, 0);
+      case SF_EACH:
+         nSeeds = ctx->seed->nor;
+         break;
+      case SF_MAKE: {
+         uint32_t first = 0;
+         svgMakeNext(NULL, &first, ctx->seed);    // checks the size of the seed space
+         uint64_t blockSize = 1;
+         for (uint32_t i = 0; i < ctx->seed->nor; ++i) {
+            nSeeds += blockSize;
+            blockSize *= ctx->field;
+         }
+         break;
+      }
    }
 
-   // Wait for running tasks.
-   MTX_LOGD("Stopped at seed #%"PRIu32, seedVectorNumber);
-   pexWait(ctx->pexGroup);
-   ctx->pexGroup = NULL;
+   const size_t index = pexParallelFindFirst(0, nSeeds, 1, spinupOneVector, ctx);
+   MTX_LOGD("Stopped at seed index %lu of %lu", (unsigned long) index, (unsigned long) nSeeds);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -392,13 +392,33 @@ int *wgDescribeWord(WgData_t *wg, uint32_t n)
 /// @return Matrix representation of the word
 
 Matrix_t *wgMakeWord(WgData_t *wg, uint32_t n)
+{
+   return wgMakeWordInto(NULL, wg, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Calculates a word into a given matrix.
+/// This function works like wgMakeWord() but stores the word in @p result. If @p result is NULL,
+/// a new matrix is created. Otherwise, the previous contents of @p result are lost. When words are
+/// tried one after the other, passing the previous word as @p result avoids allocating a new
+/// matrix for each word.
+///
+/// @note This function is not threadsafe, see wgMakeWord().
+///
+/// @param result Destination matrix or NULL.
+/// @param wg Pointer to word generator data.
+/// @param n Word number.
+/// @return Matrix representation of the word. This is @p result if it was not NULL.
+
+Matrix_t *wgMakeWordInto(Matrix_t *result, WgData_t *wg, uint32_t n)
 {
    MTX_ASSERT(n > 0);
    uint8_t n1;
    uint32_t blk;
    splitWordNumber(n, &n1, &blk);
 
-   Matrix_t *w = NULL;
+   int first = 1;
    for (int i = 0; i < 8 && n1 != 0; ++i, n1 >>= 1) {
       if (n1 % 2 == 0) {
          continue;
@@ -406,13 +426,16 @@ Matrix_t *wgMakeWord(WgData_t *wg, uint32_t n)
       if (wg->N2[i] != blk) {
          GenBasis(wg,blk,i);
       }
-      if (w == NULL) {
-         w = matDup(wg->Basis[i]);
+      const Matrix_t* b = wg->Basis[i];
+      if (first) {
+         result = mat_Prepare(result, b->field, b->nor, b->noc);
+         memcpy(result->data, b->data, ffSize(b->nor, b->noc));
+         first = 0;
       } else {
-         matAdd(w,wg->Basis[i]);
+         matAdd(result,b);
       }
    }
-   return w;
+   return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
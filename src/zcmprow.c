@@ -25,7 +25,12 @@
 
 int ffCmpRows(PTR p1, PTR p2, int noc)
 {	
+#if MTX_ZZZ == 2
+    // ffRowSizeUsed() is the packed size, compare the whole row (padding is zero).
+    return memcmp(p1,p2,ffRowSize(noc));
+#else
     return memcmp(p1,p2,ffRowSizeUsed(noc));
+#endif
 }
 
 /// @}
@@ -43,6 +43,9 @@ static MtxFile_t* fileA = NULL;
 static MtxFile_t* fileB = NULL;
 static MtxFile_t* fileC = NULL;
 
+// Number of rows of A which are multiplied at once.
+#define BLOCK_ROWS 2048
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Multiply permutation * matrix
@@ -140,6 +143,22 @@ static int multsm(MtxFile_t* fileS, MtxFile_t* fileM)
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Reading a block of A in the background, see multmm().
+
+struct ReadBlock {
+   PTR buffer;
+   uint32_t nor;
+   uint32_t noc;
+};
+
+static void readBlockTask(void* userData)
+{
+   struct ReadBlock* rb = (struct ReadBlock*) userData;
+   ffReadRows(fileA, rb->buffer, rb->nor, rb->noc);
+}
+
 /* ------------------------------------------------------------------
    multmm() - Multiply two matrices
    ------------------------------------------------------------------ */
@@ -167,21 +186,40 @@ static void multmm(void)
 	mtxAbort(MTX_HERE,"%s and %s: %s",fileNameA,fileNameB,MTX_ERR_INCOMPAT);
    
     ffSetField(fieldA);
-    PTR rowA = ffAlloc(1, nocA);
     PTR matrixB = ffAlloc(norB, nocB);
     ffReadRows(fileB,matrixB, norB, nocB);
-    PTR rowC = ffAlloc(1, nocB);
+
+    // Process A in blocks of rows. This allows ffMulMatrix() to use greased multiplication.
+    // While a block is being multiplied (possibly in parallel, see ffMulMatrix()), the next block
+    // is read by a background task.
+    const uint32_t blockSize = norA < BLOCK_ROWS ? norA : BLOCK_ROWS;
+    PTR blockA[2] = { ffAlloc(blockSize, nocA), ffAlloc(blockSize, nocA) };
+    PTR blockC = ffAlloc(blockSize, nocB);
 
     fileC = mfCreate(fileNameC, fieldA, norA, nocB);
-    for (uint32_t i = 0; i < norA; ++i)
+    int cur = 0;
+    if (norA > 0)
+        ffReadRows(fileA, blockA[cur], blockSize, nocA);
+    for (uint32_t i = 0; i < norA; i += blockSize)
     {
-        ffReadRows(fileA, rowA, 1, nocA);
-	ffMapRow(rowC, rowA, matrixB, norB, nocB);
-	ffWriteRows(fileC,rowC, 1, nocB);
+        const uint32_t n = (norA - i < blockSize) ? norA - i : blockSize;
+        PexGroup_t* readGroup = NULL;
+        struct ReadBlock next = {blockA[1 - cur], 0, nocA};
+        if (i + n < norA) {
+            next.nor = (norA - i - n < blockSize) ? norA - i - n : blockSize;
+            readGroup = pexCreateGroup();
+            pexExecute(readGroup, readBlockTask, &next);
+        }
+	ffMulMatrix(blockC, blockA[cur], matrixB, n, nocA, nocB);
+	ffWriteRows(fileC, blockC, n, nocB);
+        if (readGroup != NULL)
+            pexWait(readGroup);
+        cur = 1 - cur;
     }
-    sysFree(rowC);
+    sysFree(blockC);
+    sysFree(blockA[1]);
+    sysFree(blockA[0]);
     sysFree(matrixB);
-    sysFree(rowA);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
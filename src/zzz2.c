@@ -14,43 +14,109 @@
 /// Characteristic of the current field.
 /// Like ffOrder, this variable may be used anywhere, but it must not be modified directly.
 
-int ffChar = 0;
+MTX_THREAD_LOCAL int ffChar = 0;
 
 /// The current field order.
 /// May be used in expressions but must never modified directly. To change the field,
-/// use ffSetField().
+/// use ffSetField(). If multithreading is enabled, each thread has its own current field.
 
-uint32_t ffOrder = MTX_NVAL;
+MTX_THREAD_LOCAL uint32_t ffOrder = MTX_NVAL;
 
 /// Field generator.
 /// This variable contains a generator for the multiplicative group of the current field.
 
-FEL ffGen = 0;
+MTX_THREAD_LOCAL FEL ffGen = 0;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Blocks of at least this size are initialized by the thread pool, see ffAlloc().
+#define FF_PARALLEL_INIT_MIN ((size_t)32 << 20)
+
+struct InitRows {
+   char* p;
+   size_t rowSize;
+   int noc;
+};
+
+// Each thread keeps a few recently released row buffers for reuse, see ffFreeRows(). Buffers are
+// matched by their exact size because temporary matrices in loops usually have the same size.
+#define FF_ROW_CACHE_SLOTS 8
+#define FF_ROW_CACHE_MAX_BYTES ((size_t)64 << 20)
+
+struct CachedRows {
+   void* p;
+   size_t size;
+};
+
+static MTX_THREAD_LOCAL struct CachedRows rowCache[FF_ROW_CACHE_SLOTS];
+static MTX_THREAD_LOCAL int rowCacheSize = 0;
+static MTX_THREAD_LOCAL size_t rowCacheBytes = 0;
+
+// Removes and returns a cached buffer of the given size, or returns NULL.
+
+static void* takeCachedRows(size_t size)
+{
+   for (int i = rowCacheSize - 1; i >= 0; --i) {
+      if (rowCache[i].size == size) {
+         void* p = rowCache[i].p;
+         rowCacheBytes -= size;
+         --rowCacheSize;
+         memmove(rowCache + i, rowCache + i + 1, (rowCacheSize - i) * sizeof(rowCache[0]));
+         return p;
+      }
+   }
+   return NULL;
+}
+
+static void initRows(void* userData, size_t begin, size_t end)
+{
+   const struct InitRows* ir = (const struct InitRows*) userData;
+   char* q = ir->p + begin * ir->rowSize;
+   for (size_t i = begin; i < end; ++i) {
+      ffMulRow((PTR) q, FF_ZERO, ir->noc);
+      q += ir->rowSize;
+   }
+}
+
 /// Allocate row vectors.
 /// This function allocates a block of memory for «nor» row vectors of size «noc» over the current
 /// field (see «ffSetField()». The rows are initialized with zeroes as described in «ffMulRow()».
 /// The memory must be released with «sysFree()» when it is no longer needed. The return value is
 /// never NULL, even if «nor» or «noc» is zero.
+///
+/// If the calling thread has recently released a buffer of the same size with ffFreeRows(), that
+/// buffer is reused, which avoids the cost of malloc() and, for large blocks, page faults.
+///
+/// Large blocks are initialized in parallel by the thread pool (see pexParallelFor()). On NUMA
+/// systems, this places the memory pages near the CPUs which will later work on the rows,
+/// instead of putting all pages on the node of the allocating thread.
 
 PTR ffAlloc(int nor, int noc)
 {
-   register long i;
    MTX_ASSERT(nor >= 0);
    MTX_ASSERT(noc >= 0);
 
    const size_t rowSize = ffRowSize(noc);
    const size_t req = rowSize * (size_t) nor;
 
-   PTR p = (PTR) sysMalloc(req);
+   PTR p = (PTR) takeCachedRows(req);
+   if (p == NULL) {
+      p = (PTR) sysMalloc(req);
+   }
 
    // Initialize all rows with zeroes.
-   char* q = (char *) p;
-   for (i = nor; i > 0; --i) {
-      ffMulRow((PTR) q, FF_ZERO, noc);
-      q += rowSize;
+   struct InitRows ir = {(char*) p, rowSize, noc};
+   if (req >= FF_PARALLEL_INIT_MIN && !pexIsCancelled()) {
+      const size_t grain = ((size_t) 1 << 20) / rowSize + 1;
+      pexParallelFor(0, (size_t) nor, grain, initRows, &ir);
+
+      // The loop skips the remaining chunks if the calling task is cancelled meanwhile, see
+      // pexParallelFor(). The rows must be initialized anyway.
+      if (pexIsCancelled()) {
+         initRows(&ir, 0, (size_t) nor);
+      }
+   } else {
+      initRows(&ir, 0, (size_t) nor);
    }
    return p;
 }
@@ -69,6 +135,58 @@ void ffFree(PTR x)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/// Free row vectors.
+/// This function works like ffFree() but may keep the memory in a small per-thread cache, so that
+/// a subsequent ffAlloc() call for the same number of rows and columns can reuse it. «nor» and
+/// «noc» must be the dimensions used in ffAlloc() (or smaller ones), and the current field must
+/// be the same. If «x» is NULL, the function does nothing.
+///
+/// Use this function for temporary buffers which are allocated repeatedly, for example in loops.
+
+void ffFreeRows(PTR x, int nor, int noc)
+{
+   if (x == NULL) {
+      return;
+   }
+   const size_t size = ffRowSize(noc) * (size_t) nor;
+   if (size > FF_ROW_CACHE_MAX_BYTES / 2) {
+      sysFree(x);
+      return;
+   }
+   // Evict the oldest buffers if necessary.
+   int n = 0;
+   while (n < rowCacheSize && (rowCacheSize - n >= FF_ROW_CACHE_SLOTS
+            || rowCacheBytes + size > FF_ROW_CACHE_MAX_BYTES)) {
+      sysFree(rowCache[n].p);
+      rowCacheBytes -= rowCache[n].size;
+      ++n;
+   }
+   if (n > 0) {
+      rowCacheSize -= n;
+      memmove(rowCache, rowCache + n, rowCacheSize * sizeof(rowCache[0]));
+   }
+   rowCache[rowCacheSize].p = x;
+   rowCache[rowCacheSize].size = size;
+   ++rowCacheSize;
+   rowCacheBytes += size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Releases all buffers in the row buffer cache of the calling thread, see ffFreeRows().
+/// Threads which have used ffFreeRows() should call this function before they terminate.
+
+void ffFlushRowCache()
+{
+   for (int i = 0; i < rowCacheSize; ++i) {
+      sysFree(rowCache[i].p);
+   }
+   rowCacheSize = 0;
+   rowCacheBytes = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 /// Copy a row.
 /// This function copies the contents of one row to another row.
 /// @param dest Pointer to the destination.
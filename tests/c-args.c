@@ -293,4 +293,35 @@ TstResult App_CommonOptions2()
    return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void sumTask(void* userData, size_t begin, size_t end)
+{
+   __atomic_add_fetch((size_t*) userData, end - begin, __ATOMIC_SEQ_CST);
+}
+
+TstResult App_ThreadOptions()
+{
+   static char* const argv[] = { "---", "-j", "auto", "--pin" };
+   const int argc = (sizeof(argv) / sizeof(argv[0]));
+   const int nCpus = sysCpuCount();
+   MtxApplication_t* app = appAlloc(NULL, argc, argv);
+#if defined(MTX_DEFAULT_THREADS)
+   ASSERT_EQ_INT(pexPoolSize(), nCpus - 1);
+#else
+   ASSERT_EQ_INT(pexPoolSize(), 0);
+#endif
+   ASSERT_EQ_INT(appGetOption(app, "--pin"), 0);    // already consumed
+   size_t sum = 0;
+   pexParallelFor(0, 1000, 1, sumTask, &sum);
+   ASSERT_EQ_INT(sum, 1000);
+   appFree(app);
+   pexShutdown();
+   pexPinThreads(0);
+
+   // The main thread's affinity is restored.
+   ASSERT_EQ_INT(sysCpuCount(), nCpus);
+   return 0;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -45,4 +45,78 @@ TstResult CharacteristicPolynomial()
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Writes the companion matrix of the monic polynomial «pol» into «mat» at row and column «pos».
+
+static void insertCompanionMatrix(Matrix_t* mat, const Poly_t* pol, int pos)
+{
+   const int n = pol->degree;
+   for (int i = 0; i < n - 1; ++i) {
+      ffInsert(matGetPtr(mat, pos + i), pos + i + 1, FF_ONE);
+   }
+   for (int k = 0; k < n; ++k) {
+      ffInsert(matGetPtr(mat, pos + n - 1), pos + k, ffNeg(pol->data[k]));
+   }
+}
+
+// Checks that charpolFactor() returns exactly «p1» and «p2» for the direct sum of their companion
+// matrices. Both polynomials have degree at least 1.
+
+static int checkCompanionMatrices(const Poly_t* p1, const Poly_t* p2)
+{
+   const int n1 = p1->degree;
+   const int n = n1 + p2->degree;
+   Matrix_t* mat = matAlloc(ffOrder, n, n);
+   insertCompanionMatrix(mat, p1, 0);
+   insertCompanionMatrix(mat, p2, n1);
+
+   Charpol_t* state = charpolStart(mat, PM_CHARPOL, 0);
+   Poly_t* f1 = charpolFactor(state);
+   Poly_t* f2 = charpolFactor(state);
+   const int ok = polCompare(f1, p1) == 0 && polCompare(f2, p2) == 0
+      && charpolFactor(state) == NULL;
+   polFree(f1);
+   polFree(f2);
+   charpolFree(state);
+   matFree(mat);
+   if (!ok) {
+      TST_FAIL("Wrong factors for degrees %d and %d", n1, p2->degree);
+   }
+   return 0;
+}
+
+TstResult CharacteristicPolynomial_CompanionMatrix(int q)
+{
+   int result = 0;
+   for (int i = 0; i < 10 && result == 0; ++i) {
+      Poly_t* p1 = RndPol(q, 1, 60);
+      Poly_t* p2 = RndPol(q, 1, 60);
+      result |= checkCompanionMatrices(p1, p2);
+
+      // A single cyclic subspace spanning the whole space
+      if (result == 0) {
+         Matrix_t* mat = matAlloc(q, p1->degree, p1->degree);
+         insertCompanionMatrix(mat, p1, 0);
+         FPoly_t* cp = charpol(mat);
+         Poly_t* prod = polAlloc(q, 0);
+         for (uint32_t k = 0; k < cp->nFactors; ++k) {
+            for (int e = 0; e < cp->mult[k]; ++e) {
+               polMul(prod, cp->factor[k]);
+            }
+         }
+         if (polCompare(prod, p1) != 0) {
+            tstFail(TST_HERE, "charpol() failed for degree %d", p1->degree);
+            result = 1;
+         }
+         polFree(prod);
+         fpFree(cp);
+         matFree(mat);
+      }
+      polFree(p1);
+      polFree(p2);
+   }
+   return result;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
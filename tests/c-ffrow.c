@@ -7,6 +7,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
  
@@ -48,4 +49,78 @@ TstResult ScalarProduct_WorksForNocEqualsZero(int q)
    return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult FreeRows_BuffersAreReusedAndCleared(int q)
+{
+   const int nor = 10, noc = 100;
+   PTR a = ffAlloc(nor, noc);
+   for (int i = 0; i < nor; ++i) {
+      for (int k = 0; k < noc; ++k) {
+         ffInsert(ffGetPtr(a, i, noc), k, FTab[mtxRandomInt(ffOrder)]);
+      }
+   }
+   ffFreeRows(a, nor, noc);
+   PTR b = ffAlloc(nor, noc);
+   ASSERT(b == a);
+   FEL mark;
+   for (int i = 0; i < nor; ++i) {
+      ASSERT_EQ_INT(ffFindPivot(ffGetPtr(b, i, noc), &mark, noc), MTX_NVAL);
+   }
+   ffFreeRows(b, nor, noc);
+
+   // Different sizes, more buffers than cache slots.
+   PTR c[20];
+   for (int i = 0; i < 20; ++i) {
+      c[i] = ffAlloc(i + 1, noc);
+   }
+   for (int i = 0; i < 20; ++i) {
+      ffFreeRows(c[i], i + 1, noc);
+   }
+   PTR d = ffAlloc(20, noc);
+   ASSERT(d == c[19]);
+   ffFree(d);
+   ffFreeRows(NULL, 1, 1);
+   ffFlushRowCache();
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct CancelledAlloc {
+   PexGroup_t* group;
+   int ok;
+};
+
+// Cancels its own group and allocates a large block, which reuses a dirty buffer.
+
+static void cancelledAllocTask(void* userData)
+{
+   struct CancelledAlloc* t = (struct CancelledAlloc*) userData;
+   const int noc = 4096;
+   const int nor = (int) (((size_t) 32 << 20) / ffRowSize(noc));
+   PTR a = ffAlloc(nor, noc);
+   memset(a, 0x55, ffSize(nor, noc));
+   ffFreeRows(a, nor, noc);
+   pexCancel(t->group);
+   PTR b = ffAlloc(nor, noc);
+   FEL mark;
+   t->ok = pexIsCancelled();
+   for (int i = 0; i < nor && t->ok; ++i) {
+      t->ok = ffFindPivot(ffGetPtr(b, i, noc), &mark, noc) == MTX_NVAL;
+   }
+   ffFree(b);
+   ffFlushRowCache();
+}
+
+TstResult Alloc_LargeBlocksAreClearedInCancelledTasks()
+{
+   struct CancelledAlloc t = {0};
+   t.group = pexCreateGroup();
+   pexExecute(t.group, cancelledAllocTask, &t);
+   pexWait(t.group);
+   ASSERT(t.ok);
+   return 0;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -16,7 +16,11 @@ TstResult FileIo()
 //    Poly_t *pol1, *pol2;
    Perm_t* perm2;
 
+#if MTX_ZZZ == 2
+   SelectField(3);
+#else
    SelectField(5);
+#endif
    MtxFile_t* f = mfOpen("check.1", "wb");
 //    mat1 = RndMat(5,30,30);
 //    matSave(mat1,"check.ma1");
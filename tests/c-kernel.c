@@ -367,6 +367,12 @@ static int TestSubfield1(int fld, int sub)
 TstResult Kernel_Field_Subfields()
 {
    int result = 0;
+   #if MTX_ZZZ == 2
+   result |= TestSubfield1(16,2);
+   result |= TestSubfield1(16,4);
+   result |= TestSubfield1(8,2);
+   result |= TestSubfield1(4,2);
+   #else
    result |= TestSubfield1(256,2);
    result |= TestSubfield1(256,4);
    result |= TestSubfield1(256,16);
@@ -388,6 +394,7 @@ TstResult Kernel_Field_Subfields()
    result |= TestSubfield1(49,7);
 
    result |= TestSubfield1(121,11);
+   #endif
 
    #if MTX_ZZZ == 1
    result |= TestSubfield1(65536, 2);
@@ -616,6 +623,17 @@ TstResult Kernel_RowOps_RowSize(int q)
 {
    for (int noc = 0; noc < 100; ++noc) {
       int rs = ffRowSize(noc);
+      #if MTX_ZZZ == 2
+      // Bit-sliced rows: one 64-bit word per plane and 64 columns. ffRowSizeUsed() is the size
+      // in data files and not related to the row size.
+      int planes = 0;
+      while ((1 << planes) < q) {
+         ++planes;
+      }
+      if (rs != (noc + 63) / 64 * planes * 8) {
+         TST_FAIL("ffRowSize(%d) = %d out of range",noc,rs);
+      }
+      #else
       if ((rs < 0) || (rs > noc * sizeof(FEL) + sizeof(long))) {
          TST_FAIL("ffRowSize(%d) = %d out of range",noc,rs);
       }
@@ -623,6 +641,7 @@ TstResult Kernel_RowOps_RowSize(int q)
       if ((diff < 0) || (diff >= sizeof(long))) {
          TST_FAIL("ffRowSize() and ffRowSizeUsed() differ too much (noc=%d)", noc);
       }
+      #endif
    }
    return 0;
 }
@@ -670,4 +689,297 @@ TstResult Kernel_RowOps_CmpRows(int q)
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Row operations on long rows, where vectorized code paths are used. The results are checked
+// element by element.
+
+static int TestWideRowOps(PTR x, PTR y, FEL* xx, FEL* yy, int noc, FEL f, int first)
+{
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = RandomFieldElement();
+      yy[i] = RandomFieldElement();
+      ffInsert(x, i, xx[i]);
+      ffInsert(y, i, yy[i]);
+   }
+   ffAddMulRow(x, y, f, noc);
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = ffAdd(xx[i], ffMul(yy[i], f));
+      ASSERT_EQ_INT(ffExtract(x, i), xx[i]);
+   }
+   ffMulRow(x, f, noc);
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = ffMul(xx[i], f);
+      ASSERT_EQ_INT(ffExtract(x, i), xx[i]);
+   }
+   ffAddRow(x, y, noc);
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = ffAdd(xx[i], yy[i]);
+      ASSERT_EQ_INT(ffExtract(x, i), xx[i]);
+   }
+
+   // Partial operations require zeroes before the first column.
+   for (int i = 0; i < first; ++i) {
+      xx[i] = yy[i] = FF_ZERO;
+      ffInsert(x, i, FF_ZERO);
+      ffInsert(y, i, FF_ZERO);
+   }
+   ffAddMulRowPartial(x, y, f, first, noc);
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = ffAdd(xx[i], ffMul(yy[i], f));
+      ASSERT_EQ_INT(ffExtract(x, i), xx[i]);
+   }
+   ffAddRowPartial(x, y, first, noc);
+   for (int i = 0; i < noc; ++i) {
+      xx[i] = ffAdd(xx[i], yy[i]);
+      ASSERT_EQ_INT(ffExtract(x, i), xx[i]);
+   }
+   return 0;
+}
+
+TstResult Kernel_RowOps_WideRows(int q)
+{
+   static const int nocs[] = { 100, 257, 1000, 2049 };
+   int result = 0;
+   for (int n = 0; result == 0 && n < 4; ++n) {
+      const int noc = nocs[n];
+      PTR x = ffAlloc(1, noc);
+      PTR y = ffAlloc(1, noc);
+      FEL* xx = NALLOC(FEL, noc);
+      FEL* yy = NALLOC(FEL, noc);
+      for (int k = 0; result == 0 && k < 10; ++k) {
+         const FEL f = RandomNonzeroFieldElement();
+         result |= TestWideRowOps(x, y, xx, yy, noc, f, (k * 37) % noc);
+      }
+      ffFree(x);
+      ffFree(y);
+      sysFree(xx);
+      sysFree(yy);
+   }
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Checks ffMapRow() and ffScalarProduct() with enough terms to overflow 32-bit accumulators in
+// GF(251) if the delayed reduction is missing. All entries are -1, so each result is nor·1.
+
+TstResult Kernel_RowOps_LongSums(int q)
+{
+   const int nor = 70001;
+   const int noc = 10;
+   const FEL minusOne = ffNeg(FF_ONE);
+   const FEL expected = ffFromInt(nor % ffChar);
+
+   PTR row = ffAlloc(1, nor);
+   PTR row2 = ffAlloc(1, nor);
+   PTR mat = ffAlloc(nor, noc);
+   PTR result = ffAlloc(1, noc);
+   for (int i = 0; i < nor; ++i) {
+      ffInsert(row, i, minusOne);
+      ffInsert(row2, i, minusOne);
+      PTR m = ffGetPtr(mat, i, noc);
+      for (int k = 0; k < noc; ++k) {
+         ffInsert(m, k, minusOne);
+      }
+   }
+
+   ASSERT_EQ_INT(ffScalarProduct(row, row2, nor), expected);
+   ffMapRow(result, row, mat, nor, noc);
+   for (int k = 0; k < noc; ++k) {
+      ASSERT_EQ_INT(ffExtract(result, k), expected);
+   }
+
+   ffFree(row);
+   ffFree(row2);
+   ffFree(mat);
+   ffFree(result);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Compares row operations with element-wise arithmetic in the given field.
+
+static int checkRowOpsElementwise(int field)
+{
+   const int noc = 1003;
+   const int nor = 100;
+   SelectField(field);
+
+   PTR a = ffAlloc(1, noc);
+   PTR b = ffAlloc(1, noc);
+   PTR v = ffAlloc(1, nor);
+   PTR mat = ffAlloc(nor, noc);
+   PTR result = ffAlloc(1, noc);
+   for (int i = 0; i < noc; ++i) {
+      ffInsert(a, i, RandomFieldElement());
+      ffInsert(b, i, RandomFieldElement());
+   }
+   for (int i = 0; i < nor; ++i) {
+      ffInsert(v, i, RandomFieldElement());
+      PTR m = ffGetPtr(mat, i, noc);
+      for (int k = 0; k < noc; ++k) {
+         ffInsert(m, k, RandomFieldElement());
+      }
+   }
+
+   // Scalar product
+   FEL sp = FF_ZERO;
+   for (int i = 0; i < noc; ++i) {
+      sp = ffAdd(sp, ffMul(ffExtract(a, i), ffExtract(b, i)));
+   }
+   ASSERT_EQ_INT(ffScalarProduct(a, b, noc), sp);
+
+   // Vector times matrix
+   ffMapRow(result, v, mat, nor, noc);
+   for (int k = 0; k < noc; ++k) {
+      FEL x = FF_ZERO;
+      for (int i = 0; i < nor; ++i) {
+         x = ffAdd(x, ffMul(ffExtract(v, i), ffExtract(ffGetPtr(mat, i, noc), k)));
+      }
+      ASSERT_EQ_INT(ffExtract(result, k), x);
+   }
+
+   // Multiply and add
+   const FEL f = ffFromInt(12347 % ffOrder);
+   memcpy(result, a, ffRowSize(noc));
+   ffAddMulRow(result, b, f, noc);
+   for (int k = 0; k < noc; ++k) {
+      ASSERT_EQ_INT(ffExtract(result, k), ffAdd(ffExtract(a, k), ffMul(f, ffExtract(b, k))));
+   }
+
+   // Multiply
+   memcpy(result, a, ffRowSize(noc));
+   ffMulRow(result, f, noc);
+   for (int k = 0; k < noc; ++k) {
+      ASSERT_EQ_INT(ffExtract(result, k), ffMul(f, ffExtract(a, k)));
+   }
+
+   ffFree(a);
+   ffFree(b);
+   ffFree(v);
+   ffFree(mat);
+   ffFree(result);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Field contexts can be created for several fields and bound to the current thread.
+
+TstResult Kernel_FieldContext_Basics()
+{
+   const FfContext_t* gf3 = ffContext(3);
+   const FfContext_t* gf4 = ffContext(4);
+   ASSERT(gf3 != NULL && gf4 != NULL && gf3 != gf4);
+   ASSERT(ffContext(3) == gf3);
+   ffSetField(4);
+   ASSERT(ffCurrentContext() == gf4);
+
+   ffBindContext(gf3);
+   ASSERT_EQ_INT(ffOrder, 3);
+   ASSERT_EQ_INT(ffChar, 3);
+   ASSERT_EQ_INT(ffToInt(ffAdd(ffFromInt(2), ffFromInt(2))), 1);
+   ffBindContext(gf4);
+   ASSERT_EQ_INT(ffOrder, 4);
+   ASSERT_EQ_INT(ffChar, 2);
+   ASSERT_EQ_INT(ffToInt(ffAdd(ffFromInt(2), ffFromInt(2))), 0);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Row operations for the largest supported prime field. With ZZZ=1, rows use the linear
+// representation in this case.
+
+TstResult Kernel_RowOps_LargePrime()
+{
+#if MTX_ZZZ == 1
+   return checkRowOpsElementwise(65521);
+#elif MTX_ZZZ == 2
+   return checkRowOpsElementwise(3);
+#else
+   return checkRowOpsElementwise(251);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Row operations for the largest supported field of characteristic 2.
+
+TstResult Kernel_RowOps_LargeChar2()
+{
+#if MTX_ZZZ == 1
+   return checkRowOpsElementwise(65536);
+#elif MTX_ZZZ == 2
+   return checkRowOpsElementwise(16);
+#else
+   return checkRowOpsElementwise(256);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#if MTX_ZZZ == 0 || MTX_ZZZ == 1
+
+// Returns the instruction set which should be selected with MTX_SIMD=«limit».
+
+static const char* expectedSimd(const char* limit)
+{
+   const char* levels[] = {"avx512", "avx2", "sse4.1", "none"};
+   int i = 0;
+   while (strcmp(levels[i], limit)) {
+      ++i;
+   }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+   __builtin_cpu_init();
+   if (i == 0 && !__builtin_cpu_supports("avx512bw")) {
+      ++i;
+   }
+   if (i == 1 && !__builtin_cpu_supports("avx2")) {
+      ++i;
+   }
+   if (i == 2 && !__builtin_cpu_supports("sse4.1")) {
+      ++i;
+   }
+   return levels[i];
+#else
+   return "none";
+#endif
+}
+
+#endif
+
+// MTX_SIMD limits the instruction set used for row operations.
+
+TstResult Kernel_SimdSelection()
+{
+#if MTX_ZZZ == 0 || MTX_ZZZ == 1
+   const char* oldLimit = getenv("MTX_SIMD");
+   char* saved = oldLimit != NULL ? strdup(oldLimit) : NULL;
+   const char* limits[] = {"none", "sse4.1", "avx2", "avx512"};
+   for (int i = 0; i < 4; ++i) {
+      setenv("MTX_SIMD", limits[i], 1);
+      const char* name = ffSelectSimd();
+      ASSERT(strcmp(name, expectedSimd(limits[i])) == 0);
+      ASSERT(checkRowOpsElementwise(3) == 0);
+   #if MTX_ZZZ == 1
+      ASSERT(checkRowOpsElementwise(65521) == 0);
+      ASSERT(checkRowOpsElementwise(65536) == 0);
+   #else
+      ASSERT(checkRowOpsElementwise(256) == 0);
+   #endif
+   }
+   if (saved != NULL) {
+      setenv("MTX_SIMD", saved, 1);
+      free(saved);
+   } else {
+      unsetenv("MTX_SIMD");
+   }
+   ffSelectSimd();
+#endif
+   return 0;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -57,3 +57,74 @@ TstResult Matrix_InsertIntoPolynomial(int q)
 
    return 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Calculates p(A) with the Horner scheme, using only matMul().
+
+static Matrix_t* insertNaive(const Matrix_t* a, const Poly_t* p)
+{
+   Matrix_t* r = matAlloc(a->field, a->nor, a->noc);
+   for (int i = p->degree; i >= 0; --i) {
+      matMul(r, a);
+      for (uint32_t k = 0; k < a->nor; ++k) {
+         PTR x = matGetPtr(r, k);
+         ffInsert(x, k, ffAdd(ffExtract(x, k), p->data[i]));
+      }
+   }
+   return r;
+}
+
+TstResult Matrix_InsertIntoGivenMatrix(int q)
+{
+   Matrix_t* const mat = RndMat(ffOrder, 20, 20);
+   Matrix_t* result = NULL;
+   for (int deg = -1; deg < 8; ++deg) {
+      Poly_t* p = deg < 0 ? polAlloc(ffOrder, -1) : RndPol(ffOrder, deg, deg);
+      Matrix_t* expected = insertNaive(mat, p);
+      result = matInsertInto(result, mat, p);
+      ASSERT_EQ_INT(matCompare(result, expected), 0);
+      Matrix_t* a = matInsert_(matDup(mat), p);
+      ASSERT_EQ_INT(matCompare(a, expected), 0);
+      matFree(a);
+      matFree(expected);
+      polFree(p);
+   }
+   Poly_t* x = polAlloc(ffOrder, 1);
+   ASSERT_ABORT(matInsertInto(mat, mat, x));
+   polFree(x);
+   matFree(result);
+   matFree(mat);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Matrix_InsertWithPowerTable(int q)
+{
+   static const int degrees[] = { 30, 1, 2, 5, 40, 17, 0, 3, 64, 16, 8 };
+   Matrix_t* const mat = RndMat(ffOrder, 15, 15);
+   MatPowers_t* powers = matPowersAlloc(mat);
+   Matrix_t* result = NULL;
+   for (size_t i = 0; i < sizeof(degrees) / sizeof(degrees[0]); ++i) {
+      Poly_t* p = RndPol(ffOrder, degrees[i], degrees[i]);
+      Matrix_t* expected = insertNaive(mat, p);
+      result = matInsertPowers(result, powers, p);
+      ASSERT_EQ_INT(matCompare(result, expected), 0);
+
+      // Without power table
+      Matrix_t* a = matInsert(mat, p);
+      ASSERT_EQ_INT(matCompare(a, expected), 0);
+      matFree(a);
+
+      // Reuse the result buffer for the nullity
+      const uint32_t nul = matNullity(expected);
+      ASSERT_EQ_INT(matNullity_(result), nul);
+      matFree(expected);
+      polFree(p);
+   }
+   matPowersFree(powers);
+   matFree(result);
+   matFree(mat);
+   return 0;
+}
@@ -335,6 +335,139 @@ TstResult Matrix_NullSpace(int q)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Random matrix with «nor» rows and rank at most «rank». The dependent rows are spread over the
+// whole matrix.
+
+static Matrix_t *RndMatWithRank(int nor, int noc, int rank)
+{
+   Matrix_t *a = RndMat(ffOrder, rank, nor);
+   Matrix_t *b = RndMat(ffOrder, rank, noc);
+   Matrix_t *c = matTransposed(a);
+   matMul(c, b);
+   matFree(a);
+   matFree(b);
+   return c;
+}
+
+// Row-by-row echelonization, for comparison with matEchelonize().
+
+static Matrix_t *RefEchelonize(const Matrix_t *mat)
+{
+   Matrix_t *work = matAlloc(mat->field, mat->nor, mat->noc);
+   uint32_t *piv = NALLOC(uint32_t, mat->noc + 1);
+   uint32_t rank = 0;
+   for (uint32_t i = 0; i < mat->nor; ++i) {
+      FEL f;
+      PTR row = matGetPtr(work, rank);
+      ffCopyRow(row, matGetPtr(mat, i), mat->noc);
+      ffCleanRow(row, work->data, rank, mat->noc, piv);
+      if ((piv[rank] = ffFindPivot(row, &f, mat->noc)) != MTX_NVAL) {
+         ++rank;
+      }
+   }
+   Matrix_t *ech = matDupRows(work, 0, rank);
+   matFree(work);
+   sysFree(piv);
+   return ech;
+}
+
+static int TestBlockedElimination(int nor, int noc, int rank)
+{
+   Matrix_t *a = RndMatWithRank(nor, noc, rank);
+   const uint32_t expectedRank = noc - matNullity(a);
+
+   // Echelon form must be identical to the row-by-row algorithm
+   Matrix_t *ech = matDup(a);
+   Matrix_t *ref = RefEchelonize(a);
+   ASSERT_EQ_INT(matEchelonize(ech), ref->nor);
+   ASSERT(ChkEch(ech) == 0);
+   ASSERT(matCompare(ech, ref) == 0);
+   ASSERT_EQ_INT(expectedRank, ref->nor);
+
+   // matNullity_() keeps the buffer
+   Matrix_t *tmp = matDup(a);
+   ASSERT_EQ_INT(matNullity_(tmp), noc - expectedRank);
+   ASSERT_EQ_INT(tmp->nor, nor);
+   ASSERT_EQ_INT(tmp->noc, noc);
+   matFree(tmp);
+
+   // Bounded nullity, must not modify the matrix
+   const uint32_t nul = noc - expectedRank;
+   tmp = matDup(a);
+   ASSERT_EQ_INT(matNullityAtMost(a, nul), nul);
+   ASSERT_EQ_INT(matNullityAtMost(a, nul + 3), nul);
+   if (nul > 0) {
+      ASSERT_EQ_INT(matNullityAtMost(a, nul - 1), nul);
+      ASSERT_EQ_INT(matNullityAtMost(a, 0), 1);
+   }
+   ASSERT(matCompare(a, tmp) == 0);
+   matFree(tmp);
+
+   // Null space
+   Matrix_t *nsp = matNullSpace(a);
+   ASSERT_EQ_INT(nsp->nor, nor - expectedRank);
+   Matrix_t *nspEch = matDup(nsp);
+   ASSERT_EQ_INT(matEchelonize(nspEch), nsp->nor);
+   ASSERT(matCompare(nsp, nspEch) == 0);
+   matMul(nsp, a);
+   for (uint32_t i = 0; i < nsp->nor; ++i) {
+      FEL f;
+      ASSERT(ffFindPivot(matGetPtr(nsp, i), &f, nsp->noc) == MTX_NVAL);
+   }
+
+   matFree(nspEch);
+   matFree(nsp);
+   matFree(ref);
+   matFree(ech);
+   matFree(a);
+   return 0;
+}
+
+static int TestBlockedInversion(int dim)
+{
+   // Product of triangular matrices with nonzero diagonal is invertible
+   Matrix_t *l = RndMat(ffOrder, dim, dim);
+   Matrix_t *u = RndMat(ffOrder, dim, dim);
+   for (int i = 0; i < dim; ++i) {
+      PTR lx = matGetPtr(l, i);
+      PTR ux = matGetPtr(u, i);
+      for (int k = 0; k < dim; ++k) {
+         if (k > i) {
+            ffInsert(lx, k, FF_ZERO);
+         }
+         if (k < i) {
+            ffInsert(ux, k, FF_ZERO);
+         }
+      }
+      ffInsert(lx, i, FTab[1 + mtxRandomInt(ffOrder - 1)]);
+      ffInsert(ux, i, FF_ONE);
+   }
+   matMul(l, u);
+   Matrix_t *li = matInverse(l);
+   matMul(li, l);
+   Matrix_t *id = matId(ffOrder, dim);
+   ASSERT(matCompare(li, id) == 0);
+   matFree(id);
+   matFree(li);
+   matFree(l);
+   matFree(u);
+   return 0;
+}
+
+TstResult Matrix_BlockedElimination(int q)
+{
+   int result = 0;
+   result |= TestBlockedElimination(300, 200, 150);
+   result |= TestBlockedElimination(260, 300, 260);
+   result |= TestBlockedElimination(129, 50, 50);
+   result |= TestBlockedElimination(400, 420, 0);
+   result |= TestBlockedInversion(300);
+   result |= TestBlockedInversion(129);
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 TstResult Matrix_Order(int q)
 {
    Matrix_t *a;
@@ -477,6 +610,131 @@ TstResult Matrix_MultiplyAdd(int q)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Multiplies a by b row by row using ffMapRow() and compares with matMul().
+
+static int TestMatMul1(int nor, int mid, int noc)
+{
+   Matrix_t *a = RndMat(ffOrder, nor, mid);
+   Matrix_t *b = RndMat(ffOrder, mid, noc);
+   Matrix_t *expected = matAlloc(ffOrder, nor, noc);
+   for (int i = 0; i < nor; ++i) {
+      ffMapRow(matGetPtr(expected, i), matGetPtr(a, i), b->data, mid, noc);
+   }
+   matMul(a, b);
+   ASSERT(matCompare(a, expected) == 0);
+   matFree(a);
+   matFree(b);
+   matFree(expected);
+   return 0;
+}
+
+TstResult Matrix_Multiply(int q)
+{
+   int result = 0;
+   result |= TestMatMul1(5, 7, 3);
+   result |= TestMatMul1(700, 33, 45);
+   result |= TestMatMul1(701, 64, 1);
+   return result;
+}
+
+// Uses a small cache size, so the right factor is processed in several tiles and the left factor
+// in several panels.
+
+TstResult Matrix_MultiplyTiled(int q)
+{
+   const size_t savedCacheSize = ffMulCacheSize;
+   ffMulCacheSize = 1024;
+   int result = 0;
+   result |= TestMatMul1(3, 1100, 2600);
+   result |= TestMatMul1(12, 333, 500);
+   ffMulCacheSize = savedCacheSize;
+   return result;
+}
+
+TstResult Matrix_MultiplyStrassen(int q)
+{
+   const uint32_t savedCutoff = ffStrassenCutoff;
+   ffStrassenCutoff = 20;
+   int result = 0;
+   result |= TestMatMul1(40, 40, 40);
+   result |= TestMatMul1(70, 65, 131);
+   result |= TestMatMul1(157, 21, 83);
+   ffStrassenCutoff = savedCutoff;
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Matrix_Power(int q)
+{
+   const uint32_t savedCutoff = ffStrassenCutoff;
+   ffStrassenCutoff = 16;
+   Matrix_t *a = RndMat(ffOrder, 37, 37);
+   Matrix_t *expected = matId(ffOrder, 37);
+   for (int n = 0; n < 12; ++n) {
+      Matrix_t *p = matPower(a, n);
+      ASSERT(matCompare(p, expected) == 0);
+      matFree(p);
+      matMul(expected, a);
+   }
+   matFree(a);
+   matFree(expected);
+   ffStrassenCutoff = savedCutoff;
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Matrix_DestinationReuse(int q)
+{
+   Matrix_t *a = RndMat(ffOrder, 23, 31);
+   Matrix_t *b = RndMat(ffOrder, 31, 17);
+   Matrix_t *c = RndMat(ffOrder, 17, 17);
+   while (matNullity(c) > 0) {
+      matFree(c);
+      c = RndMat(ffOrder, 17, 17);
+   }
+
+   // Product into a new matrix and into a matrix of the right size
+   Matrix_t *expected = matMul(matDup(a), b);
+   Matrix_t *r = matMulInto(NULL, a, b);
+   ASSERT_EQ_INT(matCompare(r, expected), 0);
+   PTR data = r->data;
+   ASSERT(matMulInto(r, a, b) == r);
+   ASSERT(r->data == data);
+   ASSERT_EQ_INT(matCompare(r, expected), 0);
+   matFree(expected);
+
+   // Same destination with different dimensions
+   expected = matMul(matDup(b), c);
+   ASSERT(matMulInto(r, b, c) == r);
+   ASSERT_EQ_INT(matCompare(r, expected), 0);
+   matFree(expected);
+
+   // Inverse and power
+   expected = matInverse(c);
+   ASSERT(matInverseInto(r, c) == r);
+   ASSERT_EQ_INT(matCompare(r, expected), 0);
+   matFree(expected);
+   for (int n = 0; n < 5; ++n) {
+      expected = matPower(c, n);
+      ASSERT(matPowerInto(r, c, n) == r);
+      ASSERT_EQ_INT(matCompare(r, expected), 0);
+      matFree(expected);
+   }
+
+   ASSERT_ABORT(matMulInto(c, c, c));
+   ASSERT_ABORT(matMulInto(r, a, a));
+
+   matFree(r);
+   matFree(a);
+   matFree(b);
+   matFree(c);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 static int TestMatId2(int fl, int dim)
 {
    Matrix_t *m;
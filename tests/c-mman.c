@@ -37,4 +37,123 @@ TstResult Mm_CanRollback_MultipleObjects()
     permFree(p0);
     return 0;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Mm_CanRollback_ManyObjects()
+{
+    Perm_t* p0 = permAlloc(10);
+    const uint32_t checkpoint = mmCheckpoint();
+    Perm_t* p[500];
+    for (int i = 0; i < 500; ++i) {
+       p[i] = permAlloc(i + 1);
+    }
+    Perm_t* p1 = permAlloc(10);
+    for (int i = 0; i < 500; i += 2) {
+       permFree(p[i]);
+    }
+    mmRollback(checkpoint);
+    for (int i = 1; i < 500; i += 2) {
+       ASSERT(!permIsValid(p[i]));
+    }
+    ASSERT(!permIsValid(p1));
+    ASSERT(permIsValid(p0));
+    permFree(p0);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Mm_CanRollback_OwnedObjects()
+{
+    // The charpol state owns several objects, which must not be destroyed before their owner.
+    Matrix_t* m = RndMat(2, 30, 30);
+    for (int i = 0; i < 20; ++i) {
+       const uint32_t checkpoint = mmCheckpoint();
+       charpolStart(m, PM_MINPOL, 0);
+       mmRollback(checkpoint);
+    }
+    ASSERT(matIsValid(m));
+    matFree(m);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void allocTask(void* userData, size_t begin, size_t end)
+{
+   Perm_t* p[8];
+   for (size_t i = begin; i < end; ++i) {
+      for (int k = 0; k < 8; ++k) {
+         p[k] = permAlloc(10);
+      }
+      for (int k = 7; k >= 0; --k) {
+         permFree(p[k]);
+      }
+   }
+}
+
+TstResult Mm_ConcurrentAllocation()
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pexInit(4);
+#endif
+   pexParallelFor(0, 2000, 10, allocTask, NULL);
+   pexShutdown();
+   return 0;
+}
+
+// Creates objects in parallel and keeps them. One iteration takes a checkpoint while the other
+// threads are still allocating.
+
+struct KeepData {
+   Perm_t** perms;
+   uint32_t* seq;
+   size_t checkpointAt;
+   uint32_t checkpoint;
+};
+
+static void allocAndKeepTask(void* userData, size_t begin, size_t end)
+{
+   struct KeepData* data = (struct KeepData*) userData;
+   for (size_t i = begin; i < end; ++i) {
+      if (i == data->checkpointAt) {
+         data->checkpoint = mmCheckpoint();
+      }
+      data->perms[i] = permAlloc(10);
+      data->seq[i] = data->perms[i]->seq;
+   }
+}
+
+TstResult Mm_ConcurrentAllocation_Rollback()
+{
+#if defined(MTX_DEFAULT_THREADS)
+   pexInit(4);
+#endif
+   enum { N = 20000 };
+   struct KeepData data;
+   data.perms = NALLOC(Perm_t*, N);
+   data.seq = NALLOC(uint32_t, N);
+   // Objects which are created at the same time as the checkpoint are rare, so the test is
+   // repeated many times.
+   for (int k = 0; k < 200; ++k) {
+      data.checkpointAt = N / 2 + k;
+      pexParallelFor(0, N, 1, allocAndKeepTask, &data);
+      mmRollback(data.checkpoint);
+
+      // Objects created before the checkpoint must survive. The test driver's leak check fails
+      // if any of the newer objects survived.
+      for (size_t i = 0; i < N; ++i) {
+         if (data.seq[i] <= data.checkpoint) {
+            ASSERT(permIsValid(data.perms[i]));
+            permFree(data.perms[i]);
+         }
+      }
+   }
+   pexShutdown();
+   sysFree(data.perms);
+   sysFree(data.seq);
+   return 0;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
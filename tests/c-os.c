@@ -220,4 +220,15 @@ TstResult Os_IntegerIo()
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TstResult Os_CpuCount()
+{
+   const int n = sysCpuCount();
+   ASSERT(n >= 1);
+   ASSERT(n <= 100000);
+   ASSERT_EQ_INT(sysCpuCount(), n);
+   return 0;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -7,6 +7,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #if defined(MTX_DEFAULT_THREADS)
 #define SKIP_IF_NO_THREADS()
@@ -40,4 +41,340 @@ TstResult Pex_MainThreadHasNumber0()
     return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static long nestedCounter = 0;
+
+static void nestedLeaf(void* userData, size_t begin, size_t end)
+{
+   __atomic_add_fetch(&nestedCounter, (long) (end - begin), __ATOMIC_RELAXED);
+}
+
+static void nestedParent(void* userData)
+{
+   PexGroup_t* grp = (PexGroup_t*) userData;
+   for (int i = 0; i < 50; ++i) {
+      pexExecuteRange(grp, nestedLeaf, NULL, 0, 3);
+   }
+}
+
+TstResult Pex_NestedTasksAreExecuted()
+{
+   SKIP_IF_NO_THREADS();
+   for (int nThreads = 1; nThreads <= 5; ++nThreads) {
+      nestedCounter = 0;
+      pexInit(nThreads);
+      PexGroup_t* grp = pexCreateGroup();
+      for (int i = 0; i < 200; ++i) {
+         pexExecute(grp, nestedParent, grp);
+      }
+      pexWait(grp);
+      pexShutdown();
+      ASSERT_EQ_INT(nestedCounter, 200 * 50 * 3);
+   }
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define LOOP_SIZE 10007
+
+static void loopBody(void* userData, size_t begin, size_t end)
+{
+   int* count = (int*) userData;
+   for (size_t i = begin; i < end; ++i) {
+      __atomic_add_fetch(count + i, 1, __ATOMIC_RELAXED);
+   }
+}
+
+static int loopPredicate(void* userData, size_t i)
+{
+   int* count = (int*) userData;
+   __atomic_add_fetch(count + i, 1, __ATOMIC_RELAXED);
+   return i >= 5000 && i % 1000 == 123;
+}
+
+static uint64_t loopMin(void* userData, size_t begin, size_t end)
+{
+   uint64_t min = UINT64_MAX;
+   for (size_t i = begin; i < end; ++i) {
+      const uint64_t value = (i * 7919 + 17) % LOOP_SIZE;
+      if (value < min) {
+         min = value;
+      }
+   }
+   return min;
+}
+
+static int checkParallelLoops()
+{
+   int* count = NALLOC(int, LOOP_SIZE);
+   pexParallelFor(10, LOOP_SIZE, 1, loopBody, count);
+   for (int i = 0; i < LOOP_SIZE; ++i) {
+      ASSERT_EQ_INT(count[i], i < 10 ? 0 : 1);
+   }
+
+   memset(count, 0, LOOP_SIZE * sizeof(int));
+   ASSERT_EQ_INT(pexParallelFindFirst(0, LOOP_SIZE, 7, loopPredicate, count), 5123);
+   for (int i = 0; i <= 5123; ++i) {
+      ASSERT_EQ_INT(count[i], 1);
+   }
+   ASSERT_EQ_INT(pexParallelFindFirst(0, 5000, 7, loopPredicate, count), 5000);
+   ASSERT_EQ_INT(pexParallelFindFirst(3, 3, 7, loopPredicate, count), 3);
+
+   ASSERT_EQ_INT(pexParallelMin(0, LOOP_SIZE, 1, loopMin, NULL), 0);
+   ASSERT_EQ_INT(pexParallelMin(1, 3, 1, loopMin, NULL), (2 * 7919 + 17) % LOOP_SIZE);
+   ASSERT(pexParallelMin(3, 3, 1, loopMin, NULL) == UINT64_MAX);
+   sysFree(count);
+   return 0;
+}
+
+TstResult Pex_ParallelLoops()
+{
+   int result = checkParallelLoops();
+#if defined(MTX_DEFAULT_THREADS)
+   for (int nThreads = 1; result == 0 && nThreads <= 5; nThreads += 2) {
+      pexInit(nThreads);
+      result |= checkParallelLoops();
+      pexShutdown();
+   }
+#endif
+   return result;
+}
+
+TstResult Pex_PinnedThreads()
+{
+   SKIP_IF_NO_THREADS();
+   const int nCpus = sysCpuCount();
+   pexPinThreads(1);
+   pexInit(nCpus + 2);
+   int result = checkParallelLoops();
+   pexShutdown();
+   pexPinThreads(0);
+   ASSERT_EQ_INT(sysCpuCount(), nCpus);
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct CancelTask {
+   int started;
+   int sawCancel;
+   int count;
+};
+
+static void countingTask(void* userData)
+{
+   struct CancelTask* t = (struct CancelTask*) userData;
+   __atomic_add_fetch(&t->count, 1, __ATOMIC_SEQ_CST);
+}
+
+#if defined(MTX_DEFAULT_THREADS)
+
+static void blockingTask(void* userData)
+{
+   struct CancelTask* t = (struct CancelTask*) userData;
+   __atomic_store_n(&t->started, 1, __ATOMIC_SEQ_CST);
+   for (int i = 0; i < 10000 && !pexIsCancelled(); ++i) {
+      pexSleep(1);
+   }
+   t->sawCancel = pexIsCancelled();
+}
+
+// Index 0 matches as soon as index 1 is being tested, which then waits for the cancellation.
+
+static int waitingPredicate(void* userData, size_t i)
+{
+   struct CancelTask* t = (struct CancelTask*) userData;
+   if (i == 0) {
+      while (!__atomic_load_n(&t->started, __ATOMIC_SEQ_CST)) {
+         pexSleep(1);
+      }
+      return 1;
+   }
+   __atomic_store_n(&t->started, 1, __ATOMIC_SEQ_CST);
+   for (int k = 0; k < 10000 && !pexIsCancelled(); ++k) {
+      pexSleep(1);
+   }
+   t->sawCancel = pexIsCancelled();
+   return 1;
+}
+
+#endif
+
+TstResult Pex_CancelledTasksAreDropped()
+{
+   struct CancelTask t = {0};
+   ASSERT_EQ_INT(pexIsCancelled(), 0);
+
+   // Without thread pool: tasks of a cancelled group are not executed.
+   PexGroup_t* grp = pexCreateGroup();
+   pexExecute(grp, countingTask, &t);
+   pexCancel(grp);
+   pexExecute(grp, countingTask, &t);
+   pexWait(grp);
+   ASSERT_EQ_INT(t.count, 1);
+
+#if defined(MTX_DEFAULT_THREADS)
+   // With thread pool: the running task sees the cancellation, queued tasks are dropped.
+   memset(&t, 0, sizeof(t));
+   pexInit(1);
+   grp = pexCreateGroup();
+   pexExecute(grp, blockingTask, &t);
+   while (!__atomic_load_n(&t.started, __ATOMIC_SEQ_CST)) {
+      pexSleep(1);
+   }
+   for (int i = 0; i < 50; ++i) {
+      pexExecute(grp, countingTask, &t);
+   }
+   pexCancel(grp);
+   pexWait(grp);
+   ASSERT(t.sawCancel);
+   ASSERT_EQ_INT(t.count, 0);
+   ASSERT_EQ_INT(pexIsCancelled(), 0);
+
+   // Predicate calls for indexes after a match are cancelled.
+   memset(&t, 0, sizeof(t));
+   ASSERT_EQ_INT(pexParallelFindFirst(0, 2, 1, waitingPredicate, &t), 0);
+   pexShutdown();
+   ASSERT(t.sawCancel);
+#endif
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct FieldTask {
+   int field;
+   int initialField;
+   int ok;
+};
+
+static void fieldTask(void* userData)
+{
+   struct FieldTask* t = (struct FieldTask*) userData;
+   t->initialField = ffOrder;
+   ffSetField(t->field);
+   t->ok = 1;
+   for (int i = 0; i < 20000; ++i) {
+      const FEL a = ffFromInt(i % t->field);
+      if (ffOrder != t->field || ffToInt(ffAdd(a, ffNeg(a))) != 0) {
+         t->ok = 0;
+      }
+   }
+}
+
+TstResult Pex_TasksCanUseDifferentFields()
+{
+   SKIP_IF_NO_THREADS();
+   static const int fields[] = {2, 3, 4, 16};
+   struct FieldTask tasks[16];
+   ffSetField(3);
+   pexInit(4);
+   PexGroup_t* grp = pexCreateGroup();
+   for (int i = 0; i < 16; ++i) {
+      tasks[i].field = fields[i % 4];
+      pexExecute(grp, fieldTask, tasks + i);
+   }
+   pexWait(grp);
+   pexWaitAll();
+   pexShutdown();
+   // Tasks start with the creator's field, and the main thread is not affected by the tasks.
+   for (int i = 0; i < 16; ++i) {
+      ASSERT(tasks[i].ok);
+      ASSERT_EQ_INT(tasks[i].initialField, 3);
+   }
+   ASSERT_EQ_INT(ffOrder, 3);
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static int checkParallelElimination(int field)
+{
+   SelectField(field);
+   Matrix_t* a = RndMat(ffOrder, 700, 500);
+   Matrix_t* b = RndMat(ffOrder, 600, 600);
+
+   Matrix_t* echSerial = matDup(a);
+   matEchelonize(echSerial);
+   Matrix_t* nspSerial = matNullSpace(a);
+   Matrix_t* invSerial = matNullity(b) == 0 ? matInverse(b) : NULL;
+
+   pexInit(4);
+   Matrix_t* echParallel = matDup(a);
+   matEchelonize(echParallel);
+   Matrix_t* nspParallel = matNullSpace(a);
+   Matrix_t* invParallel = invSerial != NULL ? matInverse(b) : NULL;
+   pexWaitAll();
+   pexShutdown();
+
+   ASSERT(matCompare(echSerial, echParallel) == 0);
+   ASSERT(matCompare(nspSerial, nspParallel) == 0);
+   if (invSerial != NULL) {
+      ASSERT(matCompare(invSerial, invParallel) == 0);
+      matFree(invSerial);
+      matFree(invParallel);
+   }
+   matFree(echSerial);
+   matFree(echParallel);
+   matFree(nspSerial);
+   matFree(nspParallel);
+   matFree(a);
+   matFree(b);
+   return 0;
+}
+
+TstResult Pex_ParallelEliminationMatchesSerial()
+{
+   SKIP_IF_NO_THREADS();
+   static const int fields[] = {2, 5, 256};
+   int result = 0;
+   for (int i = 0; result == 0 && i < 3; ++i) {
+      result |= checkParallelElimination(fields[i]);
+   }
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static int checkParallelMultiplication(int field)
+{
+   SelectField(field);
+   Matrix_t* a = RndMat(ffOrder, 700, 300);
+   Matrix_t* b = RndMat(ffOrder, 300, 200);
+   Matrix_t* c = RndMat(ffOrder, 600, 600);
+
+   Matrix_t* abSerial = matMul(matDup(a), b);
+   Matrix_t* powSerial = matPower(c, 5);
+
+   pexInit(4);
+   Matrix_t* abParallel = matMul(matDup(a), b);
+   Matrix_t* powParallel = matPower(c, 5);
+   pexWaitAll();
+   pexShutdown();
+
+   ASSERT(matCompare(abSerial, abParallel) == 0);
+   ASSERT(matCompare(powSerial, powParallel) == 0);
+   matFree(abSerial);
+   matFree(abParallel);
+   matFree(powSerial);
+   matFree(powParallel);
+   matFree(a);
+   matFree(b);
+   matFree(c);
+   return 0;
+}
+
+TstResult Pex_ParallelMultiplicationMatchesSerial()
+{
+   SKIP_IF_NO_THREADS();
+   static const int fields[] = {2, 5, 256};
+   int result = 0;
+   for (int i = 0; result == 0 && i < 3; ++i) {
+      result |= checkParallelMultiplication(fields[i]);
+   }
+   return result;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
@@ -307,6 +307,127 @@ TstResult Polynomial_Gcd()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Multiplies with the given Karatsuba cutoff and compares with the schoolbook result.
+
+static int TestFastMul(int na, int nb, uint32_t cutoff)
+{
+   Poly_t* a = RndPol(ffOrder, na, na);
+   Poly_t* b = RndPol(ffOrder, nb, nb);
+   polKaratsubaCutoff = 0;
+   Poly_t* expected = polMul(polDup(a), b);
+   polKaratsubaCutoff = cutoff;
+   polMul(a, b);
+   ASSERT_EQ_INT(polCompare(a, expected), 0);
+   polFree(a);
+   polFree(b);
+   polFree(expected);
+   return 0;
+}
+
+TstResult Polynomial_FastMultiply(int q)
+{
+   const uint32_t savedCutoff = polKaratsubaCutoff;
+   int result = 0;
+   for (uint32_t cutoff = 4; cutoff <= 32 && result == 0; cutoff *= 2) {
+      result |= TestFastMul(100, 100, cutoff);
+      result |= TestFastMul(200, 37, cutoff);
+      result |= TestFastMul(5, 300, cutoff);
+      result |= TestFastMul(64, 63, cutoff);
+   }
+   polKaratsubaCutoff = savedCutoff;
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Divides with Newton iteration and compares with the schoolbook result.
+
+static int TestNewtonDivision(int da, int db)
+{
+   Poly_t* a = RndPol(ffOrder, da, da);
+   Poly_t* b = RndPol(ffOrder, db, db);
+   b->data[db] = ffFromInt(ffOrder - 1);      // not monic (unless GF(2))
+
+   polNewtonCutoff = 0;
+   Poly_t* expectedRem = polDup(a);
+   Poly_t* expectedQuot = polDivMod(expectedRem, b);
+   polNewtonCutoff = 4;
+   Poly_t* rem = polDup(a);
+   Poly_t* quot = polDivMod(rem, b);
+   ASSERT_EQ_INT(polCompare(quot, expectedQuot), 0);
+   ASSERT_EQ_INT(polCompare(rem, expectedRem), 0);
+   polMod(a, b);
+   ASSERT_EQ_INT(polCompare(a, expectedRem), 0);
+
+   polFree(a);
+   polFree(b);
+   polFree(rem);
+   polFree(quot);
+   polFree(expectedRem);
+   polFree(expectedQuot);
+   return 0;
+}
+
+TstResult Polynomial_NewtonDivision(int q)
+{
+   const uint32_t savedCutoff = polNewtonCutoff;
+   const uint32_t savedKaratsuba = polKaratsubaCutoff;
+   polKaratsubaCutoff = 8;
+   int result = 0;
+   result |= TestNewtonDivision(300, 100);
+   result |= TestNewtonDivision(300, 250);
+   result |= TestNewtonDivision(100, 5);
+   result |= TestNewtonDivision(257, 128);
+   polNewtonCutoff = savedCutoff;
+   polKaratsubaCutoff = savedKaratsuba;
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Calculates gcd(g·u, g·v) with the half-GCD algorithm and compares with the Euclidean algorithm.
+
+static int TestHalfGcd(int dg, int du, int dv)
+{
+   Poly_t* g = RndPol(ffOrder, dg, dg);
+   Poly_t* a = polMul(RndPol(ffOrder, du, du), g);
+   Poly_t* b = polMul(RndPol(ffOrder, dv, dv), g);
+   polHalfGcdCutoff = 0;
+   Poly_t* expected = polGcd(a, b);
+   for (uint32_t cutoff = 1; cutoff <= 64; cutoff *= 4) {
+      polHalfGcdCutoff = cutoff;
+      Poly_t* gcd = polGcd(a, b);
+      ASSERT_EQ_INT(polCompare(gcd, expected), 0);
+      polFree(gcd);
+   }
+   polFree(g);
+   polFree(a);
+   polFree(b);
+   polFree(expected);
+   return 0;
+}
+
+TstResult Polynomial_HalfGcd(int q)
+{
+   const uint32_t savedCutoff = polHalfGcdCutoff;
+   const uint32_t savedKaratsuba = polKaratsubaCutoff;
+   const uint32_t savedNewton = polNewtonCutoff;
+   polKaratsubaCutoff = 8;
+   polNewtonCutoff = 8;
+   int result = 0;
+   for (int i = 0; i < 5 && result == 0; ++i) {
+      result |= TestHalfGcd(0, 150, 140);
+      result |= TestHalfGcd(40, 120, 119);
+      result |= TestHalfGcd(3, 200, 60);
+   }
+   polHalfGcdCutoff = savedCutoff;
+   polKaratsubaCutoff = savedKaratsuba;
+   polNewtonCutoff = savedNewton;
+   return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
 struct FactorizationTestCase {
       int fieldOrder;
       int pol[6][20];   // degree, a[0], a[1], ... a[degree]
@@ -340,21 +461,37 @@ static int Polynomial_Factorization_(const struct FactorizationTestCase* tc, int
 }
 
 
+// The factors are irreducible over GF(3) and GF(2), respectively, and remain irreducible over the
+// extension fields because their degrees are prime to the extension degree.
+#if MTX_ZZZ == 2
+#define FACTORIZATION_Q1 3
+#define FACTORIZATION_Q2 16
+#else
+#define FACTORIZATION_Q1 243
+#define FACTORIZATION_Q2 256
+#endif
+
 TstResult Polynomial_Factorization()
 {
    const struct FactorizationTestCase TC[] = {
-      { .fieldOrder = 243,
+      { .fieldOrder = FACTORIZATION_Q1,
         .pol = {
            { 2, 2, 2, 1 },        // X2+2X+2
            { 3, 1, 2, 0, 1 },     // X3+2X+1
            { 4, 2, 0, 0, 2, 1 }   // X4+2X3+2
         } },
-      { .fieldOrder = 256,
+      { .fieldOrder = FACTORIZATION_Q2,
         .pol = {
            { 3, 1, 1, 0, 1 },             // X3+X+1
            { 5, 1, 0, 1, 0, 0, 1 },       // X5+X2+1
            { 7, 1, 1, 0, 0, 0, 0, 0, 1 }  // X7+X+1
         } },
+      // Coefficients outside the prime field: square roots need the Frobenius automorphism.
+      { .fieldOrder = 4,
+        .pol = {
+           { 1, 2, 1 },           // X+a
+           { 2, 2, 1, 1 }         // X2+X+a
+        } },
    };
    const struct FactorizationTestCase* const TC_END = TC + sizeof(TC) / sizeof(TC[0]);
 
@@ -368,4 +505,65 @@ TstResult Polynomial_Factorization()
    return result;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Factorizes a polynomial with the Berlekamp and Cantor-Zassenhaus algorithms and compares the
+// results.
+
+static int TestCantorZassenhaus(const Poly_t* pol)
+{
+   polCantorZassenhausCutoff = 0;
+   FPoly_t* expected = Factorization(pol);
+   polCantorZassenhausCutoff = 1;
+   FPoly_t* factors = Factorization(pol);
+   if (fpCompare(factors, expected) != 0) {
+      TST_FAIL("Factorization of %s: %s", polToEphemeralString(pol),
+            fpToEphemeralString(factors));
+   }
+   fpFree(factors);
+   fpFree(expected);
+   return 0;
+}
+
+TstResult Polynomial_CantorZassenhaus(int q)
+{
+   const uint32_t savedCutoff = polCantorZassenhausCutoff;
+   const uint32_t savedKaratsuba = polKaratsubaCutoff;
+   const uint32_t savedNewton = polNewtonCutoff;
+   polKaratsubaCutoff = 8;
+   polNewtonCutoff = 8;
+
+   // With cutoff 1, the Cantor-Zassenhaus algorithm is used up to degree q^(3/2). In large fields,
+   // the degree is limited because the Berlekamp algorithm is slow.
+   int maxDeg = 1;
+   while (maxDeg < 40) {
+      const uint64_t n = maxDeg + 1;
+      if (n * n > (uint64_t) q * q * q || n * n * q > 4000000) { break; }
+      maxDeg = (int) n;
+   }
+
+   int result = 0;
+   for (int i = 0; i < 10 && result == 0; ++i) {
+      Poly_t* pol = RndPol(q, 1, maxDeg);
+      if (maxDeg - pol->degree >= 2) {
+         Poly_t* b = RndPol(q, 1, (maxDeg - pol->degree) / 2);
+         polMul(pol, b);
+         polMul(pol, b);
+         polFree(b);
+      }
+      if (i % 2 == 1) {
+         for (int k = 0; k <= pol->degree; ++k) {
+            pol->data[k] = ffMul(pol->data[k], ffFromInt(q - 1));
+         }
+      }
+      result |= TestCantorZassenhaus(pol);
+      polFree(pol);
+   }
+
+   polCantorZassenhausCutoff = savedCutoff;
+   polKaratsubaCutoff = savedKaratsuba;
+   polNewtonCutoff = savedNewton;
+   return result;
+}
+
 // vim:fileencoding=utf8:sw=3:ts=8:et:cin
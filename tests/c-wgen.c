@@ -156,11 +156,15 @@ TstResult WordGenerator_Fingerprint()
    int result = 0;
    result |= WordGenerator_Fingerprint_(TST_HERE, 2, 2, 1,0,1,0,0,0);
    result |= WordGenerator_Fingerprint_(TST_HERE, 3, 2, 0,1,0,1,1,0);
+   #if MTX_ZZZ != 2
    result |= WordGenerator_Fingerprint_(TST_HERE,64, 2, 1,0,1,0,0,0);
+   #endif
    
    result |= WordGenerator_Fingerprint_(TST_HERE, 2, 3, 1,0,0,1,0,1);
    result |= WordGenerator_Fingerprint_(TST_HERE, 3, 3, 1,0,0,0,0,0);
+   #if MTX_ZZZ != 2
    result |= WordGenerator_Fingerprint_(TST_HERE,64, 3, 1,0,0,1,0,1);
+   #endif
    return result;
 }
 
@@ -22,12 +22,29 @@ PATH="../../bin:$PATH"
 MTXLIB="../../lib"
 export MTXLIB
 MTX_TEST_DATA_DIR="../../tests/data/$MTX_ZZZ"
+# The bit-sliced kernel uses the file format of the standard kernel.
+if [ $MTX_ZZZ -eq 2 ]; then MTX_TEST_DATA_DIR="../../tests/data/0"; fi
 MTX_TESTCASE_DIR="../$MTX_TESTCASE_DIR"
 [ -d "$MTX_TEST_DATA_DIR" ] \
-   || error "Invalid data directory \"$MTX_TEST_DATA_DIR\" (\$MTX_ZZZ must be 0 or 1)"
+   || error "Invalid data directory \"$MTX_TEST_DATA_DIR\" (\$MTX_ZZZ must be 0, 1, or 2)"
 
 TEST_FIELDS="2 5 9 25 67 125 256"
 if [ $MTX_ZZZ -eq 1 ]; then TEST_FIELDS="$TEST_FIELDS 625"; fi
+# The bit-sliced kernel supports only GF(2), GF(4), GF(8), and GF(16).
+if [ $MTX_ZZZ -eq 2 ]; then TEST_FIELDS="2 4 8 16"; fi
+
+# skipWithBitSlicedKernel
+#
+# Skips the test if the bit-sliced kernel (ZZZ=2) is used. Call this in tests which need fields
+# other than GF(2), GF(4), GF(8), and GF(16).
+
+skipWithBitSlicedKernel()
+{
+   if [ $MTX_ZZZ -eq 2 ]; then
+      echo "Skipped: test needs fields which are not supported by the bit-sliced kernel"
+      exit 0
+   fi
+}
 
 # Prefix for temporary files
 TF="$MTX_TESTCASE_NO"
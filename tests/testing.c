@@ -104,15 +104,20 @@ int tstAssertEqString(const struct TstSourceLocation* where, const char* act, co
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#if MTX_ZZZ == 2
+static const int DEFAULT_FIELDS[] = {2,3,4,8,16,-1};
+static int defaultField = 16;
+#else
 static const int DEFAULT_FIELDS[] = {2,3,4,5,16,67,125,256,
 #if MTX_ZZZ == 1
     59049, // = 3 ^ 10
 #endif
     -1};
+static int defaultField = 243;
+#endif
 
 static const int* SelectedFields = DEFAULT_FIELDS;
 static const int* CurrentField = NULL;
-static int defaultField = 243;
 static char *argv0;
 
 
@@ -476,6 +481,8 @@ int main(int argc, char **argv)
    static const int MTX_MAX_Q = 65535;
 #elif MTX_ZZZ == 0
    static const int MTX_MAX_Q = 256;
+#elif MTX_ZZZ == 2
+   static const int MTX_MAX_Q = 16;
 #else
 #error MTX_ZZZ undefined
 #endif
@@ -10,7 +10,7 @@
 #include <stdarg.h>
 #include <setjmp.h>
 
-#if MTX_ZZZ == 0
+#if MTX_ZZZ == 0 || MTX_ZZZ == 2
 
 #define ISFEL(f) ((unsigned int)(f) < (unsigned int)ffOrder)
 
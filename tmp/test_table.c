@@ -0,0 +1,358 @@
+#include <testing.h>
+extern TstResult WordGenerator_Fingerprint();
+extern TstResult WordGenerator_SymbolicName3Gen(int q);
+extern TstResult WordGenerator_SymbolicName(int q);
+extern TstResult WordGenerator_RejectsWordNumberZero(int q);
+extern TstResult Matrix_Tensor(int q);
+extern TstResult StructuredTextFile2();
+extern TstResult StructuredTextFile1();
+extern TstResult RandomNumberGenerator2();
+extern TstResult RandomNumberGenerator1();
+extern TstResult QuotientAction(int q);
+extern TstResult QuotientProjection2(int q);
+extern TstResult QuotientProjection1(int q);
+extern TstResult SeedVectorGenerator_CheckLimits();
+extern TstResult SeedVectorGenerator();
+extern TstResult Polynomial_CantorZassenhaus(int q);
+extern TstResult Polynomial_Factorization();
+extern TstResult Polynomial_HalfGcd(int q);
+extern TstResult Polynomial_NewtonDivision(int q);
+extern TstResult Polynomial_FastMultiply(int q);
+extern TstResult Polynomial_Gcd();
+extern TstResult PolynomialMultiply(int q);
+extern TstResult PolynomialAdd(int q);
+extern TstResult Polynomial_Compare1(int q);
+extern TstResult Polynomial_Compare2();
+extern TstResult Polynomial_AbortsOnDoubleFree();
+extern TstResult Polynomial_Alloc(int q);
+extern TstResult Pex_ParallelMultiplicationMatchesSerial();
+extern TstResult Pex_ParallelEliminationMatchesSerial();
+extern TstResult Pex_TasksCanUseDifferentFields();
+extern TstResult Pex_CancelledTasksAreDropped();
+extern TstResult Pex_PinnedThreads();
+extern TstResult Pex_ParallelLoops();
+extern TstResult Pex_NestedTasksAreExecuted();
+extern TstResult Pex_MainThreadHasNumber0();
+extern TstResult Pex_MultiplePexInitFails();
+extern TstResult Pex_InitializeWithPoolSizeZeroFails();
+extern TstResult Perm_Inverse();
+extern TstResult Perm_Power();
+extern TstResult Perm_Multiply();
+extern TstResult Perm_Order();
+extern TstResult Perm_AllocFree();
+extern TstResult Os_CpuCount();
+extern TstResult Os_IntegerIo();
+extern TstResult Os_Seek();
+extern TstResult Os_FileIo();
+extern TstResult OS_Alloc();
+extern TstResult OS_sysMalloc_InitializesMemoryWithZero();
+extern TstResult OS_MallocWithLengthZeroIsNotNull();
+extern TstResult Mm_ConcurrentAllocation_Rollback();
+extern TstResult Mm_ConcurrentAllocation();
+extern TstResult Mm_CanRollback_OwnedObjects();
+extern TstResult Mm_CanRollback_ManyObjects();
+extern TstResult Mm_CanRollback_MultipleObjects();
+extern TstResult Mm_CanRollback_NoObjects();
+extern TstResult Matrix_Identity(int q);
+extern TstResult Matrix_DestinationReuse(int q);
+extern TstResult Matrix_Power(int q);
+extern TstResult Matrix_MultiplyStrassen(int q);
+extern TstResult Matrix_MultiplyTiled(int q);
+extern TstResult Matrix_Multiply(int q);
+extern TstResult Matrix_MultiplyAdd(int q);
+extern TstResult Matrix_Copy(int q);
+extern TstResult Matrix_Cut(int q);
+extern TstResult Matrix_Order(int q);
+extern TstResult Matrix_BlockedElimination(int q);
+extern TstResult Matrix_NullSpace(int q);
+extern TstResult Matrix_Duplication(int q);
+extern TstResult Matrix_Inversion(int q);
+extern TstResult Matrix_Clean(int q);
+extern TstResult Matrix_CompareSize(int q);
+extern TstResult Matrix_Compare1(int q);
+extern TstResult Matrix_Echelonize(int q);
+extern TstResult Matrix_ThrowsOnDoubleFree();
+extern TstResult Matrix_Allocation(int q);
+extern TstResult Matrix_InsertWithPowerTable(int q);
+extern TstResult Matrix_InsertIntoGivenMatrix(int q);
+extern TstResult Matrix_InsertIntoPolynomial(int q);
+extern TstResult Kernel_SimdSelection();
+extern TstResult Kernel_RowOps_LargeChar2();
+extern TstResult Kernel_RowOps_LargePrime();
+extern TstResult Kernel_FieldContext_Basics();
+extern TstResult Kernel_RowOps_LongSums(int q);
+extern TstResult Kernel_RowOps_WideRows(int q);
+extern TstResult Kernel_RowOps_CmpRows(int q);
+extern TstResult Kernel_RowOps_RowSize(int q);
+extern TstResult Kernel_RowOps_StepPtr(int q);
+extern TstResult Kernel_RowOps_MulRowPadsWithZero(int q);
+extern TstResult Kernel_RowOps_MulRow(int q);
+extern TstResult Kernel_RowOps_AddRow(int q);
+extern TstResult Kernel_Field_Subfields();
+extern TstResult Kernel_FindPivot(int q);
+extern TstResult Kernel_RowOps_InsertExtract(int q);
+extern TstResult Kernel_Field_Generator(int q);
+extern TstResult Kernel_Field_MulDiv(int q);
+extern TstResult Kernel_Field_AddSub(int q);
+extern TstResult Kernel_Field_CommutativityAndAssociativity(int q);
+extern TstResult Kernel_Field_Distributivity(int q);
+extern TstResult Kernel_Field_Inversion(int q);
+extern TstResult Kernel_Field_Characteristic(int q);
+extern TstResult Kernel_Field_IntConversion_Consistency(int q);
+extern TstResult Kernel_Field_IntConversion_PrimeField(int q);
+extern TstResult IntMatrix_CompareFindsSingleDifferingMark();
+extern TstResult IntMatrix_Duplicate();
+extern TstResult IntMatrix_ThrowsOnDoubleFree();
+extern TstResult IntMatrix_Allocation();
+extern TstResult Gap_PrimeFieldElements(int q);
+extern TstResult Gap_FfOne(int q);
+extern TstResult Gap_FfZero(int q);
+extern TstResult Gap_FfGenerator(int q);
+extern TstResult FPoly_OrderFactorsByDegree();
+extern TstResult FPoly_FailsOnWrongField();
+extern TstResult FPoly_Allocation();
+extern TstResult Alloc_LargeBlocksAreClearedInCancelledTasks();
+extern TstResult FreeRows_BuffersAreReusedAndCleared(int q);
+extern TstResult ScalarProduct_WorksForNocEqualsZero(int q);
+extern TstResult ScalarProduct_RandomValues(int q);
+extern TstResult Matrix_SumIntersection(int q);
+extern TstResult Kernel_MapRow(int q);
+extern TstResult FileIo_Write32();
+extern TstResult FileIo_Read32();
+extern TstResult FileIo_Write16();
+extern TstResult FileIo_Read16();
+extern TstResult FileIo();
+extern TstResult Kernel_FileHeader(int q);
+extern TstResult Kernel_RowIo(int q);
+extern TstResult Kernel_RowIo_FailsOnPartialRead(int q);
+extern TstResult Kernel_RowIo_CanWriteAndReadWithDifferentRowSizes();
+extern TstResult CharacteristicPolynomial_CompanionMatrix(int q);
+extern TstResult CharacteristicPolynomial();
+extern TstResult Cfinfo_BadPeakWord();
+extern TstResult Cfinfo_FileNotFound();
+extern TstResult BitString_Variable_Iterate();
+extern TstResult BitString_Fixed_Iterate();
+extern TstResult BitString_Fixed_IsSubset();
+extern TstResult BitString_Variable_IntersectionCount();
+extern TstResult BitString_Fixed_IntersectionCount();
+extern TstResult BitString_Variable_FileIo();
+extern TstResult BitString_Fixed_FileIo();
+extern TstResult BitString_Variable_Copy();
+extern TstResult BitString_Fixed_Copy();
+extern TstResult BitString_Variable_Compare();
+extern TstResult BitString_Fixed_Compare();
+extern TstResult BitString_Variable_BitwiseAnd();
+extern TstResult BitString_BitwiseOps_AbortsOnTypeMismatch();
+extern TstResult BitString_Fixed_BitwiseOps_AbortsOnSizeMismatch();
+extern TstResult BitString_Fixed_BitwiseOps();
+extern TstResult BitString_Fixed_Trim();
+extern TstResult BitString_Variable_Trim();
+extern TstResult BitString_Variable_ReadWrite();
+extern TstResult BitString_Fixed_ReadWrite();
+extern TstResult BitString_Variable_ClearAll();
+extern TstResult BitString_Fixed_ClearAll();
+extern TstResult BitString_Fixed_AbortsOnWritingBeyondEnd();
+extern TstResult BitString_Fixed_AbortsOnReadingBeyondEnd();
+extern TstResult BitString_Variable_WritingBeyondCapacity();
+extern TstResult BitString_Variable_ReadingBeyondCapacity();
+extern TstResult BitString_Variable_AllocFree();
+extern TstResult BitString_Fixed_AllocFree();
+extern TstResult BitString_AbortsOnDoubleFree();
+extern TstResult BitString_NullIsInvalid();
+extern TstResult App_ThreadOptions();
+extern TstResult App_CommonOptions2();
+extern TstResult App_CommonOptions();
+extern TstResult App_OptionAfterArgument();
+extern TstResult App_IntegerOptionErrorHandling();
+extern TstResult App_ShortOptionsWithValueCannotBeMerged();
+extern TstResult App_IntegerOptions();
+extern TstResult App_DoubleDash();
+extern TstResult App_DetectUnknownOption();
+extern TstResult App_CanCheckArgumentCount();
+extern TstResult App_LongOptionNotPresent();
+extern TstResult App_LongOptionWithoutValueWithoutDefault();
+extern TstResult App_LongOptionWithoutValueWithDefault();
+extern TstResult App_LongOptionWithValue();
+extern TstResult App_RecognizedLongOptionIsConsumed();
+extern TstResult App_FailsOnMissingMandatoryArgumentOfLongOption();
+extern TstResult App_LongOptionArgumentCannotBeSeparated();
+struct TstFoundTest foundTests[] = {
+{WordGenerator_Fingerprint, 0x0, "WordGenerator_Fingerprint"},
+{WordGenerator_SymbolicName3Gen, 0x1, "WordGenerator_SymbolicName3Gen"},
+{WordGenerator_SymbolicName, 0x1, "WordGenerator_SymbolicName"},
+{WordGenerator_RejectsWordNumberZero, 0x1, "WordGenerator_RejectsWordNumberZero"},
+{Matrix_Tensor, 0x1, "Matrix_Tensor"},
+{StructuredTextFile2, 0x0, "StructuredTextFile2"},
+{StructuredTextFile1, 0x0, "StructuredTextFile1"},
+{RandomNumberGenerator2, 0x0, "RandomNumberGenerator2"},
+{RandomNumberGenerator1, 0x0, "RandomNumberGenerator1"},
+{QuotientAction, 0x1, "QuotientAction"},
+{QuotientProjection2, 0x1, "QuotientProjection2"},
+{QuotientProjection1, 0x1, "QuotientProjection1"},
+{SeedVectorGenerator_CheckLimits, 0x0, "SeedVectorGenerator_CheckLimits"},
+{SeedVectorGenerator, 0x0, "SeedVectorGenerator"},
+{Polynomial_CantorZassenhaus, 0x1, "Polynomial_CantorZassenhaus"},
+{Polynomial_Factorization, 0x0, "Polynomial_Factorization"},
+{Polynomial_HalfGcd, 0x1, "Polynomial_HalfGcd"},
+{Polynomial_NewtonDivision, 0x1, "Polynomial_NewtonDivision"},
+{Polynomial_FastMultiply, 0x1, "Polynomial_FastMultiply"},
+{Polynomial_Gcd, 0x0, "Polynomial_Gcd"},
+{PolynomialMultiply, 0x1, "PolynomialMultiply"},
+{PolynomialAdd, 0x1, "PolynomialAdd"},
+{Polynomial_Compare1, 0x1, "Polynomial_Compare1"},
+{Polynomial_Compare2, 0x0, "Polynomial_Compare2"},
+{Polynomial_AbortsOnDoubleFree, 0x0, "Polynomial_AbortsOnDoubleFree"},
+{Polynomial_Alloc, 0x1, "Polynomial_Alloc"},
+{Pex_ParallelMultiplicationMatchesSerial, 0x0, "Pex_ParallelMultiplicationMatchesSerial"},
+{Pex_ParallelEliminationMatchesSerial, 0x0, "Pex_ParallelEliminationMatchesSerial"},
+{Pex_TasksCanUseDifferentFields, 0x0, "Pex_TasksCanUseDifferentFields"},
+{Pex_CancelledTasksAreDropped, 0x0, "Pex_CancelledTasksAreDropped"},
+{Pex_PinnedThreads, 0x0, "Pex_PinnedThreads"},
+{Pex_ParallelLoops, 0x0, "Pex_ParallelLoops"},
+{Pex_NestedTasksAreExecuted, 0x0, "Pex_NestedTasksAreExecuted"},
+{Pex_MainThreadHasNumber0, 0x0, "Pex_MainThreadHasNumber0"},
+{Pex_MultiplePexInitFails, 0x0, "Pex_MultiplePexInitFails"},
+{Pex_InitializeWithPoolSizeZeroFails, 0x0, "Pex_InitializeWithPoolSizeZeroFails"},
+{Perm_Inverse, 0x0, "Perm_Inverse"},
+{Perm_Power, 0x0, "Perm_Power"},
+{Perm_Multiply, 0x0, "Perm_Multiply"},
+{Perm_Order, 0x0, "Perm_Order"},
+{Perm_AllocFree, 0x0, "Perm_AllocFree"},
+{Os_CpuCount, 0x0, "Os_CpuCount"},
+{Os_IntegerIo, 0x0, "Os_IntegerIo"},
+{Os_Seek, 0x0, "Os_Seek"},
+{Os_FileIo, 0x0, "Os_FileIo"},
+{OS_Alloc, 0x0, "OS_Alloc"},
+{OS_sysMalloc_InitializesMemoryWithZero, 0x0, "OS_sysMalloc_InitializesMemoryWithZero"},
+{OS_MallocWithLengthZeroIsNotNull, 0x0, "OS_MallocWithLengthZeroIsNotNull"},
+{Mm_ConcurrentAllocation_Rollback, 0x0, "Mm_ConcurrentAllocation_Rollback"},
+{Mm_ConcurrentAllocation, 0x0, "Mm_ConcurrentAllocation"},
+{Mm_CanRollback_OwnedObjects, 0x0, "Mm_CanRollback_OwnedObjects"},
+{Mm_CanRollback_ManyObjects, 0x0, "Mm_CanRollback_ManyObjects"},
+{Mm_CanRollback_MultipleObjects, 0x0, "Mm_CanRollback_MultipleObjects"},
+{Mm_CanRollback_NoObjects, 0x0, "Mm_CanRollback_NoObjects"},
+{Matrix_Identity, 0x1, "Matrix_Identity"},
+{Matrix_DestinationReuse, 0x1, "Matrix_DestinationReuse"},
+{Matrix_Power, 0x1, "Matrix_Power"},
+{Matrix_MultiplyStrassen, 0x1, "Matrix_MultiplyStrassen"},
+{Matrix_MultiplyTiled, 0x1, "Matrix_MultiplyTiled"},
+{Matrix_Multiply, 0x1, "Matrix_Multiply"},
+{Matrix_MultiplyAdd, 0x1, "Matrix_MultiplyAdd"},
+{Matrix_Copy, 0x1, "Matrix_Copy"},
+{Matrix_Cut, 0x1, "Matrix_Cut"},
+{Matrix_Order, 0x1, "Matrix_Order"},
+{Matrix_BlockedElimination, 0x1, "Matrix_BlockedElimination"},
+{Matrix_NullSpace, 0x1, "Matrix_NullSpace"},
+{Matrix_Duplication, 0x1, "Matrix_Duplication"},
+{Matrix_Inversion, 0x1, "Matrix_Inversion"},
+{Matrix_Clean, 0x1, "Matrix_Clean"},
+{Matrix_CompareSize, 0x1, "Matrix_CompareSize"},
+{Matrix_Compare1, 0x1, "Matrix_Compare1"},
+{Matrix_Echelonize, 0x1, "Matrix_Echelonize"},
+{Matrix_ThrowsOnDoubleFree, 0x0, "Matrix_ThrowsOnDoubleFree"},
+{Matrix_Allocation, 0x1, "Matrix_Allocation"},
+{Matrix_InsertWithPowerTable, 0x1, "Matrix_InsertWithPowerTable"},
+{Matrix_InsertIntoGivenMatrix, 0x1, "Matrix_InsertIntoGivenMatrix"},
+{Matrix_InsertIntoPolynomial, 0x1, "Matrix_InsertIntoPolynomial"},
+{Kernel_SimdSelection, 0x0, "Kernel_SimdSelection"},
+{Kernel_RowOps_LargeChar2, 0x0, "Kernel_RowOps_LargeChar2"},
+{Kernel_RowOps_LargePrime, 0x0, "Kernel_RowOps_LargePrime"},
+{Kernel_FieldContext_Basics, 0x0, "Kernel_FieldContext_Basics"},
+{Kernel_RowOps_LongSums, 0x1, "Kernel_RowOps_LongSums"},
+{Kernel_RowOps_WideRows, 0x1, "Kernel_RowOps_WideRows"},
+{Kernel_RowOps_CmpRows, 0x1, "Kernel_RowOps_CmpRows"},
+{Kernel_RowOps_RowSize, 0x1, "Kernel_RowOps_RowSize"},
+{Kernel_RowOps_StepPtr, 0x1, "Kernel_RowOps_StepPtr"},
+{Kernel_RowOps_MulRowPadsWithZero, 0x1, "Kernel_RowOps_MulRowPadsWithZero"},
+{Kernel_RowOps_MulRow, 0x1, "Kernel_RowOps_MulRow"},
+{Kernel_RowOps_AddRow, 0x1, "Kernel_RowOps_AddRow"},
+{Kernel_Field_Subfields, 0x0, "Kernel_Field_Subfields"},
+{Kernel_FindPivot, 0x1, "Kernel_FindPivot"},
+{Kernel_RowOps_InsertExtract, 0x1, "Kernel_RowOps_InsertExtract"},
+{Kernel_Field_Generator, 0x1, "Kernel_Field_Generator"},
+{Kernel_Field_MulDiv, 0x1, "Kernel_Field_MulDiv"},
+{Kernel_Field_AddSub, 0x1, "Kernel_Field_AddSub"},
+{Kernel_Field_CommutativityAndAssociativity, 0x1, "Kernel_Field_CommutativityAndAssociativity"},
+{Kernel_Field_Distributivity, 0x1, "Kernel_Field_Distributivity"},
+{Kernel_Field_Inversion, 0x1, "Kernel_Field_Inversion"},
+{Kernel_Field_Characteristic, 0x1, "Kernel_Field_Characteristic"},
+{Kernel_Field_IntConversion_Consistency, 0x1, "Kernel_Field_IntConversion_Consistency"},
+{Kernel_Field_IntConversion_PrimeField, 0x1, "Kernel_Field_IntConversion_PrimeField"},
+{IntMatrix_CompareFindsSingleDifferingMark, 0x0, "IntMatrix_CompareFindsSingleDifferingMark"},
+{IntMatrix_Duplicate, 0x0, "IntMatrix_Duplicate"},
+{IntMatrix_ThrowsOnDoubleFree, 0x0, "IntMatrix_ThrowsOnDoubleFree"},
+{IntMatrix_Allocation, 0x0, "IntMatrix_Allocation"},
+{Gap_PrimeFieldElements, 0x1, "Gap_PrimeFieldElements"},
+{Gap_FfOne, 0x1, "Gap_FfOne"},
+{Gap_FfZero, 0x1, "Gap_FfZero"},
+{Gap_FfGenerator, 0x1, "Gap_FfGenerator"},
+{FPoly_OrderFactorsByDegree, 0x0, "FPoly_OrderFactorsByDegree"},
+{FPoly_FailsOnWrongField, 0x0, "FPoly_FailsOnWrongField"},
+{FPoly_Allocation, 0x0, "FPoly_Allocation"},
+{Alloc_LargeBlocksAreClearedInCancelledTasks, 0x0, "Alloc_LargeBlocksAreClearedInCancelledTasks"},
+{FreeRows_BuffersAreReusedAndCleared, 0x1, "FreeRows_BuffersAreReusedAndCleared"},
+{ScalarProduct_WorksForNocEqualsZero, 0x1, "ScalarProduct_WorksForNocEqualsZero"},
+{ScalarProduct_RandomValues, 0x1, "ScalarProduct_RandomValues"},
+{Matrix_SumIntersection, 0x1, "Matrix_SumIntersection"},
+{Kernel_MapRow, 0x1, "Kernel_MapRow"},
+{FileIo_Write32, 0x0, "FileIo_Write32"},
+{FileIo_Read32, 0x0, "FileIo_Read32"},
+{FileIo_Write16, 0x0, "FileIo_Write16"},
+{FileIo_Read16, 0x0, "FileIo_Read16"},
+{FileIo, 0x0, "FileIo"},
+{Kernel_FileHeader, 0x1, "Kernel_FileHeader"},
+{Kernel_RowIo, 0x1, "Kernel_RowIo"},
+{Kernel_RowIo_FailsOnPartialRead, 0x1, "Kernel_RowIo_FailsOnPartialRead"},
+{Kernel_RowIo_CanWriteAndReadWithDifferentRowSizes, 0x0, "Kernel_RowIo_CanWriteAndReadWithDifferentRowSizes"},
+{CharacteristicPolynomial_CompanionMatrix, 0x1, "CharacteristicPolynomial_CompanionMatrix"},
+{CharacteristicPolynomial, 0x0, "CharacteristicPolynomial"},
+{Cfinfo_BadPeakWord, 0x0, "Cfinfo_BadPeakWord"},
+{Cfinfo_FileNotFound, 0x0, "Cfinfo_FileNotFound"},
+{BitString_Variable_Iterate, 0x0, "BitString_Variable_Iterate"},
+{BitString_Fixed_Iterate, 0x0, "BitString_Fixed_Iterate"},
+{BitString_Fixed_IsSubset, 0x0, "BitString_Fixed_IsSubset"},
+{BitString_Variable_IntersectionCount, 0x0, "BitString_Variable_IntersectionCount"},
+{BitString_Fixed_IntersectionCount, 0x0, "BitString_Fixed_IntersectionCount"},
+{BitString_Variable_FileIo, 0x0, "BitString_Variable_FileIo"},
+{BitString_Fixed_FileIo, 0x0, "BitString_Fixed_FileIo"},
+{BitString_Variable_Copy, 0x0, "BitString_Variable_Copy"},
+{BitString_Fixed_Copy, 0x0, "BitString_Fixed_Copy"},
+{BitString_Variable_Compare, 0x0, "BitString_Variable_Compare"},
+{BitString_Fixed_Compare, 0x0, "BitString_Fixed_Compare"},
+{BitString_Variable_BitwiseAnd, 0x0, "BitString_Variable_BitwiseAnd"},
+{BitString_BitwiseOps_AbortsOnTypeMismatch, 0x0, "BitString_BitwiseOps_AbortsOnTypeMismatch"},
+{BitString_Fixed_BitwiseOps_AbortsOnSizeMismatch, 0x0, "BitString_Fixed_BitwiseOps_AbortsOnSizeMismatch"},
+{BitString_Fixed_BitwiseOps, 0x0, "BitString_Fixed_BitwiseOps"},
+{BitString_Fixed_Trim, 0x0, "BitString_Fixed_Trim"},
+{BitString_Variable_Trim, 0x0, "BitString_Variable_Trim"},
+{BitString_Variable_ReadWrite, 0x0, "BitString_Variable_ReadWrite"},
+{BitString_Fixed_ReadWrite, 0x0, "BitString_Fixed_ReadWrite"},
+{BitString_Variable_ClearAll, 0x0, "BitString_Variable_ClearAll"},
+{BitString_Fixed_ClearAll, 0x0, "BitString_Fixed_ClearAll"},
+{BitString_Fixed_AbortsOnWritingBeyondEnd, 0x0, "BitString_Fixed_AbortsOnWritingBeyondEnd"},
+{BitString_Fixed_AbortsOnReadingBeyondEnd, 0x0, "BitString_Fixed_AbortsOnReadingBeyondEnd"},
+{BitString_Variable_WritingBeyondCapacity, 0x0, "BitString_Variable_WritingBeyondCapacity"},
+{BitString_Variable_ReadingBeyondCapacity, 0x0, "BitString_Variable_ReadingBeyondCapacity"},
+{BitString_Variable_AllocFree, 0x0, "BitString_Variable_AllocFree"},
+{BitString_Fixed_AllocFree, 0x0, "BitString_Fixed_AllocFree"},
+{BitString_AbortsOnDoubleFree, 0x0, "BitString_AbortsOnDoubleFree"},
+{BitString_NullIsInvalid, 0x0, "BitString_NullIsInvalid"},
+{App_ThreadOptions, 0x0, "App_ThreadOptions"},
+{App_CommonOptions2, 0x0, "App_CommonOptions2"},
+{App_CommonOptions, 0x0, "App_CommonOptions"},
+{App_OptionAfterArgument, 0x0, "App_OptionAfterArgument"},
+{App_IntegerOptionErrorHandling, 0x0, "App_IntegerOptionErrorHandling"},
+{App_ShortOptionsWithValueCannotBeMerged, 0x0, "App_ShortOptionsWithValueCannotBeMerged"},
+{App_IntegerOptions, 0x0, "App_IntegerOptions"},
+{App_DoubleDash, 0x0, "App_DoubleDash"},
+{App_DetectUnknownOption, 0x0, "App_DetectUnknownOption"},
+{App_CanCheckArgumentCount, 0x0, "App_CanCheckArgumentCount"},
+{App_LongOptionNotPresent, 0x0, "App_LongOptionNotPresent"},
+{App_LongOptionWithoutValueWithoutDefault, 0x0, "App_LongOptionWithoutValueWithoutDefault"},
+{App_LongOptionWithoutValueWithDefault, 0x0, "App_LongOptionWithoutValueWithDefault"},
+{App_LongOptionWithValue, 0x0, "App_LongOptionWithValue"},
+{App_RecognizedLongOptionIsConsumed, 0x0, "App_RecognizedLongOptionIsConsumed"},
+{App_FailsOnMissingMandatoryArgumentOfLongOption, 0x0, "App_FailsOnMissingMandatoryArgumentOfLongOption"},
+{App_LongOptionArgumentCannotBeSeparated, 0x0, "App_LongOptionArgumentCannotBeSeparated"},
+{NULL,0}
+};